@@ -0,0 +1,519 @@
+#pragma once
+
+#include <wmi/common.hxx>
+#include <wmi/property_name.hxx>
+#include <wmi/variant.hxx>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace wmi {
+
+/**
+ * property resolved once per class so hot reads skip the name lookup
+ * on windows it wraps the IWbemObjectAccess handle and cim type of the property, in-memory rows
+ * use the column position; a handle stays usable for every object of the class it was resolved
+ * on, rows it does not fit fall back to looking the property up by name
+ */
+struct PropertyHandle {
+    static constexpr long INVALID = -1;
+
+    std::wstring name;
+    long handle = INVALID;
+    // CIMTYPE of the property on windows, 0 elsewhere
+    long type = 0;
+    // column layout the position belongs to, kept alive so its address is not reused;
+    // empty for com handles
+    std::shared_ptr<const void> layout;
+
+    [[nodiscard]] bool IsValid() const noexcept { return handle != INVALID; }
+};
+
+/**
+ * a single object returned by a backend
+ * exposes properties by name, returned pointers stay valid for the lifetime of the row
+ */
+class Row {
+   public:
+    virtual ~Row() = default;
+
+    /**
+     * looks up a property value by name
+     * \param name - property name, matched case-insensitively
+     * \returns pointer to the value owned by the row, nullptr if the row has no such property
+     */
+    [[nodiscard]] virtual const Variant* Find(std::wstring_view name) const = 0;
+
+    /**
+     * looks up a property by a prebuilt name token
+     * the default forwards to Find, backends that cache or hand names to com skip the copy
+     * \param name - property name token
+     * \returns pointer to the value owned by the row, nullptr if the row has no such property
+     */
+    [[nodiscard]] virtual const Variant* FindName(const PropertyName& name) const {
+        return Find(name.View());
+    }
+
+    /**
+     * visits every non-system property of the row
+     * \param visitor - called with each property name and value, both valid only during the call
+     */
+    virtual void Enumerate(
+        const std::function<void(std::wstring_view, const Variant&)>& visitor) const = 0;
+
+    /**
+     * looks up several properties at once
+     * the default calls Find for each name, backends that pay per lookup read them in one walk
+     * \param names - property names, matched case-insensitively
+     * \param count - number of names
+     * \param values - receives one pointer per name, owned by the row, nullptr when missing
+     * \returns number of names found
+     */
+    virtual std::size_t FindAll(const std::wstring_view* names, const std::size_t count,
+                                const Variant** values) const {
+        std::size_t found = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            values[i] = Find(names[i]);
+            found += values[i] ? 1 : 0;
+        }
+        return found;
+    }
+
+    /**
+     * looks up several properties by prebuilt name tokens
+     * the default goes through FindName, backends walking the row compare the hashes first
+     * \param names - property name tokens
+     * \param count - number of names
+     * \param values - receives one pointer per name, owned by the row, nullptr when missing
+     * \returns number of names found
+     */
+    virtual std::size_t FindAllNames(const PropertyName* names, const std::size_t count,
+                                     const Variant** values) const {
+        std::size_t found = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            values[i] = FindName(names[i]);
+            found += values[i] ? 1 : 0;
+        }
+        return found;
+    }
+
+    /**
+     * resolves a property for repeated reads through Read
+     * the default returns an unresolved handle, reads then go through Find
+     * \param name - property name, matched case-insensitively
+     * \returns handle carrying the name and whatever the backend needs to skip the lookup
+     */
+    [[nodiscard]] virtual PropertyHandle Resolve(const std::wstring_view name) const {
+        PropertyHandle handle;
+        handle.name = name;
+        return handle;
+    }
+
+    /**
+     * identity of the column layout the handles resolved on this row are bound to
+     * rows reporting the same layout accept each other's handles by position
+     * \returns layout address, nullptr if handles hold for every row of the class
+     */
+    [[nodiscard]] virtual const void* Layout() const noexcept { return nullptr; }
+
+    /**
+     * reads a property through a handle resolved on this or another row of the same class
+     * \param handle - result of Resolve
+     * \returns pointer to the value owned by the row, nullptr if the row has no such property
+     */
+    [[nodiscard]] virtual const Variant* Read(const PropertyHandle& handle) const {
+        return Find(handle.name);
+    }
+
+    /**
+     * reads several resolved properties of the row at once
+     * the default reads every handle, backends paying a round trip per property override it
+     * \param handles - results of Resolve
+     * \param count - number of handles
+     * \param values - receives one pointer per handle, owned by the row, nullptr when missing
+     * \returns number of properties found
+     */
+    virtual std::size_t ReadAll(const PropertyHandle* handles, const std::size_t count,
+                                const Variant** values) const {
+        std::size_t found = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            values[i] = Read(handles[i]);
+            found += values[i] ? 1 : 0;
+        }
+        return found;
+    }
+};
+
+using RowPtr = std::shared_ptr<const Row>;
+
+/**
+ * forward-only cursor over the rows produced by a query
+ * follows the IEnumWbemClassObject contract so the com backend maps onto it directly
+ */
+class Enumerator {
+   public:
+    virtual ~Enumerator() = default;
+
+    /**
+     * fetches up to count rows and appends them to rows
+     * \param timeout_ms - maximum wait in milliseconds, INFINITE_TIMEOUT to block
+     * \param count - maximum number of rows to fetch
+     * \param rows - receives the fetched rows
+     * \returns status::Ok when count rows were fetched, status::False at the end of the result,
+     *          status::TimedOut when the timeout elapsed first, a failure code otherwise
+     */
+    virtual HResult Next(long timeout_ms, std::size_t count, std::vector<RowPtr>& rows) = 0;
+
+    /**
+     * rewinds the enumerator to the first row when the backend supports it
+     * \returns status::Ok on success, a failure code otherwise
+     */
+    virtual HResult Reset() = 0;
+};
+
+/**
+ * receiver of the rows of an asynchronous query, the portable side of IWbemObjectSink
+ * both calls may arrive on a backend thread, never concurrently for the same query
+ */
+class ObjectSink {
+   public:
+    virtual ~ObjectSink() = default;
+
+    /**
+     * delivers rows as the provider produces them
+     * blocking here applies back pressure to the provider
+     * \param rows - rows of this indication, the sink may move them out
+     */
+    virtual void Indicate(std::vector<RowPtr>& rows) = 0;
+
+    /**
+     * reports the end of the query, called exactly once
+     * \param result - status::Ok, status::Cancelled or the failure code of the provider
+     * \param error - exception raised while executing the query, if any
+     */
+    virtual void SetStatus(HResult result, std::exception_ptr error) = 0;
+};
+
+/**
+ * handle of a running asynchronous query
+ * destroying the handle cancels the query
+ */
+class AsyncCall {
+   public:
+    virtual ~AsyncCall() = default;
+
+    /**
+     * stops the query, the sink receives status::Cancelled unless the query already ended
+     */
+    virtual void Cancel() = 0;
+};
+
+namespace detail {
+
+/**
+ * stand-in for the wmi async machinery: pulls an enumerator on a thread of its own and
+ * pushes what it gets into the sink, so every backend supports asynchronous queries
+ */
+class ThreadedAsyncCall final : public AsyncCall {
+   public:
+    static constexpr std::size_t BATCH_SIZE = 64;
+    // longest a Next call blocks before the driver checks for cancellation
+    static constexpr long SLICE_MS = 50;
+
+    ThreadedAsyncCall(std::function<std::shared_ptr<Enumerator>()> start,
+                      std::shared_ptr<ObjectSink> sink) {
+        thread_ = std::thread(
+            [this, start = std::move(start), sink = std::move(sink)] { Drive(start, *sink); });
+    }
+
+    ~ThreadedAsyncCall() override { Cancel(); }
+
+    ThreadedAsyncCall(const ThreadedAsyncCall&) = delete;
+    ThreadedAsyncCall& operator=(const ThreadedAsyncCall&) = delete;
+
+    void Cancel() override {
+        cancelled_.store(true, std::memory_order_relaxed);
+        // a sink cancelling from inside Indicate must not join its own thread
+        if (thread_.joinable() && thread_.get_id() != std::this_thread::get_id()) {
+            thread_.join();
+        }
+    }
+
+   private:
+    void Drive(const std::function<std::shared_ptr<Enumerator>()>& start, ObjectSink& sink) {
+        HResult result = status::Ok;
+        std::exception_ptr error;
+        try {
+            const auto enumerator = start();
+            std::vector<RowPtr> rows;
+            for (;;) {
+                if (cancelled_.load(std::memory_order_relaxed)) {
+                    result = status::Cancelled;
+                    break;
+                }
+                rows.clear();
+                const auto next = enumerator->Next(SLICE_MS, BATCH_SIZE, rows);
+                if (!rows.empty()) {
+                    sink.Indicate(rows);
+                }
+                if (Failed(next)) {
+                    result = next;
+                    break;
+                }
+                if (rows.empty() && next != status::TimedOut) {
+                    break;
+                }
+            }
+        } catch (...) {
+            result = status::Failed;
+            error = std::current_exception();
+        }
+        sink.SetStatus(result, error);
+    }
+
+    std::atomic<bool> cancelled_{false};
+    std::thread thread_;
+};
+
+}  // namespace detail
+
+/**
+ * cim property types, values match the windows CIMTYPE constants
+ */
+enum class CimType : std::uint16_t {
+    Empty = 0,
+    SInt16 = 2,
+    SInt32 = 3,
+    Real32 = 4,
+    Real64 = 5,
+    String = 8,
+    Boolean = 11,
+    Object = 13,
+    SInt8 = 16,
+    UInt8 = 17,
+    UInt16 = 18,
+    UInt32 = 19,
+    SInt64 = 20,
+    UInt64 = 21,
+    DateTime = 101,
+    Reference = 102,
+    Char16 = 103
+};
+
+[[nodiscard]] constexpr const char* ToString(const CimType type) noexcept {
+    switch (type) {
+        case CimType::SInt8:
+            return "sint8";
+        case CimType::UInt8:
+            return "uint8";
+        case CimType::SInt16:
+            return "sint16";
+        case CimType::UInt16:
+            return "uint16";
+        case CimType::SInt32:
+            return "sint32";
+        case CimType::UInt32:
+            return "uint32";
+        case CimType::SInt64:
+            return "sint64";
+        case CimType::UInt64:
+            return "uint64";
+        case CimType::Real32:
+            return "real32";
+        case CimType::Real64:
+            return "real64";
+        case CimType::String:
+            return "string";
+        case CimType::Boolean:
+            return "boolean";
+        case CimType::Object:
+            return "object";
+        case CimType::DateTime:
+            return "datetime";
+        case CimType::Reference:
+            return "reference";
+        case CimType::Char16:
+            return "char16";
+        default:
+            return "empty";
+    }
+}
+
+/**
+ * declared type of one property of a class
+ */
+struct PropertySchema {
+    std::wstring name;
+    CimType type = CimType::Empty;
+    bool is_array = false;
+};
+
+/**
+ * property types of a wmi class as its class definition declares them
+ */
+struct ClassSchema {
+    std::wstring class_name;
+    std::vector<PropertySchema> properties;
+
+    /**
+     * \param name - property name, matched case-insensitively
+     * \returns declared type of the property, nullptr if the class has no such property
+     */
+    [[nodiscard]] const PropertySchema* Find(const std::wstring_view name) const noexcept {
+        for (const auto& property : properties) {
+            if (EqualsIgnoreCase(property.name, name)) {
+                return &property;
+            }
+        }
+        return nullptr;
+    }
+};
+
+/**
+ * a source of wmi data: the com services on windows, in-memory or native providers elsewhere
+ * implementations must allow ExecQuery to be called concurrently
+ */
+class Backend {
+   public:
+    virtual ~Backend() = default;
+
+    /**
+     * binds the backend to a wmi namespace
+     * \param path - namespace below root, e.g. "cimv2"
+     * \throws Exception if the namespace cannot be reached
+     */
+    virtual void Connect(std::string_view path) = 0;
+
+    /**
+     * starts a wql query
+     * \param query - wql query text
+     * \returns enumerator over the matching rows
+     * \throws Exception if the query cannot be executed
+     */
+    [[nodiscard]] virtual std::shared_ptr<Enumerator> ExecQuery(std::wstring_view query) = 0;
+
+    /**
+     * starts a wql query whose rows are pushed into a sink
+     * the default drives ExecQuery on a dedicated thread, backends with native
+     * asynchronous execution override it
+     * \param query - wql query text
+     * \param sink - receiver of the rows and the final status
+     * \returns handle cancelling the query when destroyed
+     * \throws Exception if the query cannot be started
+     */
+    [[nodiscard]] virtual std::unique_ptr<AsyncCall> ExecQueryAsync(
+        const std::wstring_view query, std::shared_ptr<ObjectSink> sink) {
+        return std::make_unique<detail::ThreadedAsyncCall>(
+            [this, text = std::wstring(query)] { return ExecQuery(text); }, std::move(sink));
+    }
+
+    /**
+     * describes the properties of a class
+     * the default knows no schemas, callers then skip the checks they drive
+     * \param class_name - wmi class name
+     * \returns schema of the class, nullopt if the backend cannot describe it
+     * \throws Exception if the class does not exist
+     */
+    [[nodiscard]] virtual std::optional<ClassSchema> GetClassSchema(
+        const std::wstring_view /*class_name*/) {
+        return std::nullopt;
+    }
+};
+
+/**
+ * row stored entirely in memory
+ * column names are shared between every row of one result set
+ */
+class MemoryRow final : public Row {
+   public:
+    using Columns = std::vector<std::wstring>;
+
+    MemoryRow(std::shared_ptr<const Columns> columns, std::vector<Variant> values)
+        : columns_(std::move(columns)), values_(std::move(values)) {}
+
+    [[nodiscard]] const Variant* Find(const std::wstring_view name) const override {
+        const auto count = std::min(columns_->size(), values_.size());
+        for (std::size_t i = 0; i < count; ++i) {
+            if (EqualsIgnoreCase((*columns_)[i], name)) {
+                return &values_[i];
+            }
+        }
+        return nullptr;
+    }
+
+    void Enumerate(
+        const std::function<void(std::wstring_view, const Variant&)>& visitor) const override {
+        const auto count = std::min(columns_->size(), values_.size());
+        for (std::size_t i = 0; i < count; ++i) {
+            visitor((*columns_)[i], values_[i]);
+        }
+    }
+
+    [[nodiscard]] PropertyHandle Resolve(const std::wstring_view name) const override {
+        auto handle = Row::Resolve(name);
+        const auto count = std::min(columns_->size(), values_.size());
+        for (std::size_t i = 0; i < count; ++i) {
+            if (EqualsIgnoreCase((*columns_)[i], name)) {
+                handle.handle = static_cast<long>(i);
+                handle.layout = columns_;
+                break;
+            }
+        }
+        return handle;
+    }
+
+    [[nodiscard]] const void* Layout() const noexcept override { return columns_.get(); }
+
+    [[nodiscard]] const Variant* Read(const PropertyHandle& handle) const override {
+        // rows of one result set share their columns, so the position holds for all of them
+        if (handle.layout == columns_ && handle.IsValid() &&
+            static_cast<std::size_t>(handle.handle) < values_.size()) {
+            return &values_[static_cast<std::size_t>(handle.handle)];
+        }
+        return Row::Read(handle);
+    }
+
+   private:
+    std::shared_ptr<const Columns> columns_;
+    std::vector<Variant> values_;
+};
+
+/**
+ * enumerator over a prepared set of rows
+ * used by every backend that computes its whole result up front
+ */
+class MemoryEnumerator final : public Enumerator {
+   public:
+    explicit MemoryEnumerator(std::vector<RowPtr> rows) : rows_(std::move(rows)) {}
+
+    HResult Next(long /*timeout_ms*/, const std::size_t count, std::vector<RowPtr>& rows) override {
+        const auto available = rows_.size() - position_;
+        const auto taken = std::min(count, available);
+        rows.insert(rows.end(), rows_.begin() + static_cast<std::ptrdiff_t>(position_),
+                    rows_.begin() + static_cast<std::ptrdiff_t>(position_ + taken));
+        position_ += taken;
+        return taken == count ? status::Ok : status::False;
+    }
+
+    HResult Reset() override {
+        position_ = 0;
+        return status::Ok;
+    }
+
+   private:
+    std::vector<RowPtr> rows_;
+    std::size_t position_ = 0;
+};
+
+}  // namespace wmi
@@ -0,0 +1,508 @@
+#pragma once
+
+#include <wmi/backend.hxx>
+#include <wmi/common.hxx>
+#include <wmi/variant.hxx>
+#include <wmi/wql.hxx>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace wmi {
+
+struct CoalescingOptions {
+    static constexpr std::chrono::microseconds DEFAULT_WINDOW{2000};
+
+    // how long the first query of a class waits for others to join it
+    std::chrono::microseconds window = DEFAULT_WINDOW;
+};
+
+struct CoalescingStats {
+    // queries received from the library
+    std::size_t requests = 0;
+    // queries sent to the wrapped backend
+    std::size_t round_trips = 0;
+    // requests answered from a merged query
+    std::size_t coalesced = 0;
+};
+
+/**
+ * backend decorator merging queries that hit the same class at about the same time
+ * a query arriving while no other query of its class and WHERE condition runs is passed
+ * through untouched and keeps streaming; one arriving while another runs opens a short window,
+ * every such query arriving within it joins, and a single SELECT over the union of their
+ * properties is sent to the wrapped backend; each requester then gets the rows projected
+ * back to the properties it asked for
+ * ExecQuery never blocks on a merged query: the members wait and drive it from the Next calls
+ * of their enumerators, so the timeout of each call, and with it the deadline and cancellation
+ * of each requester, bounds its own wait
+ */
+class CoalescingBackend final : public Backend {
+   public:
+    /**
+     * \param inner - backend answering the merged queries
+     * \param options - merge window
+     */
+    explicit CoalescingBackend(std::shared_ptr<Backend> inner, CoalescingOptions options = {})
+        : inner_(std::move(inner)), options_(options) {
+        if (!inner_) {
+            throw Exception("CoalescingBackend needs a backend to forward queries to");
+        }
+    }
+
+    void Connect(const std::string_view path) override { inner_->Connect(path); }
+
+    [[nodiscard]] std::optional<ClassSchema> GetClassSchema(
+        const std::wstring_view class_name) override {
+        return inner_->GetClassSchema(class_name);
+    }
+
+    /**
+     * \returns enumerator valid while this backend lives, which the interface owning it ensures
+     */
+    [[nodiscard]] std::shared_ptr<Enumerator> ExecQuery(const std::wstring_view query) override {
+        auto parsed = ParseWql(query);
+        if (!parsed) {
+            // not ours to judge, the wrapped backend reports the error
+            Count(1, 0);
+            return inner_->ExecQuery(query);
+        }
+
+        auto key = GroupKey(*parsed);
+        std::shared_ptr<Group> group;
+        std::size_t member = 0;
+        {
+            const std::lock_guard lock(mutex_);
+            ++stats_.requests;
+            auto& open = open_[key];
+            if (!open && running_[key] == 0) {
+                open_.erase(key);
+                ++running_[key];
+            } else {
+                if (!open) {
+                    open = std::make_shared<Group>();
+                    open->key = key;
+                    open->closes = std::chrono::steady_clock::now() + options_.window;
+                }
+                group = open;
+                member = group->members.size();
+                group->members.push_back(std::move(*parsed));
+            }
+        }
+
+        if (!group) {
+            // released again if the query cannot start
+            Running running(*this, std::move(key));
+            Count(0, 1);
+            return std::make_shared<PassThroughEnumerator>(inner_->ExecQuery(query),
+                                                           std::move(running));
+        }
+        return std::make_shared<MemberEnumerator>(*this, std::move(group), member,
+                                                  std::wstring(query));
+    }
+
+    /**
+     * request and round-trip counters since construction
+     */
+    [[nodiscard]] CoalescingStats GetStats() const {
+        const std::lock_guard lock(mutex_);
+        return stats_;
+    }
+
+   private:
+    static constexpr std::size_t DRAIN_BATCH_SIZE = 256;
+    // longest a member blocks in the merged query or on another member before looking again
+    static constexpr std::chrono::milliseconds SLICE{50};
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Group {
+        std::wstring key;
+        Clock::time_point closes;
+        // guarded by the backend mutex until the window closes
+        std::vector<WqlQuery> members;
+
+        // held by the one member advancing the merged query
+        std::mutex drive;
+        bool closed = false;
+        std::vector<std::wstring> properties;
+        std::shared_ptr<Enumerator> merged;
+        std::vector<RowPtr> drained;
+
+        std::mutex mutex;
+        std::condition_variable done;
+        bool finished = false;
+        // written before finished is set, read only after seeing it
+        bool solo = false;
+        std::vector<RowPtr> rows;
+        std::exception_ptr error;
+    };
+
+    /**
+     * marks a passed-through query of a group key as running until it ends or is dropped
+     */
+    class Running {
+       public:
+        Running(CoalescingBackend& backend, std::wstring key)
+            : backend_(&backend), key_(std::move(key)) {}
+
+        ~Running() { Release(); }
+
+        Running(Running&& other) noexcept
+            : backend_(std::exchange(other.backend_, nullptr)), key_(std::move(other.key_)) {}
+
+        Running(const Running&) = delete;
+        Running& operator=(const Running&) = delete;
+        Running& operator=(Running&&) = delete;
+
+        void Release() {
+            if (backend_) {
+                const std::lock_guard lock(backend_->mutex_);
+                if (--backend_->running_[key_] == 0) {
+                    backend_->running_.erase(key_);
+                }
+                backend_ = nullptr;
+            }
+        }
+
+       private:
+        CoalescingBackend* backend_;
+        std::wstring key_;
+    };
+
+    class PassThroughEnumerator final : public Enumerator {
+       public:
+        PassThroughEnumerator(std::shared_ptr<Enumerator> inner, Running running)
+            : inner_(std::move(inner)), running_(std::move(running)) {}
+
+        HResult Next(const long timeout_ms, const std::size_t count,
+                     std::vector<RowPtr>& rows) override {
+            const auto result = inner_->Next(timeout_ms, count, rows);
+            if (result != status::Ok && result != status::TimedOut) {
+                // the end of the result, later queries of the class need not wait for others
+                running_.Release();
+            }
+            return result;
+        }
+
+        HResult Reset() override { return inner_->Reset(); }
+
+       private:
+        std::shared_ptr<Enumerator> inner_;
+        Running running_;
+    };
+
+    /**
+     * rows of one member of a group, the merged rows projected or its own query as a fallback
+     */
+    class MemberEnumerator final : public Enumerator {
+       public:
+        MemberEnumerator(CoalescingBackend& backend, std::shared_ptr<Group> group,
+                         const std::size_t member, std::wstring query)
+            : backend_(backend),
+              group_(std::move(group)),
+              member_(member),
+              query_(std::move(query)) {}
+
+        HResult Next(const long timeout_ms, const std::size_t count,
+                     std::vector<RowPtr>& rows) override {
+            if (!rows_) {
+                const auto deadline = timeout_ms < 0
+                                          ? Clock::time_point::max()
+                                          : Clock::now() + std::chrono::milliseconds(timeout_ms);
+                if (!backend_.Wait(*group_, deadline)) {
+                    return status::TimedOut;
+                }
+                rows_ = backend_.Serve(*group_, member_, query_);
+            }
+            return rows_->Next(timeout_ms, count, rows);
+        }
+
+        HResult Reset() override { return rows_ ? rows_->Reset() : status::Ok; }
+
+       private:
+        CoalescingBackend& backend_;
+        std::shared_ptr<Group> group_;
+        std::size_t member_;
+        std::wstring query_;
+        std::shared_ptr<Enumerator> rows_;
+    };
+
+    // class names are case-insensitive, conditions may hold case-sensitive literals
+    [[nodiscard]] static std::wstring GroupKey(const WqlQuery& query) {
+        std::wstring key;
+        key.reserve(query.class_name.size() + 1 + query.where.size());
+        for (auto ch : query.class_name) {
+            if (ch >= L'A' && ch <= L'Z') {
+                ch = static_cast<wchar_t>(ch - L'A' + L'a');
+            }
+            key.push_back(ch);
+        }
+        key.push_back(L'\n');
+        key.append(query.where);
+        return key;
+    }
+
+    /**
+     * waits for a group to finish, advancing the merged query while no other member does
+     * \returns false if the deadline passed first
+     */
+    bool Wait(Group& group, const Clock::time_point deadline) {
+        for (;;) {
+            {
+                const std::lock_guard lock(group.mutex);
+                if (group.finished) {
+                    return true;
+                }
+            }
+
+            std::unique_lock drive(group.drive, std::try_to_lock);
+            if (drive.owns_lock()) {
+                Step(group, deadline);
+            } else {
+                // another member drives, it may give up at its own deadline before finishing
+                std::unique_lock lock(group.mutex);
+                group.done.wait_until(lock, std::min(deadline, Clock::now() + SLICE),
+                                      [&group] { return group.finished; });
+                if (group.finished) {
+                    return true;
+                }
+            }
+
+            if (Clock::now() >= deadline) {
+                const std::lock_guard lock(group.mutex);
+                return group.finished;
+            }
+        }
+    }
+
+    /**
+     * one bounded step of a group: waiting out the window, starting the merged query or
+     * draining a slice of it; the caller holds the drive lock
+     */
+    void Step(Group& group, const Clock::time_point deadline) {
+        if (!group.closed) {
+            if (Clock::now() < group.closes) {
+                std::this_thread::sleep_until(std::min(group.closes, deadline));
+                if (Clock::now() < group.closes) {
+                    return;
+                }
+            }
+            if (Close(group)) {
+                Finish(group);
+            }
+            return;
+        }
+
+        const auto remaining =
+            std::chrono::ceil<std::chrono::milliseconds>(deadline - Clock::now());
+        if (deadline != Clock::time_point::max() && remaining.count() <= 0) {
+            return;
+        }
+        const auto slice =
+            deadline == Clock::time_point::max() ? SLICE : std::min(remaining, SLICE);
+        try {
+            const auto before = group.drained.size();
+            const auto result = group.merged->Next(static_cast<long>(slice.count()),
+                                                   DRAIN_BATCH_SIZE, group.drained);
+            if (Failed(result)) {
+                throw Exception(FormatHResultError("Merged query failed", result));
+            }
+            if (group.drained.size() == before && result != status::TimedOut) {
+                group.rows = Materialize(group.drained, group.properties);
+                group.drained.clear();
+                group.merged.reset();
+                Finish(group);
+            }
+        } catch (...) {
+            group.error = std::current_exception();
+            group.merged.reset();
+            Finish(group);
+        }
+    }
+
+    /**
+     * closes the window of a group and starts its merged query
+     * \returns true if the group is done already, because it has a single member or failed
+     */
+    bool Close(Group& group) {
+        bool everything = false;
+        {
+            const std::lock_guard lock(mutex_);
+            // no other group of the key opens before this one closed
+            open_.erase(group.key);
+            group.closed = true;
+            group.solo = group.members.size() == 1;
+            for (const auto& member : group.members) {
+                everything = everything || member.properties.empty();
+                for (const auto& property : member.properties) {
+                    if (!Contains(group.properties, property)) {
+                        group.properties.push_back(property);
+                    }
+                }
+            }
+        }
+        if (group.solo) {
+            return true;
+        }
+
+        if (everything) {
+            group.properties.clear();
+        }
+        Count(0, 1);
+        try {
+            WqlQuery merged = group.members.front();
+            merged.properties = group.properties;
+            group.merged = inner_->ExecQuery(FormatWql(merged));
+            return false;
+        } catch (...) {
+            group.error = std::current_exception();
+            return true;
+        }
+    }
+
+    static void Finish(Group& group) {
+        {
+            const std::lock_guard lock(group.mutex);
+            group.finished = true;
+        }
+        group.done.notify_all();
+    }
+
+    /**
+     * rows of one member once its group finished
+     * alone in the window, or the merged query failed or lacks a property this requester
+     * selected: it runs its own query so errors are reported against the query causing them
+     */
+    [[nodiscard]] std::shared_ptr<Enumerator> Serve(const Group& group, const std::size_t member,
+                                                    const std::wstring& query) {
+        if (!group.solo && !group.error) {
+            if (auto rows = Project(group, group.members[member])) {
+                {
+                    const std::lock_guard lock(mutex_);
+                    ++stats_.coalesced;
+                }
+                return std::make_shared<MemoryEnumerator>(std::move(*rows));
+            }
+        }
+        Count(0, 1);
+        return inner_->ExecQuery(query);
+    }
+
+    /**
+     * copies the merged rows into memory rows once, on the leader's thread
+     * every requester reads them concurrently afterwards, backend rows such as com objects
+     * fill lookup caches on read and must not be shared between threads
+     * \param rows - rows of the merged query
+     * \param properties - properties it selected, empty for every property
+     * \returns immutable rows safe to read from any thread
+     * \throws Exception if a row lacks a selected property, the requesters then run their own
+     *         queries
+     */
+    [[nodiscard]] static std::vector<RowPtr> Materialize(
+        const std::vector<RowPtr>& rows, const std::vector<std::wstring>& properties) {
+        std::vector<RowPtr> copies;
+        copies.reserve(rows.size());
+
+        if (!properties.empty()) {
+            const auto columns = std::make_shared<const MemoryRow::Columns>(properties);
+            const std::vector<std::wstring_view> names(properties.begin(), properties.end());
+            std::vector<const Variant*> found(names.size());
+            for (const auto& row : rows) {
+                if (row->FindAll(names.data(), names.size(), found.data()) != names.size()) {
+                    throw Exception("Merged query lacks a selected property");
+                }
+                std::vector<Variant> values;
+                values.reserve(found.size());
+                for (const auto* value : found) {
+                    values.push_back(*value);
+                }
+                copies.push_back(std::make_shared<MemoryRow>(columns, std::move(values)));
+            }
+            return copies;
+        }
+
+        // objects of one class list the same properties, consecutive rows share their layout
+        std::shared_ptr<const MemoryRow::Columns> columns;
+        MemoryRow::Columns names;
+        for (const auto& row : rows) {
+            names.clear();
+            std::vector<Variant> values;
+            row->Enumerate([&names, &values](const std::wstring_view name, const Variant& value) {
+                names.emplace_back(name);
+                values.push_back(value);
+            });
+            if (!columns || *columns != names) {
+                columns = std::make_shared<const MemoryRow::Columns>(names);
+            }
+            copies.push_back(std::make_shared<MemoryRow>(columns, std::move(values)));
+        }
+        return copies;
+    }
+
+    /**
+     * narrows the merged rows down to the properties one requester selected
+     * \returns projected rows, nullopt if a selected property is missing from the merged rows
+     */
+    [[nodiscard]] static std::optional<std::vector<RowPtr>> Project(const Group& group,
+                                                                    const WqlQuery& query) {
+        if (query.properties.empty()) {
+            return group.rows;
+        }
+
+        const auto columns = std::make_shared<const MemoryRow::Columns>(query.properties);
+        std::vector<RowPtr> rows;
+        rows.reserve(group.rows.size());
+        for (const auto& row : group.rows) {
+            std::vector<Variant> values;
+            values.reserve(columns->size());
+            for (const auto& name : *columns) {
+                const auto* value = row->Find(name);
+                if (!value) {
+                    return std::nullopt;
+                }
+                values.push_back(*value);
+            }
+            rows.push_back(std::make_shared<MemoryRow>(columns, std::move(values)));
+        }
+        return rows;
+    }
+
+    [[nodiscard]] static bool Contains(const std::vector<std::wstring>& names,
+                                       const std::wstring_view name) {
+        for (const auto& existing : names) {
+            if (EqualsIgnoreCase(existing, name)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void Count(const std::size_t requests, const std::size_t round_trips) {
+        const std::lock_guard lock(mutex_);
+        stats_.requests += requests;
+        stats_.round_trips += round_trips;
+    }
+
+    std::shared_ptr<Backend> inner_;
+    CoalescingOptions options_;
+    mutable std::mutex mutex_;
+    std::map<std::wstring, std::shared_ptr<Group>> open_;
+    // passed-through queries of each group key that have not ended yet
+    std::map<std::wstring, std::size_t> running_;
+    CoalescingStats stats_;
+};
+
+}  // namespace wmi
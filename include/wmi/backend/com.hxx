@@ -0,0 +1,752 @@
+#pragma once
+
+#ifdef _WIN32
+
+#include <Wbemidl.h>
+#include <atlsafe.h>
+#include <comdef.h>
+
+#include <wmi/backend.hxx>
+#include <wmi/common.hxx>
+#include <wmi/property_name.hxx>
+#include <wmi/variant.hxx>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#pragma comment(lib, "wbemuuid.lib")
+
+namespace wmi {
+
+/**
+ * converts com variant containing bstr to standard string safely
+ * handles null bstr values and type checking to prevent crashes
+ * \param variant - com variant that may contain bstr data
+ * \returns optional string if conversion succeeds, nullopt otherwise
+ */
+[[nodiscard]] inline std::optional<std::string> ConvertBstrToString(const CComVariant& variant) {
+    if (variant.vt == VT_BSTR && variant.bstrVal) {
+        return NarrowString(std::wstring_view(variant.bstrVal, SysStringLen(variant.bstrVal)));
+    }
+    return std::nullopt;
+}
+
+/**
+ * moves a com variant into the portable representation
+ * bstr payloads are adopted rather than copied, the source variant is left empty
+ * \param variant - com variant returned by the provider
+ * \returns portable variant, empty for null or unsupported types
+ */
+[[nodiscard]] inline Variant TakeComVariant(CComVariant& variant) {
+    Variant result;
+    switch (variant.vt) {
+        case VT_BSTR:
+            result = Variant(WideString::Attach(variant.bstrVal));
+            variant.vt = VT_EMPTY;
+            variant.bstrVal = nullptr;
+            return result;
+        case VT_BOOL:
+            return Variant(variant.boolVal != VARIANT_FALSE);
+        case VT_I1:
+            return Variant(variant.cVal);
+        case VT_I2:
+            return Variant(variant.iVal);
+        case VT_I4:
+        case VT_INT:
+            return Variant(variant.lVal);
+        case VT_I8:
+            return Variant(variant.llVal);
+        case VT_UI1:
+            return Variant(variant.bVal);
+        case VT_UI2:
+            return Variant(variant.uiVal);
+        case VT_UI4:
+        case VT_UINT:
+            return Variant(variant.ulVal);
+        case VT_UI8:
+            return Variant(variant.ullVal);
+        case VT_R4:
+            return Variant(static_cast<double>(variant.fltVal));
+        case VT_R8:
+            return Variant(variant.dblVal);
+        case VT_ARRAY | VT_BSTR: {
+            //array string
+            CComSafeArray<BSTR> safe_array;
+            try {
+                safe_array.Attach(variant.parray);
+            } catch (...) {
+                return result;
+            }
+
+            std::vector<WideString> values;
+            const ULONG count = safe_array.GetCount();
+            values.reserve(count);
+            for (ULONG i = 0; i < count; ++i) {
+                if (auto bstr = safe_array.GetAt(i)) {
+                    values.emplace_back(std::wstring_view(bstr, SysStringLen(bstr)));
+                }
+            }
+
+            safe_array.Detach();
+            return Variant(std::move(values));
+        }
+        default:
+            return result;
+    }
+}
+
+/**
+ * manages com library initialization and cleanup using raii pattern
+ * ensures proper com initialization on construction and cleanup on destruction
+ * prevents resource leaks by automatically calling couninitialize when needed
+ */
+class COMInitializer {
+   public:
+    explicit COMInitializer(DWORD threading_model = COINIT_MULTITHREADED) : initialized_(false) {
+        HRESULT hr = CoInitializeEx(nullptr, threading_model);
+        if (SUCCEEDED(hr)) {
+            initialized_ = true;
+        } else if (hr != RPC_E_CHANGED_MODE) {
+            // jgn dulu plis
+            throw Exception(FormatHResultError("Failed to initialize COM library", hr));
+        }
+
+        hr = CoInitializeSecurity(NULL, -1, NULL, NULL, RPC_C_AUTHN_LEVEL_DEFAULT,
+                                  RPC_C_IMP_LEVEL_IMPERSONATE, NULL, EOAC_NONE, NULL);
+
+        if (FAILED(hr) && hr != RPC_E_TOO_LATE) {
+            // YYYYYYYYY
+            if (initialized_) {
+                CoUninitialize();
+                initialized_ = false;
+            }
+            throw Exception(FormatHResultError("Failed to initialize COM security", hr));
+        }
+    }
+
+    ~COMInitializer() noexcept {
+        if (initialized_) {
+            CoUninitialize();
+        }
+    }
+
+    COMInitializer(const COMInitializer&) = delete;
+    COMInitializer& operator=(const COMInitializer&) = delete;
+    COMInitializer(COMInitializer&&) = delete;
+    COMInitializer& operator=(COMInitializer&&) = delete;
+
+    [[nodiscard]] bool IsInitialized() const noexcept { return initialized_; }
+
+   private:
+    bool initialized_;
+};
+
+/**
+ * row backed by an IWbemClassObject
+ * properties are fetched on first access and kept so repeated reads are free
+ * and returned pointers stay valid for the lifetime of the row
+ */
+class ComRow final : public Row {
+   public:
+    explicit ComRow(CComPtr<IWbemClassObject> object) : object_(std::move(object)) {}
+
+    [[nodiscard]] const Variant* Find(const std::wstring_view name) const override {
+        const auto hash = detail::HashName(name);
+        if (const auto* cached = Cached(name, hash)) {
+            return cached;
+        }
+
+        // the view may not be null-terminated, com gets a terminated copy
+        std::wstring key(name);
+        CComVariant variant;
+        const auto result = object_->Get(key.c_str(), 0, &variant, nullptr, nullptr);
+        if (FAILED(result)) {
+            return nullptr;
+        }
+
+        return &Store(std::move(key), {}, hash, variant);
+    }
+
+    /**
+     * the token is hashed and terminated already, nothing is copied or allocated for the name
+     */
+    [[nodiscard]] const Variant* FindName(const PropertyName& name) const override {
+        if (const auto* cached = Cached(name.View(), name.Hash())) {
+            return cached;
+        }
+
+        CComVariant variant;
+        const auto result = object_->Get(name.CStr(), 0, &variant, nullptr, nullptr);
+        if (FAILED(result)) {
+            return nullptr;
+        }
+
+        return &Store({}, name.View(), name.Hash(), variant);
+    }
+
+    void Enumerate(
+        const std::function<void(std::wstring_view, const Variant&)>& visitor) const override {
+        if (FAILED(object_->BeginEnumeration(WBEM_FLAG_NONSYSTEM_ONLY))) {
+            return;
+        }
+
+        BSTR name = nullptr;
+        CComVariant variant;
+        while (object_->Next(0, &name, &variant, nullptr, nullptr) == WBEM_S_NO_ERROR) {
+            const WideString owned_name = WideString::Attach(name);
+            visitor(owned_name.View(), TakeComVariant(variant));
+            variant.Clear();
+        }
+
+        object_->EndEnumeration();
+    }
+
+    /**
+     * reads every property not cached yet in a single BeginEnumeration/Next walk
+     * instead of one IWbemClassObject::Get per name, stopping once all of them were seen
+     */
+    std::size_t FindAll(const std::wstring_view* names, const std::size_t count,
+                        const Variant** values) const override {
+        std::size_t found = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            values[i] = Cached(names[i], detail::HashName(names[i]));
+            found += values[i] ? 1 : 0;
+        }
+        if (found == count || FAILED(object_->BeginEnumeration(WBEM_FLAG_NONSYSTEM_ONLY))) {
+            return found;
+        }
+
+        BSTR name = nullptr;
+        CComVariant variant;
+        while (found < count &&
+               object_->Next(0, &name, &variant, nullptr, nullptr) == WBEM_S_NO_ERROR) {
+            const WideString owned_name = WideString::Attach(name);
+            const Variant* stored = nullptr;
+            for (std::size_t i = 0; i < count; ++i) {
+                if (values[i] || !EqualsIgnoreCase(names[i], owned_name.View())) {
+                    continue;
+                }
+                if (!stored) {
+                    stored = &Store(std::wstring(owned_name.View()), {},
+                                    detail::HashName(owned_name.View()), variant);
+                }
+                values[i] = stored;
+                ++found;
+            }
+            variant.Clear();
+        }
+
+        object_->EndEnumeration();
+        return found;
+    }
+
+    /**
+     * FindAll for name tokens: every walked property is hashed once and compared against the
+     * precomputed hashes before its text, and is cached under the token without a name copy
+     */
+    std::size_t FindAllNames(const PropertyName* names, const std::size_t count,
+                             const Variant** values) const override {
+        std::size_t found = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            values[i] = Cached(names[i].View(), names[i].Hash());
+            found += values[i] ? 1 : 0;
+        }
+        if (found == count || FAILED(object_->BeginEnumeration(WBEM_FLAG_NONSYSTEM_ONLY))) {
+            return found;
+        }
+
+        BSTR name = nullptr;
+        CComVariant variant;
+        while (found < count &&
+               object_->Next(0, &name, &variant, nullptr, nullptr) == WBEM_S_NO_ERROR) {
+            const WideString owned_name = WideString::Attach(name);
+            const auto hash = detail::HashName(owned_name.View());
+            const Variant* stored = nullptr;
+            for (std::size_t i = 0; i < count; ++i) {
+                if (values[i] || names[i].Hash() != hash ||
+                    !EqualsIgnoreCase(names[i].View(), owned_name.View())) {
+                    continue;
+                }
+                if (!stored) {
+                    stored = &Store({}, names[i].View(), hash, variant);
+                }
+                values[i] = stored;
+                ++found;
+            }
+            variant.Clear();
+        }
+
+        object_->EndEnumeration();
+        return found;
+    }
+
+    [[nodiscard]] PropertyHandle Resolve(const std::wstring_view name) const override {
+        auto handle = Row::Resolve(name);
+        if (!Access()) {
+            return handle;
+        }
+
+        CIMTYPE type = CIM_EMPTY;
+        long property = 0;
+        // arrays and embedded objects have no handle and keep going through Get
+        if (SUCCEEDED(access_->GetPropertyHandle(handle.name.c_str(), &type, &property))) {
+            handle.handle = property;
+            handle.type = type;
+        }
+        return handle;
+    }
+
+    /**
+     * reads through IWbemObjectAccess without a com variant or a name lookup
+     * null properties read as an empty variant, numbers included
+     */
+    [[nodiscard]] const Variant* Read(const PropertyHandle& handle) const override {
+        if (!handle.IsValid() || handle.layout || !Access()) {
+            return Row::Read(handle);
+        }
+
+        for (const auto& [property, value] : reads_) {
+            if (property == handle.handle) {
+                return &value;
+            }
+        }
+
+        auto value = ReadHandle(handle);
+        if (!value) {
+            return Row::Read(handle);
+        }
+        reads_.emplace_back(handle.handle, std::move(*value));
+        return &reads_.back().second;
+    }
+
+    /**
+     * fetches the whole row in the single walk of FindAll rather than one read per handle
+     */
+    std::size_t ReadAll(const PropertyHandle* handles, const std::size_t count,
+                        const Variant** values) const override {
+        std::vector<std::wstring_view> names;
+        names.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            names.emplace_back(handles[i].name);
+        }
+        return FindAll(names.data(), count, values);
+    }
+
+    [[nodiscard]] IWbemClassObject* GetObjectPtr() const noexcept { return object_; }
+
+   private:
+    // characters read without a heap buffer, longer strings take a second call
+    static constexpr std::size_t INLINE_STRING_LENGTH = 128;
+
+    /**
+     * \returns value behind the handle, nullopt if IWbemObjectAccess cannot read it
+     */
+    [[nodiscard]] std::optional<Variant> ReadHandle(const PropertyHandle& handle) const {
+        DWORD dword = 0;
+        unsigned __int64 qword = 0;
+        switch (handle.type) {
+            case CIM_BOOLEAN:
+            case CIM_SINT8:
+            case CIM_UINT8:
+            case CIM_SINT16:
+            case CIM_UINT16:
+            case CIM_CHAR16:
+            case CIM_SINT32:
+            case CIM_UINT32:
+            case CIM_REAL32:
+                if (IsNull(handle)) {
+                    return Variant();
+                }
+                if (FAILED(access_->ReadDWORD(handle.handle, &dword))) {
+                    return std::nullopt;
+                }
+                return FromDword(handle.type, dword);
+            case CIM_SINT64:
+            case CIM_UINT64:
+            case CIM_REAL64:
+                if (IsNull(handle)) {
+                    return Variant();
+                }
+                // 64-bit integers are strings in a variant, but native through a handle
+                if (FAILED(access_->ReadQWORD(handle.handle, &qword))) {
+                    return std::nullopt;
+                }
+                return FromQword(handle.type, qword);
+            case CIM_STRING:
+            case CIM_DATETIME:
+            case CIM_REFERENCE:
+                return ReadString(handle);
+            default:
+                return std::nullopt;
+        }
+    }
+
+    /**
+     * ReadDWORD and ReadQWORD read a null number as zero, ReadPropertyValue reports it
+     */
+    [[nodiscard]] bool IsNull(const PropertyHandle& handle) const {
+        unsigned __int64 value = 0;
+        long bytes = 0;
+        return access_->ReadPropertyValue(handle.handle, sizeof(value), &bytes,
+                                          reinterpret_cast<byte*>(&value)) == WBEM_S_FALSE;
+    }
+
+    struct CachedProperty {
+        // set for names the row had to copy, empty when name refers to a PropertyName
+        std::wstring owned_name;
+        std::wstring_view name;
+        std::uint64_t hash = 0;
+        Variant value;
+    };
+
+    [[nodiscard]] const Variant* Cached(const std::wstring_view name,
+                                        const std::uint64_t hash) const {
+        for (const auto& property : cache_) {
+            if (property.hash == hash && EqualsIgnoreCase(property.name, name)) {
+                return &property.value;
+            }
+        }
+        return nullptr;
+    }
+
+    const Variant& Store(std::wstring owned_name, const std::wstring_view name,
+                         const std::uint64_t hash, CComVariant& variant) const {
+        auto& property = cache_.emplace_back();
+        property.owned_name = std::move(owned_name);
+        // the view is taken after the string reached its final place in the deque
+        property.name =
+            property.owned_name.empty() ? name : std::wstring_view(property.owned_name);
+        property.hash = hash;
+        property.value = TakeComVariant(variant);
+        return property.value;
+    }
+
+    // IWbemObjectAccess is asked for once per row, nullptr when the object lacks it
+    [[nodiscard]] IWbemObjectAccess* Access() const {
+        if (!access_queried_) {
+            access_queried_ = true;
+            object_->QueryInterface(IID_IWbemObjectAccess, reinterpret_cast<void**>(&access_));
+        }
+        return access_;
+    }
+
+    [[nodiscard]] static Variant FromDword(const long type, const DWORD value) {
+        switch (type) {
+            case CIM_BOOLEAN:
+                return Variant(value != 0);
+            case CIM_SINT8:
+                return Variant(static_cast<std::int8_t>(value));
+            case CIM_SINT16:
+                return Variant(static_cast<std::int16_t>(value));
+            case CIM_SINT32:
+                return Variant(static_cast<std::int32_t>(value));
+            case CIM_REAL32: {
+                float real = 0;
+                std::memcpy(&real, &value, sizeof(real));
+                return Variant(static_cast<double>(real));
+            }
+            default:
+                return Variant(static_cast<std::uint32_t>(value));
+        }
+    }
+
+    [[nodiscard]] static Variant FromQword(const long type, const unsigned __int64 value) {
+        switch (type) {
+            case CIM_SINT64:
+                return Variant(static_cast<std::int64_t>(value));
+            case CIM_REAL64: {
+                double real = 0;
+                std::memcpy(&real, &value, sizeof(real));
+                return Variant(real);
+            }
+            default:
+                return Variant(static_cast<std::uint64_t>(value));
+        }
+    }
+
+    [[nodiscard]] std::optional<Variant> ReadString(const PropertyHandle& handle) const {
+        wchar_t buffer[INLINE_STRING_LENGTH];
+        long bytes = 0;
+        auto result = access_->ReadPropertyValue(handle.handle, sizeof(buffer), &bytes,
+                                                 reinterpret_cast<byte*>(buffer));
+        if (result == WBEM_S_FALSE) {
+            // null string
+            return Variant();
+        }
+        if (result == WBEM_E_BUFFER_TOO_SMALL) {
+            std::vector<wchar_t> large(static_cast<std::size_t>(bytes) / sizeof(wchar_t));
+            result = access_->ReadPropertyValue(handle.handle, bytes, &bytes,
+                                                reinterpret_cast<byte*>(large.data()));
+            if (FAILED(result)) {
+                return std::nullopt;
+            }
+            return Variant(Terminated(large.data(), bytes));
+        }
+        if (FAILED(result)) {
+            return std::nullopt;
+        }
+        return Variant(Terminated(buffer, bytes));
+    }
+
+    // bytes reported by ReadPropertyValue include the terminating null
+    [[nodiscard]] static std::wstring_view Terminated(const wchar_t* text, const long bytes) {
+        const auto length = static_cast<std::size_t>(bytes) / sizeof(wchar_t);
+        return std::wstring_view(text, length > 0 ? length - 1 : 0);
+    }
+
+    CComPtr<IWbemClassObject> object_;
+    mutable CComPtr<IWbemObjectAccess> access_;
+    mutable bool access_queried_ = false;
+    // values read through handles, keyed by handle
+    mutable std::deque<std::pair<long, Variant>> reads_;
+    // deque keeps element addresses stable while the cache grows
+    mutable std::deque<CachedProperty> cache_;
+};
+
+/**
+ * enumerator over an IEnumWbemClassObject
+ */
+class ComEnumerator final : public Enumerator {
+   public:
+    explicit ComEnumerator(CComPtr<IEnumWbemClassObject> enumerator)
+        : enumerator_(std::move(enumerator)) {}
+
+    HResult Next(const long timeout_ms, const std::size_t count,
+                 std::vector<RowPtr>& rows) override {
+        std::vector<IWbemClassObject*> objects(count, nullptr);
+        ULONG returned_count = 0;
+
+        const auto result = enumerator_->Next(timeout_ms, static_cast<ULONG>(count),
+                                              objects.data(), &returned_count);
+
+        rows.reserve(rows.size() + returned_count);
+        for (ULONG i = 0; i < returned_count; ++i) {
+            CComPtr<IWbemClassObject> object;
+            object.Attach(objects[i]);
+            rows.push_back(std::make_shared<ComRow>(std::move(object)));
+        }
+
+        return result;
+    }
+
+    HResult Reset() override { return enumerator_->Reset(); }
+
+   private:
+    CComPtr<IEnumWbemClassObject> enumerator_;
+};
+
+/**
+ * IWbemObjectSink handed to ExecQueryAsync, forwards indications to a portable ObjectSink
+ * reference counted by com: wmi may keep it past the end of the query
+ */
+class ComObjectSink final : public IWbemObjectSink {
+   public:
+    explicit ComObjectSink(std::shared_ptr<ObjectSink> sink) : sink_(std::move(sink)) {}
+
+    ULONG STDMETHODCALLTYPE AddRef() override { return InterlockedIncrement(&references_); }
+
+    ULONG STDMETHODCALLTYPE Release() override {
+        const auto references = InterlockedDecrement(&references_);
+        if (references == 0) {
+            delete this;
+        }
+        return references;
+    }
+
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** object) override {
+        if (riid == IID_IUnknown || riid == IID_IWbemObjectSink) {
+            *object = static_cast<IWbemObjectSink*>(this);
+            AddRef();
+            return WBEM_S_NO_ERROR;
+        }
+        *object = nullptr;
+        return E_NOINTERFACE;
+    }
+
+    HRESULT STDMETHODCALLTYPE Indicate(const long count, IWbemClassObject** objects) override {
+        if (completed_.load(std::memory_order_acquire)) {
+            return WBEM_S_NO_ERROR;
+        }
+
+        std::vector<RowPtr> rows;
+        rows.reserve(static_cast<std::size_t>(count));
+        for (long i = 0; i < count; ++i) {
+            // wmi releases the objects after the call, the rows keep their own reference
+            rows.push_back(std::make_shared<ComRow>(CComPtr<IWbemClassObject>(objects[i])));
+        }
+        sink_->Indicate(rows);
+        return WBEM_S_NO_ERROR;
+    }
+
+    HRESULT STDMETHODCALLTYPE SetStatus(const long flags, const HRESULT result, BSTR /*param*/,
+                                        IWbemClassObject* /*error*/) override {
+        if (flags == WBEM_STATUS_COMPLETE) {
+            Complete(result == WBEM_E_CALL_CANCELLED ? status::Cancelled : result);
+        }
+        return WBEM_S_NO_ERROR;
+    }
+
+    /**
+     * delivers the final status once, whichever of wmi and a cancellation comes first
+     */
+    void Complete(const HResult result) {
+        if (!completed_.exchange(true, std::memory_order_acq_rel)) {
+            sink_->SetStatus(result, nullptr);
+        }
+    }
+
+   private:
+    ~ComObjectSink() = default;
+
+    LONG references_ = 0;
+    std::shared_ptr<ObjectSink> sink_;
+    std::atomic<bool> completed_{false};
+};
+
+/**
+ * running ExecQueryAsync call, cancelled through IWbemServices::CancelAsyncCall
+ */
+class ComAsyncCall final : public AsyncCall {
+   public:
+    ComAsyncCall(CComPtr<IWbemServices> services, CComPtr<ComObjectSink> sink)
+        : services_(std::move(services)), sink_(std::move(sink)) {}
+
+    ~ComAsyncCall() override { Cancel(); }
+
+    ComAsyncCall(const ComAsyncCall&) = delete;
+    ComAsyncCall& operator=(const ComAsyncCall&) = delete;
+
+    void Cancel() override {
+        if (!sink_) {
+            return;
+        }
+        // fails harmlessly when the call already completed
+        services_->CancelAsyncCall(sink_);
+        sink_->Complete(status::Cancelled);
+        sink_.Release();
+    }
+
+   private:
+    CComPtr<IWbemServices> services_;
+    CComPtr<ComObjectSink> sink_;
+};
+
+/**
+ * backend talking to the local wmi service through IWbemLocator/IWbemServices
+ */
+class ComBackend final : public Backend {
+   public:
+    void Connect(const std::string_view path) override {
+        auto result = CoCreateInstance(CLSID_WbemLocator, nullptr, CLSCTX_INPROC_SERVER,
+                                       IID_IWbemLocator, reinterpret_cast<LPVOID*>(&locator_));
+        if (FAILED(result)) {
+            // error locator
+            throw Exception("Failed to create WbemLocator object. " +
+                            FormatHResultError("Check if WMI service is available", result));
+        }
+
+        // wmi namespace
+        result = locator_->ConnectServer(bstr_t(R"(\\.\root\)") + bstr_t(std::string(path).c_str()),
+                                         nullptr, nullptr, nullptr, 0, nullptr, nullptr,
+                                         &services_);
+        if (FAILED(result)) {
+            throw Exception(
+                "Could not connect to WMI namespace '" + std::string(path) + "'. " +
+                FormatHResultError("Verify namespace exists and access permissions", result));
+        }
+
+        // apcb
+        result = CoSetProxyBlanket(services_, RPC_C_AUTHN_DEFAULT, RPC_C_AUTHZ_NONE,
+                                   COLE_DEFAULT_PRINCIPAL, RPC_C_AUTHN_LEVEL_DEFAULT,
+                                   RPC_C_IMP_LEVEL_IMPERSONATE, nullptr, EOAC_NONE);
+        if (FAILED(result)) {
+            // error security
+            throw Exception("Could not set proxy blanket for WMI connection. " +
+                            FormatHResultError("Authentication may have failed", result));
+        }
+    }
+
+    [[nodiscard]] std::shared_ptr<Enumerator> ExecQuery(const std::wstring_view query) override {
+        CComPtr<IEnumWbemClassObject> enumerator;
+        const auto query_bstr = bstr_t(std::wstring(query).c_str());
+        const auto result = services_->ExecQuery(
+            bstr_t("WQL"), query_bstr, WBEM_FLAG_FORWARD_ONLY | WBEM_FLAG_RETURN_IMMEDIATELY,
+            nullptr, &enumerator);
+
+        if (FAILED(result)) {
+            throw Exception(
+                "WQL query execution failed for query: '" + NarrowString(query) + "'. " +
+                FormatHResultError("Check query syntax and target class availability", result));
+        }
+
+        return std::make_shared<ComEnumerator>(std::move(enumerator));
+    }
+
+    [[nodiscard]] std::unique_ptr<AsyncCall> ExecQueryAsync(
+        const std::wstring_view query, std::shared_ptr<ObjectSink> sink) override {
+        CComPtr<ComObjectSink> com_sink(new ComObjectSink(std::move(sink)));
+        const auto query_bstr = bstr_t(std::wstring(query).c_str());
+        const auto result = services_->ExecQueryAsync(bstr_t("WQL"), query_bstr,
+                                                      WBEM_FLAG_BIDIRECTIONAL, nullptr, com_sink);
+
+        if (FAILED(result)) {
+            throw Exception(
+                "WQL query execution failed for query: '" + NarrowString(query) + "'. " +
+                FormatHResultError("Check query syntax and target class availability", result));
+        }
+
+        return std::make_unique<ComAsyncCall>(services_, std::move(com_sink));
+    }
+
+    /**
+     * reads the class definition with IWbemServices::GetObject
+     */
+    [[nodiscard]] std::optional<ClassSchema> GetClassSchema(
+        const std::wstring_view class_name) override {
+        CComPtr<IWbemClassObject> class_object;
+        const auto result = services_->GetObject(bstr_t(std::wstring(class_name).c_str()), 0,
+                                                 nullptr, &class_object, nullptr);
+        if (result == WBEM_E_NOT_FOUND || result == WBEM_E_INVALID_CLASS) {
+            throw Exception("WMI class '" + NarrowString(class_name) + "' does not exist. " +
+                            FormatHResultError("Check the class name and namespace", result));
+        }
+        // a schema only enables early checks, queries still work without one
+        if (FAILED(result) || FAILED(class_object->BeginEnumeration(WBEM_FLAG_NONSYSTEM_ONLY))) {
+            return std::nullopt;
+        }
+
+        ClassSchema schema;
+        schema.class_name = class_name;
+        BSTR name = nullptr;
+        CIMTYPE type = CIM_EMPTY;
+        while (class_object->Next(0, &name, nullptr, &type, nullptr) == WBEM_S_NO_ERROR) {
+            const WideString owned_name = WideString::Attach(name);
+            PropertySchema property;
+            property.name = owned_name.View();
+            property.type = static_cast<CimType>(type & ~CIM_FLAG_ARRAY);
+            property.is_array = (type & CIM_FLAG_ARRAY) != 0;
+            schema.properties.push_back(std::move(property));
+        }
+        class_object->EndEnumeration();
+        return schema;
+    }
+
+    [[nodiscard]] IWbemServices* GetServices() const noexcept { return services_; }
+
+   private:
+    CComPtr<IWbemLocator> locator_;
+    CComPtr<IWbemServices> services_;
+};
+
+}  // namespace wmi
+
+#endif  // _WIN32
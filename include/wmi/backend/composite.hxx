@@ -0,0 +1,92 @@
+#pragma once
+
+#include <wmi/backend.hxx>
+#include <wmi/common.hxx>
+#include <wmi/wql.hxx>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace wmi {
+
+/**
+ * backend that routes every query to the provider registered for its class
+ * lets several single-class native providers act as one wmi namespace
+ */
+class CompositeBackend final : public Backend {
+   public:
+    /**
+     * registers the provider answering a class
+     * \param class_name - wmi class, matched case-insensitively
+     * \param provider - backend serving queries against that class
+     * \returns reference to this backend for chaining
+     */
+    CompositeBackend& Register(const std::wstring_view class_name,
+                               std::shared_ptr<Backend> provider) {
+        for (auto& [name, existing] : providers_) {
+            if (EqualsIgnoreCase(name, class_name)) {
+                existing = std::move(provider);
+                return *this;
+            }
+        }
+        providers_.emplace_back(std::wstring(class_name), std::move(provider));
+        return *this;
+    }
+
+    void Connect(const std::string_view path) override {
+        std::vector<Backend*> connected;
+        for (const auto& [name, provider] : providers_) {
+            // one provider may serve several classes
+            if (std::find(connected.begin(), connected.end(), provider.get()) == connected.end()) {
+                provider->Connect(path);
+                connected.push_back(provider.get());
+            }
+        }
+    }
+
+    [[nodiscard]] std::shared_ptr<Enumerator> ExecQuery(const std::wstring_view query) override {
+        return Route(query).ExecQuery(query);
+    }
+
+    [[nodiscard]] std::unique_ptr<AsyncCall> ExecQueryAsync(
+        const std::wstring_view query, std::shared_ptr<ObjectSink> sink) override {
+        return Route(query).ExecQueryAsync(query, std::move(sink));
+    }
+
+    [[nodiscard]] std::optional<ClassSchema> GetClassSchema(
+        const std::wstring_view class_name) override {
+        for (const auto& [name, provider] : providers_) {
+            if (EqualsIgnoreCase(name, class_name)) {
+                return provider->GetClassSchema(class_name);
+            }
+        }
+        throw Exception("WMI class '" + NarrowString(class_name) + "' does not exist. " +
+                        FormatHResultError("No provider for class", status::InvalidClass));
+    }
+
+   private:
+    [[nodiscard]] Backend& Route(const std::wstring_view query) const {
+        const auto parsed = ParseWql(query);
+        if (!parsed) {
+            throw Exception("WQL query execution failed for query: '" + NarrowString(query) +
+                            "'. " + FormatHResultError("Unsupported query", status::InvalidQuery));
+        }
+
+        for (const auto& [name, provider] : providers_) {
+            if (EqualsIgnoreCase(name, parsed->class_name)) {
+                return *provider;
+            }
+        }
+
+        throw Exception("WQL query execution failed for query: '" + NarrowString(query) + "'. " +
+                        FormatHResultError("No provider for class", status::InvalidClass));
+    }
+
+    std::vector<std::pair<std::wstring, std::shared_ptr<Backend>>> providers_;
+};
+
+}  // namespace wmi
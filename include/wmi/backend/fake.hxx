@@ -0,0 +1,229 @@
+#pragma once
+
+#include <wmi/backend.hxx>
+#include <wmi/common.hxx>
+#include <wmi/variant.hxx>
+#include <wmi/wql.hxx>
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace wmi {
+
+/**
+ * scripted in-memory provider
+ * tests and benchmarks register objects per class, queries are answered from those tables
+ * with the projection and WHERE condition applied, so the whole library runs without a wmi service
+ */
+class FakeBackend final : public Backend {
+   public:
+    using Property = std::pair<std::wstring_view, Variant>;
+
+    /**
+     * adds an object to the table of a class
+     * \param class_name - wmi class the object belongs to
+     * \param properties - property names and values of the object
+     * \returns reference to this backend for chaining
+     */
+    FakeBackend& AddObject(const std::wstring_view class_name,
+                           const std::initializer_list<Property> properties) {
+        const std::lock_guard lock(mutex_);
+
+        auto& table = FindOrAddTable(class_name);
+        std::vector<Variant> values(table.columns.size());
+        for (const auto& [name, value] : properties) {
+            const auto slot = FindOrAddColumn(table, name);
+            values.resize(table.columns.size());
+            values[slot] = value;
+        }
+        table.objects.push_back(std::move(values));
+        return *this;
+    }
+
+    /**
+     * declares the property types of a class, answered by GetClassSchema
+     * classes without a description report no schema and are not checked
+     * \param class_name - wmi class
+     * \param properties - declared properties of the class
+     * \returns reference to this backend for chaining
+     */
+    FakeBackend& DescribeClass(const std::wstring_view class_name,
+                               std::vector<PropertySchema> properties) {
+        const std::lock_guard lock(mutex_);
+        auto& table = FindOrAddTable(class_name);
+        table.schema = ClassSchema{table.class_name, std::move(properties)};
+        return *this;
+    }
+
+    /**
+     * removes every object of a class, the class itself stays known
+     */
+    void ClearObjects(const std::wstring_view class_name) {
+        const std::lock_guard lock(mutex_);
+        FindOrAddTable(class_name).objects.clear();
+    }
+
+    void Connect(const std::string_view path) override {
+        const std::lock_guard lock(mutex_);
+        namespace_ = path;
+    }
+
+    [[nodiscard]] std::shared_ptr<Enumerator> ExecQuery(const std::wstring_view query) override {
+        query_count_.fetch_add(1, std::memory_order_relaxed);
+
+        const auto parsed = ParseWql(query);
+        if (!parsed) {
+            throw Exception("WQL query execution failed for query: '" + NarrowString(query) +
+                            "'. " + FormatHResultError("Unsupported query", status::InvalidQuery));
+        }
+
+        const std::lock_guard lock(mutex_);
+
+        const auto* table = FindTable(parsed->class_name);
+        if (!table) {
+            throw Exception("WQL query execution failed for query: '" + NarrowString(query) +
+                            "'. " + FormatHResultError("Unknown class", status::InvalidClass));
+        }
+
+        // projection, resolved once per query
+        std::vector<std::size_t> slots;
+        auto columns = std::make_shared<MemoryRow::Columns>();
+        if (parsed->properties.empty()) {
+            columns->assign(table->columns.begin(), table->columns.end());
+            for (std::size_t i = 0; i < table->columns.size(); ++i) {
+                slots.push_back(i);
+            }
+        } else {
+            for (const auto& property : parsed->properties) {
+                const auto slot = FindColumn(*table, property);
+                if (slot == table->columns.size()) {
+                    throw Exception(
+                        "WQL query execution failed for query: '" + NarrowString(query) + "'. " +
+                        FormatHResultError("Unknown property", status::InvalidQuery));
+                }
+                columns->push_back(table->columns[slot]);
+                slots.push_back(slot);
+            }
+        }
+
+        std::optional<WqlCondition> condition;
+        if (!parsed->where.empty()) {
+            condition = WqlCondition::Parse(parsed->where);
+            if (!condition) {
+                throw Exception(
+                    "WQL query execution failed for query: '" + NarrowString(query) + "'. " +
+                    FormatHResultError("Unsupported condition", status::InvalidQuery));
+            }
+            for (const auto& property : condition->Properties()) {
+                if (FindColumn(*table, property) == table->columns.size()) {
+                    throw Exception(
+                        "WQL query execution failed for query: '" + NarrowString(query) + "'. " +
+                        FormatHResultError("Unknown property", status::InvalidQuery));
+                }
+            }
+        }
+
+        std::vector<RowPtr> rows;
+        rows.reserve(table->objects.size());
+        for (const auto& object : table->objects) {
+            if (condition && !condition->Matches([&](const std::wstring_view name) {
+                    return &object[FindColumn(*table, name)];
+                })) {
+                continue;
+            }
+
+            std::vector<Variant> values;
+            values.reserve(slots.size());
+            for (const auto slot : slots) {
+                values.push_back(object[slot]);
+            }
+            rows.push_back(std::make_shared<MemoryRow>(columns, std::move(values)));
+        }
+
+        return std::make_shared<MemoryEnumerator>(std::move(rows));
+    }
+
+    [[nodiscard]] std::optional<ClassSchema> GetClassSchema(
+        const std::wstring_view class_name) override {
+        const std::lock_guard lock(mutex_);
+        const auto* table = FindTable(class_name);
+        if (!table) {
+            throw Exception("WMI class '" + NarrowString(class_name) + "' does not exist. " +
+                            FormatHResultError("Unknown class", status::InvalidClass));
+        }
+        return table->schema;
+    }
+
+    /**
+     * number of queries executed so far, used to verify round-trip savings
+     */
+    [[nodiscard]] std::size_t QueryCount() const noexcept {
+        return query_count_.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] std::string GetNamespace() const {
+        const std::lock_guard lock(mutex_);
+        return namespace_;
+    }
+
+   private:
+    struct Table {
+        std::wstring class_name;
+        std::vector<std::wstring> columns;
+        std::vector<std::vector<Variant>> objects;
+        std::optional<ClassSchema> schema;
+    };
+
+    [[nodiscard]] const Table* FindTable(const std::wstring_view class_name) const {
+        for (const auto& table : tables_) {
+            if (EqualsIgnoreCase(table.class_name, class_name)) {
+                return &table;
+            }
+        }
+        return nullptr;
+    }
+
+    Table& FindOrAddTable(const std::wstring_view class_name) {
+        if (const auto* table = FindTable(class_name)) {
+            return const_cast<Table&>(*table);
+        }
+        tables_.push_back(Table{std::wstring(class_name), {}, {}, std::nullopt});
+        return tables_.back();
+    }
+
+    [[nodiscard]] static std::size_t FindColumn(const Table& table, const std::wstring_view name) {
+        for (std::size_t i = 0; i < table.columns.size(); ++i) {
+            if (EqualsIgnoreCase(table.columns[i], name)) {
+                return i;
+            }
+        }
+        return table.columns.size();
+    }
+
+    static std::size_t FindOrAddColumn(Table& table, const std::wstring_view name) {
+        const auto slot = FindColumn(table, name);
+        if (slot == table.columns.size()) {
+            table.columns.emplace_back(name);
+            for (auto& object : table.objects) {
+                object.resize(table.columns.size());
+            }
+        }
+        return slot;
+    }
+
+    mutable std::mutex mutex_;
+    std::string namespace_;
+    std::deque<Table> tables_;
+    std::atomic<std::size_t> query_count_{0};
+};
+
+}  // namespace wmi
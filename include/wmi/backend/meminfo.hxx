@@ -0,0 +1,239 @@
+#pragma once
+
+#ifdef __linux__
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <wmi/backend.hxx>
+#include <wmi/common.hxx>
+#include <wmi/wql.hxx>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace wmi {
+
+/**
+ * native linux provider for the memory columns of Win32_OperatingSystem
+ * keeps /proc/meminfo open and re-reads it with pread into a stack buffer,
+ * so a poll costs one syscall and an allocation-free scan instead of a wmi round trip
+ */
+class MeminfoBackend final : public Backend {
+   public:
+    /**
+     * values read from one /proc/meminfo snapshot, in kilobytes like the wmi columns
+     */
+    struct Snapshot {
+        std::uint64_t total_kb = 0;
+        std::uint64_t free_kb = 0;
+        std::uint64_t available_kb = 0;
+        std::uint64_t swap_total_kb = 0;
+        std::uint64_t swap_free_kb = 0;
+        bool has_available = false;
+    };
+
+    explicit MeminfoBackend(const std::string& path = "/proc/meminfo")
+        : fd_(open(path.c_str(), O_RDONLY | O_CLOEXEC)) {
+        if (fd_ < 0) {
+            throw Exception("Could not open '" + path + "': " + std::strerror(errno));
+        }
+    }
+
+    ~MeminfoBackend() noexcept override { close(fd_); }
+
+    MeminfoBackend(const MeminfoBackend&) = delete;
+    MeminfoBackend& operator=(const MeminfoBackend&) = delete;
+    MeminfoBackend(MeminfoBackend&&) = delete;
+    MeminfoBackend& operator=(MeminfoBackend&&) = delete;
+
+    void Connect(std::string_view /*path*/) override {}
+
+    [[nodiscard]] std::shared_ptr<Enumerator> ExecQuery(const std::wstring_view query) override {
+        const auto parsed = ParseWql(query);
+        if (!parsed || !EqualsIgnoreCase(parsed->class_name, L"Win32_OperatingSystem")) {
+            throw Exception("WQL query execution failed for query: '" + NarrowString(query) +
+                            "'. " + FormatHResultError("Unsupported query", status::InvalidQuery));
+        }
+        const auto condition = ParseWqlWhere(query, *parsed, [](const std::wstring_view name) {
+            return ColumnIndex(name) < COLUMN_COUNT;
+        });
+
+        Snapshot snapshot;
+        if (!Read(snapshot)) {
+            throw Exception("WQL query execution failed for query: '" + NarrowString(query) +
+                            "'. " + FormatHResultError("Could not read /proc/meminfo",
+                                                       status::Failed));
+        }
+
+        auto columns = std::make_shared<MemoryRow::Columns>();
+        std::vector<Variant> values;
+        const auto project = [&](const std::wstring_view name) {
+            const auto value = Column(snapshot, name);
+            if (!value) {
+                return false;
+            }
+            columns->emplace_back(name);
+            values.emplace_back(*value);
+            return true;
+        };
+
+        if (parsed->properties.empty()) {
+            for (const auto* name : COLUMNS) {
+                project(name);
+            }
+        } else {
+            for (const auto& property : parsed->properties) {
+                if (!project(property)) {
+                    throw Exception(
+                        "WQL query execution failed for query: '" + NarrowString(query) + "'. " +
+                        FormatHResultError("Property not served by /proc/meminfo",
+                                           status::InvalidQuery));
+                }
+            }
+        }
+
+        std::vector<RowPtr> rows;
+        if (condition) {
+            // the condition may test columns outside the projection
+            Variant all[COLUMN_COUNT];
+            for (std::size_t i = 0; i < COLUMN_COUNT; ++i) {
+                all[i] = Variant(*Column(snapshot, COLUMNS[i]));
+            }
+            if (!condition->Matches(
+                    [&all](const std::wstring_view name) { return &all[ColumnIndex(name)]; })) {
+                return std::make_shared<MemoryEnumerator>(std::move(rows));
+            }
+        }
+        rows.push_back(std::make_shared<MemoryRow>(std::move(columns), std::move(values)));
+        return std::make_shared<MemoryEnumerator>(std::move(rows));
+    }
+
+    /**
+     * reads and parses the current /proc/meminfo contents without allocating
+     * safe to call from several threads, pread does not move a shared file offset
+     * \param snapshot - receives the parsed values
+     * \returns true when at least MemTotal and MemFree were found
+     */
+    bool Read(Snapshot& snapshot) const noexcept {
+        char buffer[8192];
+        std::size_t length = 0;
+        while (length < sizeof(buffer)) {
+            const auto count = pread(fd_, buffer + length, sizeof(buffer) - length,
+                                     static_cast<off_t>(length));
+            if (count < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            if (count == 0) {
+                break;
+            }
+            length += static_cast<std::size_t>(count);
+        }
+
+        bool has_total = false;
+        bool has_free = false;
+        snapshot = Snapshot{};
+
+        const std::string_view text(buffer, length);
+        std::size_t position = 0;
+        while (position < text.size()) {
+            auto end = text.find('\n', position);
+            if (end == std::string_view::npos) {
+                end = text.size();
+            }
+            const auto line = text.substr(position, end - position);
+            position = end + 1;
+
+            const auto colon = line.find(':');
+            if (colon == std::string_view::npos) {
+                continue;
+            }
+            const auto key = line.substr(0, colon);
+            const auto value = ParseKilobytes(line.substr(colon + 1));
+
+            if (key == "MemTotal") {
+                snapshot.total_kb = value;
+                has_total = true;
+            } else if (key == "MemFree") {
+                snapshot.free_kb = value;
+                has_free = true;
+            } else if (key == "MemAvailable") {
+                snapshot.available_kb = value;
+                snapshot.has_available = true;
+            } else if (key == "SwapTotal") {
+                snapshot.swap_total_kb = value;
+            } else if (key == "SwapFree") {
+                snapshot.swap_free_kb = value;
+            }
+        }
+
+        return has_total && has_free;
+    }
+
+   private:
+    static constexpr std::size_t COLUMN_COUNT = 4;
+
+    static constexpr const wchar_t* COLUMNS[COLUMN_COUNT] = {
+        L"TotalVisibleMemorySize", L"FreePhysicalMemory", L"TotalVirtualMemorySize",
+        L"FreeVirtualMemory"};
+
+    [[nodiscard]] static std::size_t ColumnIndex(const std::wstring_view name) {
+        for (std::size_t i = 0; i < COLUMN_COUNT; ++i) {
+            if (EqualsIgnoreCase(name, COLUMNS[i])) {
+                return i;
+            }
+        }
+        return COLUMN_COUNT;
+    }
+
+    /**
+     * maps a wmi column to the snapshot value
+     * windows counts standby pages as free, which is what MemAvailable reports
+     */
+    [[nodiscard]] static std::optional<std::uint64_t> Column(const Snapshot& snapshot,
+                                                             const std::wstring_view name) {
+        const auto free_kb = snapshot.has_available ? snapshot.available_kb : snapshot.free_kb;
+        if (EqualsIgnoreCase(name, COLUMNS[0])) {
+            return snapshot.total_kb;
+        }
+        if (EqualsIgnoreCase(name, COLUMNS[1])) {
+            return free_kb;
+        }
+        if (EqualsIgnoreCase(name, COLUMNS[2])) {
+            return snapshot.total_kb + snapshot.swap_total_kb;
+        }
+        if (EqualsIgnoreCase(name, COLUMNS[3])) {
+            return free_kb + snapshot.swap_free_kb;
+        }
+        return std::nullopt;
+    }
+
+    [[nodiscard]] static std::uint64_t ParseKilobytes(const std::string_view text) noexcept {
+        std::uint64_t value = 0;
+        for (const char ch : text) {
+            if (ch >= '0' && ch <= '9') {
+                value = value * 10 + static_cast<std::uint64_t>(ch - '0');
+            } else if (value != 0) {
+                break;
+            }
+        }
+        return value;
+    }
+
+    int fd_;
+};
+
+}  // namespace wmi
+
+#endif  // __linux__
@@ -0,0 +1,380 @@
+#pragma once
+
+#ifdef __linux__
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/statvfs.h>
+#include <unistd.h>
+
+#include <wmi/backend.hxx>
+#include <wmi/common.hxx>
+#include <wmi/wql.hxx>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace wmi {
+
+/**
+ * native linux provider for Win32_LogicalDisk
+ * every mount with real storage behind it is reported as one logical disk, keyed by mount point
+ * the mount table is cached and only re-parsed when poll() flags a change on mountinfo,
+ * so a steady-state query costs one poll plus one statvfs per mount
+ */
+class MountinfoBackend final : public Backend {
+   public:
+    /**
+     * win32 drive type codes as reported in the DriveType column
+     */
+    enum DriveType : std::uint32_t {
+        UNKNOWN = 0,
+        NO_ROOT_DIRECTORY = 1,
+        REMOVABLE_DISK = 2,
+        LOCAL_DISK = 3,
+        NETWORK_DRIVE = 4,
+        COMPACT_DISC = 5,
+        RAM_DISK = 6,
+    };
+
+    /**
+     * one cached mount table entry
+     */
+    struct Mount {
+        std::string mount_point;
+        std::wstring device_id;
+        std::wstring file_system;
+        std::uint32_t drive_type = UNKNOWN;
+    };
+
+    explicit MountinfoBackend(std::string path = "/proc/self/mountinfo")
+        : path_(std::move(path)), fd_(open(path_.c_str(), O_RDONLY | O_CLOEXEC)) {
+        if (fd_ < 0) {
+            throw Exception("Could not open '" + path_ + "': " + std::strerror(errno));
+        }
+    }
+
+    ~MountinfoBackend() noexcept override { close(fd_); }
+
+    MountinfoBackend(const MountinfoBackend&) = delete;
+    MountinfoBackend& operator=(const MountinfoBackend&) = delete;
+    MountinfoBackend(MountinfoBackend&&) = delete;
+    MountinfoBackend& operator=(MountinfoBackend&&) = delete;
+
+    void Connect(std::string_view /*path*/) override {}
+
+    [[nodiscard]] std::shared_ptr<Enumerator> ExecQuery(const std::wstring_view query) override {
+        const auto parsed = ParseWql(query);
+        if (!parsed || !EqualsIgnoreCase(parsed->class_name, L"Win32_LogicalDisk")) {
+            throw Exception("WQL query execution failed for query: '" + NarrowString(query) +
+                            "'. " + FormatHResultError("Unsupported query", status::InvalidQuery));
+        }
+
+        std::vector<Field> fields;
+        auto columns = std::make_shared<MemoryRow::Columns>();
+        if (parsed->properties.empty()) {
+            for (std::size_t i = 0; i < FIELD_COUNT; ++i) {
+                fields.push_back(static_cast<Field>(i));
+                columns->emplace_back(FIELD_NAMES[i]);
+            }
+        } else {
+            for (const auto& property : parsed->properties) {
+                const auto field = FindField(property);
+                if (!field) {
+                    throw Exception(
+                        "WQL query execution failed for query: '" + NarrowString(query) + "'. " +
+                        FormatHResultError("Property not served by mountinfo",
+                                           status::InvalidQuery));
+                }
+                fields.push_back(*field);
+                columns->emplace_back(FIELD_NAMES[static_cast<std::size_t>(*field)]);
+            }
+        }
+
+        const auto condition = ParseWqlWhere(query, *parsed, [](const std::wstring_view name) {
+            return FindField(name).has_value();
+        });
+        // fields the condition tests without selecting them are read too and dropped after it
+        auto needed = fields;
+        if (condition) {
+            for (const auto& property : condition->Properties()) {
+                const auto field = *FindField(property);
+                if (std::find(needed.begin(), needed.end(), field) == needed.end()) {
+                    needed.push_back(field);
+                }
+            }
+        }
+
+        const auto mounts = Mounts();
+        const bool needs_statvfs = std::any_of(needed.begin(), needed.end(), [](const Field f) {
+            return f == Field::SIZE || f == Field::FREE_SPACE;
+        });
+
+        std::vector<RowPtr> rows;
+        rows.reserve(mounts->size());
+        for (const auto& mount : *mounts) {
+            struct statvfs stats {};
+            const bool has_stats = needs_statvfs && statvfs(mount.mount_point.c_str(), &stats) == 0;
+
+            std::vector<Variant> values;
+            values.reserve(needed.size());
+            for (const auto field : needed) {
+                values.push_back(FieldValue(mount, field, has_stats ? &stats : nullptr));
+            }
+            if (condition && !condition->Matches([&](const std::wstring_view name) {
+                    const auto slot = std::find(needed.begin(), needed.end(), *FindField(name));
+                    return &values[static_cast<std::size_t>(slot - needed.begin())];
+                })) {
+                continue;
+            }
+            values.resize(fields.size());
+            rows.push_back(std::make_shared<MemoryRow>(columns, std::move(values)));
+        }
+
+        return std::make_shared<MemoryEnumerator>(std::move(rows));
+    }
+
+    /**
+     * current mount table, re-parsed only when the kernel reports a change
+     * \returns shared snapshot of the cached mounts
+     */
+    [[nodiscard]] std::shared_ptr<const std::vector<Mount>> Mounts() {
+        const std::lock_guard lock(mutex_);
+
+        pollfd descriptor{fd_, POLLPRI, 0};
+        const bool changed =
+            poll(&descriptor, 1, 0) > 0 && (descriptor.revents & (POLLERR | POLLPRI)) != 0;
+
+        if (!mounts_ || changed) {
+            mounts_ = Parse();
+            ++parse_count_;
+        }
+        return mounts_;
+    }
+
+    /**
+     * number of times mountinfo has been parsed, for verifying the cache
+     */
+    [[nodiscard]] std::size_t ParseCount() const {
+        const std::lock_guard lock(mutex_);
+        return parse_count_;
+    }
+
+    /**
+     * maps a linux filesystem type to a win32 drive type
+     * \param file_system - filesystem type from mountinfo
+     * \param source - mount source, block devices start with /dev/
+     * \returns drive type, nullopt for pseudo filesystems that are not disks
+     */
+    [[nodiscard]] static std::optional<std::uint32_t> ClassifyFileSystem(
+        const std::string_view file_system, const std::string_view source) {
+        constexpr std::string_view NETWORK[] = {"nfs",   "nfs4",      "cifs", "smb3",
+                                                "smbfs", "9p",        "ceph", "glusterfs",
+                                                "afs",   "fuse.sshfs", "lustre", "davfs"};
+        constexpr std::string_view OPTICAL[] = {"iso9660", "udf"};
+        constexpr std::string_view MEMORY[] = {"tmpfs", "ramfs"};
+        constexpr std::string_view LOCAL[] = {"ext2", "ext3", "ext4",  "xfs",   "btrfs",
+                                              "zfs",  "f2fs", "jfs",   "vfat",  "exfat",
+                                              "ntfs", "ntfs3", "bcachefs", "overlay"};
+
+        const auto contains = [&](const auto& list) {
+            return std::find(std::begin(list), std::end(list), file_system) != std::end(list);
+        };
+
+        if (contains(NETWORK)) {
+            return NETWORK_DRIVE;
+        }
+        if (contains(OPTICAL)) {
+            return COMPACT_DISC;
+        }
+        if (contains(MEMORY)) {
+            return RAM_DISK;
+        }
+        if (contains(LOCAL) || source.substr(0, 5) == "/dev/") {
+            return LOCAL_DISK;
+        }
+        return std::nullopt;
+    }
+
+   private:
+    enum class Field : std::size_t { DEVICE_ID, SIZE, FREE_SPACE, FILE_SYSTEM, DRIVE_TYPE };
+
+    static constexpr std::size_t FIELD_COUNT = 5;
+
+    static constexpr const wchar_t* FIELD_NAMES[] = {L"DeviceID", L"Size", L"FreeSpace",
+                                                     L"FileSystem", L"DriveType"};
+
+    [[nodiscard]] static std::optional<Field> FindField(const std::wstring_view name) {
+        for (std::size_t i = 0; i < FIELD_COUNT; ++i) {
+            if (EqualsIgnoreCase(name, FIELD_NAMES[i])) {
+                return static_cast<Field>(i);
+            }
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * value of one column for a mount
+     * \param stats - filesystem statistics of the mount, nullptr when unavailable
+     */
+    [[nodiscard]] static Variant FieldValue(const Mount& mount, const Field field,
+                                            const struct statvfs* stats) {
+        switch (field) {
+            case Field::DEVICE_ID:
+                return Variant(mount.device_id);
+            case Field::SIZE:
+                return stats ? Variant(static_cast<std::uint64_t>(stats->f_blocks) *
+                                       stats->f_frsize)
+                             : Variant();
+            case Field::FREE_SPACE:
+                return stats ? Variant(static_cast<std::uint64_t>(stats->f_bavail) *
+                                       stats->f_frsize)
+                             : Variant();
+            case Field::FILE_SYSTEM:
+                return Variant(mount.file_system);
+            default:
+                return Variant(mount.drive_type);
+        }
+    }
+
+    /**
+     * decodes the octal escapes (\040 and friends) mountinfo uses for whitespace
+     */
+    [[nodiscard]] static std::string Unescape(const std::string_view text) {
+        std::string result;
+        result.reserve(text.size());
+        for (std::size_t i = 0; i < text.size(); ++i) {
+            if (text[i] == '\\' && i + 3 < text.size() && text[i + 1] >= '0' &&
+                text[i + 1] <= '3' && text[i + 2] >= '0' && text[i + 2] <= '7' &&
+                text[i + 3] >= '0' && text[i + 3] <= '7') {
+                result.push_back(static_cast<char>(((text[i + 1] - '0') << 6) |
+                                                   ((text[i + 2] - '0') << 3) |
+                                                   (text[i + 3] - '0')));
+                i += 3;
+            } else {
+                result.push_back(text[i]);
+            }
+        }
+        return result;
+    }
+
+    /**
+     * checks whether the block device behind a mount is removable
+     * partitions carry the flag on their parent disk
+     */
+    [[nodiscard]] static bool IsRemovable(const std::string_view device_number) {
+        const std::string base = "/sys/dev/block/" + std::string(device_number);
+        for (const auto* suffix : {"/removable", "/../removable"}) {
+            const int fd = open((base + suffix).c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                continue;
+            }
+            char flag = '0';
+            const auto count = read(fd, &flag, 1);
+            close(fd);
+            return count == 1 && flag == '1';
+        }
+        return false;
+    }
+
+    [[nodiscard]] std::shared_ptr<const std::vector<Mount>> Parse() const {
+        std::string text;
+        char buffer[16384];
+        for (;;) {
+            const auto count =
+                pread(fd_, buffer, sizeof(buffer), static_cast<off_t>(text.size()));
+            if (count < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw Exception("Could not read '" + path_ + "': " + std::strerror(errno));
+            }
+            if (count == 0) {
+                break;
+            }
+            text.append(buffer, static_cast<std::size_t>(count));
+        }
+
+        auto mounts = std::make_shared<std::vector<Mount>>();
+        std::size_t position = 0;
+        while (position < text.size()) {
+            auto end = text.find('\n', position);
+            if (end == std::string::npos) {
+                end = text.size();
+            }
+            const std::string_view line(text.data() + position, end - position);
+            position = end + 1;
+
+            // id parent major:minor root mount-point options [optional...] - type source super
+            std::vector<std::string_view> fields;
+            std::size_t start = 0;
+            while (start < line.size()) {
+                auto space = line.find(' ', start);
+                if (space == std::string_view::npos) {
+                    space = line.size();
+                }
+                fields.push_back(line.substr(start, space - start));
+                start = space + 1;
+            }
+
+            const auto separator = std::find(fields.begin(), fields.end(), "-");
+            if (fields.size() < 6 || separator == fields.end() ||
+                std::distance(separator, fields.end()) < 3) {
+                continue;
+            }
+
+            const auto file_system = *(separator + 1);
+            const auto source = *(separator + 2);
+            auto mount_point = Unescape(fields[4]);
+
+            // later lines are mounted on top of earlier ones at the same point and hide them,
+            // DeviceID is the key of Win32_LogicalDisk so only the top-most mount is reported
+            const auto hidden =
+                std::find_if(mounts->begin(), mounts->end(), [&mount_point](const Mount& mount) {
+                    return mount.mount_point == mount_point;
+                });
+            if (hidden != mounts->end()) {
+                mounts->erase(hidden);
+            }
+
+            auto drive_type = ClassifyFileSystem(file_system, source);
+            if (!drive_type) {
+                continue;
+            }
+            if (*drive_type == LOCAL_DISK && source.substr(0, 5) == "/dev/" &&
+                IsRemovable(fields[2])) {
+                drive_type = REMOVABLE_DISK;
+            }
+
+            Mount mount;
+            mount.mount_point = std::move(mount_point);
+            mount.device_id = WidenString(mount.mount_point);
+            mount.file_system = WidenString(file_system);
+            mount.drive_type = *drive_type;
+            mounts->push_back(std::move(mount));
+        }
+
+        return mounts;
+    }
+
+    std::string path_;
+    int fd_;
+    mutable std::mutex mutex_;
+    std::shared_ptr<const std::vector<Mount>> mounts_;
+    std::size_t parse_count_ = 0;
+};
+
+}  // namespace wmi
+
+#endif  // __linux__
@@ -0,0 +1,333 @@
+#pragma once
+
+#ifdef __linux__
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <wmi/backend.hxx>
+#include <wmi/common.hxx>
+#include <wmi/wql.hxx>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace wmi {
+
+/**
+ * native linux provider for Win32_PhysicalMemory
+ * decodes the smbios type 17 (memory device) structures straight out of the raw table,
+ * by default /sys/firmware/dmi/tables/DMI, or a fixture file holding the same bytes
+ * the table is decoded once per path and shared for the life of the process
+ */
+class SmbiosBackend final : public Backend {
+   public:
+    /**
+     * reads the table the kernel exposes
+     * it is readable by root only and absent without smbios firmware, queries by other users
+     * or on such machines return no rows instead of failing
+     */
+    SmbiosBackend() : path_("/sys/firmware/dmi/tables/DMI"), optional_(true) {}
+
+    /**
+     * \param path - raw table to read, queries fail if it cannot be opened
+     */
+    explicit SmbiosBackend(std::string path) : path_(std::move(path)), optional_(false) {}
+
+    void Connect(std::string_view /*path*/) override {}
+
+    [[nodiscard]] std::shared_ptr<Enumerator> ExecQuery(const std::wstring_view query) override {
+        const auto parsed = ParseWql(query);
+        if (!parsed || !EqualsIgnoreCase(parsed->class_name, L"Win32_PhysicalMemory")) {
+            throw Exception("WQL query execution failed for query: '" + NarrowString(query) +
+                            "'. " + FormatHResultError("Unsupported query", status::InvalidQuery));
+        }
+
+        std::vector<std::size_t> fields;
+        auto columns = std::make_shared<MemoryRow::Columns>();
+        for (const auto& property : parsed->properties) {
+            const auto field = FindField(property);
+            if (field == FIELD_COUNT) {
+                throw Exception("WQL query execution failed for query: '" + NarrowString(query) +
+                                "'. " +
+                                FormatHResultError("Property not served by SMBIOS",
+                                                   status::InvalidQuery));
+            }
+            fields.push_back(field);
+            columns->emplace_back(FIELD_NAMES[field]);
+        }
+        const auto condition = ParseWqlWhere(query, *parsed, [](const std::wstring_view name) {
+            return FindField(name) != FIELD_COUNT;
+        });
+
+        const auto cached = Load(path_, optional_);
+        if (!cached) {
+            return std::make_shared<MemoryEnumerator>(std::vector<RowPtr>{});
+        }
+        std::vector<RowPtr> rows;
+        rows.reserve(cached->size());
+        for (const auto& row : *cached) {
+            // cached rows carry every column and are shared read-only between queries
+            if (condition && !condition->Matches([&row](const std::wstring_view name) {
+                    return row->Find(name);
+                })) {
+                continue;
+            }
+            if (fields.empty()) {
+                rows.push_back(row);
+                continue;
+            }
+
+            std::vector<Variant> values;
+            values.reserve(fields.size());
+            for (const auto field : fields) {
+                values.push_back(*row->Find(FIELD_NAMES[field]));
+            }
+            rows.push_back(std::make_shared<MemoryRow>(columns, std::move(values)));
+        }
+        return std::make_shared<MemoryEnumerator>(std::move(rows));
+    }
+
+    /**
+     * decodes memory device structures from a raw smbios structure table
+     * \param table - table bytes, exactly what the kernel exposes in tables/DMI
+     * \param size - table length in bytes
+     * \returns one row per populated memory slot
+     */
+    [[nodiscard]] static std::vector<RowPtr> Decode(const std::uint8_t* table,
+                                                    const std::size_t size) {
+        static const auto columns = std::make_shared<const MemoryRow::Columns>(
+            MemoryRow::Columns(std::begin(FIELD_NAMES), std::end(FIELD_NAMES)));
+
+        std::vector<RowPtr> rows;
+        std::size_t offset = 0;
+        while (offset + 4 <= size) {
+            const auto* header = table + offset;
+            const std::uint8_t type = header[0];
+            const std::uint8_t length = header[1];
+            if (length < 4 || offset + length > size) {
+                break;
+            }
+
+            // unformed strings follow the formatted area and end with a double null
+            std::size_t end = offset + length;
+            while (end + 1 < size && (table[end] != 0 || table[end + 1] != 0)) {
+                ++end;
+            }
+            const std::string_view strings(reinterpret_cast<const char*>(table + offset + length),
+                                           end - (offset + length));
+
+            if (type == END_OF_TABLE) {
+                break;
+            }
+            if (type == MEMORY_DEVICE) {
+                if (auto row = DecodeMemoryDevice(header, length, strings, columns)) {
+                    rows.push_back(std::move(row));
+                }
+            }
+
+            offset = end + 2;
+        }
+        return rows;
+    }
+
+   private:
+    static constexpr std::uint8_t MEMORY_DEVICE = 17;
+    static constexpr std::uint8_t END_OF_TABLE = 127;
+    static constexpr std::size_t FIELD_COUNT = 8;
+
+    static constexpr const wchar_t* FIELD_NAMES[FIELD_COUNT] = {
+        L"Capacity",     L"Speed",         L"Manufacturer", L"PartNumber",
+        L"SerialNumber", L"DeviceLocator", L"BankLabel",    L"ConfiguredClockSpeed"};
+
+    [[nodiscard]] static std::size_t FindField(const std::wstring_view name) {
+        for (std::size_t i = 0; i < FIELD_COUNT; ++i) {
+            if (EqualsIgnoreCase(name, FIELD_NAMES[i])) {
+                return i;
+            }
+        }
+        return FIELD_COUNT;
+    }
+
+    [[nodiscard]] static std::uint16_t Word(const std::uint8_t* data) noexcept {
+        return static_cast<std::uint16_t>(data[0] | (data[1] << 8));
+    }
+
+    [[nodiscard]] static std::uint32_t DWord(const std::uint8_t* data) noexcept {
+        return static_cast<std::uint32_t>(Word(data)) |
+               (static_cast<std::uint32_t>(Word(data + 2)) << 16);
+    }
+
+    /**
+     * widens the n-th (1-based) string of a structure directly from the table bytes
+     * trailing padding is dropped, firmware commonly space-fills these fields
+     */
+    [[nodiscard]] static Variant StringField(const std::string_view strings,
+                                             const std::uint8_t index) {
+        if (index == 0) {
+            return {};
+        }
+
+        std::size_t start = 0;
+        for (std::uint8_t i = 1; i < index; ++i) {
+            start = strings.find('\0', start);
+            if (start == std::string_view::npos) {
+                return {};
+            }
+            ++start;
+        }
+
+        auto text = strings.substr(start, strings.find('\0', start) - start);
+        while (!text.empty() && text.back() == ' ') {
+            text.remove_suffix(1);
+        }
+
+        // smbios strings are plain ascii, widen straight into the row's storage
+        return Variant(WideString::Build(text.size(), [text](wchar_t* out) {
+            for (const char ch : text) {
+                *out++ = static_cast<wchar_t>(static_cast<unsigned char>(ch));
+            }
+        }));
+    }
+
+    [[nodiscard]] static RowPtr DecodeMemoryDevice(
+        const std::uint8_t* data, const std::uint8_t length, const std::string_view strings,
+        const std::shared_ptr<const MemoryRow::Columns>& columns) {
+        // size (0x0c) is the smbios 2.1 minimum, anything shorter is malformed
+        if (length < 0x15) {
+            return nullptr;
+        }
+
+        const auto size = Word(data + 0x0C);
+        if (size == 0 || size == 0xFFFF) {
+            // empty slot or unknown size
+            return nullptr;
+        }
+
+        std::uint64_t capacity = 0;
+        if (size == 0x7FFF && length >= 0x20) {
+            capacity = static_cast<std::uint64_t>(DWord(data + 0x1C) & 0x7FFFFFFF) << 20;
+        } else if (size & 0x8000) {
+            capacity = static_cast<std::uint64_t>(size & 0x7FFF) << 10;
+        } else {
+            capacity = static_cast<std::uint64_t>(size) << 20;
+        }
+
+        const auto byte = [&](const std::size_t at) -> std::uint8_t {
+            return at < length ? data[at] : 0;
+        };
+
+        std::vector<Variant> values(FIELD_COUNT);
+        values[0] = Variant(capacity);
+        if (length >= 0x17) {
+            std::uint32_t speed = Word(data + 0x15);
+            if (speed == 0xFFFF && length >= 0x58) {
+                speed = DWord(data + 0x54);
+            }
+            if (speed != 0) {
+                values[1] = Variant(speed);
+            }
+        }
+        values[2] = StringField(strings, byte(0x17));
+        values[3] = StringField(strings, byte(0x1A));
+        values[4] = StringField(strings, byte(0x18));
+        values[5] = StringField(strings, byte(0x10));
+        values[6] = StringField(strings, byte(0x11));
+        if (length >= 0x22) {
+            std::uint32_t configured = Word(data + 0x20);
+            if (configured == 0xFFFF && length >= 0x5C) {
+                configured = DWord(data + 0x58);
+            }
+            if (configured != 0) {
+                values[7] = Variant(configured);
+            }
+        }
+
+        return std::make_shared<MemoryRow>(columns, std::move(values));
+    }
+
+    /**
+     * maps the table file and decodes it, once per path for the whole process
+     * sysfs does not implement mmap for the dmi table, which falls back to a single read
+     * \param path - table file
+     * \param optional - a missing or unreadable file is no error
+     * \returns decoded rows, nullptr if an optional file cannot be opened; the failure is not
+     *          cached so the rows appear once the file becomes readable
+     * \throws Exception if the file cannot be opened and is not optional, or cannot be read
+     */
+    [[nodiscard]] static std::shared_ptr<const std::vector<RowPtr>> Load(const std::string& path,
+                                                                         const bool optional) {
+        static std::mutex mutex;
+        static std::map<std::string, std::shared_ptr<const std::vector<RowPtr>>> cache;
+
+        const std::lock_guard lock(mutex);
+        if (const auto cached = cache.find(path); cached != cache.end()) {
+            return cached->second;
+        }
+
+        const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            if (optional && (errno == ENOENT || errno == EACCES || errno == EPERM)) {
+                return nullptr;
+            }
+            throw Exception("Could not open SMBIOS table '" + path + "': " +
+                            std::strerror(errno));
+        }
+
+        struct stat info {};
+        if (fstat(fd, &info) != 0) {
+            close(fd);
+            throw Exception("Could not stat SMBIOS table '" + path + "': " +
+                            std::strerror(errno));
+        }
+
+        std::vector<RowPtr> rows;
+        const auto size = static_cast<std::size_t>(info.st_size);
+        void* mapping = size > 0 ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+        if (mapping != MAP_FAILED) {
+            rows = Decode(static_cast<const std::uint8_t*>(mapping), size);
+            munmap(mapping, size);
+        } else {
+            std::vector<std::uint8_t> buffer(size > 0 ? size : 65536);
+            std::size_t length = 0;
+            for (;;) {
+                if (length == buffer.size()) {
+                    buffer.resize(buffer.size() * 2);
+                }
+                const auto count = read(fd, buffer.data() + length, buffer.size() - length);
+                if (count < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (count <= 0) {
+                    break;
+                }
+                length += static_cast<std::size_t>(count);
+            }
+            rows = Decode(buffer.data(), length);
+        }
+        close(fd);
+
+        auto shared = std::make_shared<const std::vector<RowPtr>>(std::move(rows));
+        cache.emplace(path, shared);
+        return shared;
+    }
+
+    std::string path_;
+    bool optional_;
+};
+
+}  // namespace wmi
+
+#endif  // __linux__
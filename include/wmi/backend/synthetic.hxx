@@ -0,0 +1,413 @@
+#pragma once
+
+#include <wmi/backend.hxx>
+#include <wmi/common.hxx>
+#include <wmi/variant.hxx>
+#include <wmi/wql.hxx>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace wmi {
+
+/**
+ * random delay of a single provider call
+ */
+struct LatencyModel {
+    enum class Distribution { Constant, Uniform, Exponential, LogNormal };
+
+    Distribution distribution = Distribution::Constant;
+    // constant value, mean of exponential and lognormal, lower bound of uniform
+    std::chrono::microseconds base{0};
+    // upper bound of uniform, cap of exponential and lognormal (0 = uncapped)
+    std::chrono::microseconds limit{0};
+    // shape of lognormal
+    double sigma = 0.5;
+
+    [[nodiscard]] static LatencyModel Constant(const std::chrono::microseconds value) {
+        return {Distribution::Constant, value, {}, 0.5};
+    }
+
+    [[nodiscard]] static LatencyModel Uniform(const std::chrono::microseconds low,
+                                              const std::chrono::microseconds high) {
+        return {Distribution::Uniform, low, high, 0.5};
+    }
+
+    [[nodiscard]] static LatencyModel Exponential(const std::chrono::microseconds mean,
+                                                  const std::chrono::microseconds cap = {}) {
+        return {Distribution::Exponential, mean, cap, 0.5};
+    }
+
+    [[nodiscard]] static LatencyModel LogNormal(const std::chrono::microseconds median,
+                                                const double sigma,
+                                                const std::chrono::microseconds cap = {}) {
+        return {Distribution::LogNormal, median, cap, sigma};
+    }
+
+    /**
+     * draws one delay
+     * \param engine - random source of the caller
+     * \returns delay in nanoseconds
+     */
+    [[nodiscard]] std::uint64_t Sample(std::mt19937_64& engine) const {
+        const double base_ns = static_cast<double>(base.count()) * 1000.0;
+        double value = base_ns;
+        switch (distribution) {
+            case Distribution::Constant:
+                break;
+            case Distribution::Uniform: {
+                const double high = std::max(base_ns, static_cast<double>(limit.count()) * 1000.0);
+                value = std::uniform_real_distribution<double>(base_ns, high)(engine);
+                break;
+            }
+            case Distribution::Exponential:
+                value = base_ns > 0 ? std::exponential_distribution<double>(1.0 / base_ns)(engine)
+                                    : 0.0;
+                break;
+            case Distribution::LogNormal:
+                value = base_ns > 0
+                            ? std::lognormal_distribution<double>(std::log(base_ns), sigma)(engine)
+                            : 0.0;
+                break;
+        }
+        if (distribution != Distribution::Uniform && limit.count() > 0) {
+            value = std::min(value, static_cast<double>(limit.count()) * 1000.0);
+        }
+        return static_cast<std::uint64_t>(std::max(value, 0.0));
+    }
+};
+
+/**
+ * behaviour of a SyntheticBackend
+ * every probability is evaluated once per Next call
+ */
+struct SyntheticOptions {
+    std::wstring class_name = L"Win32_Synthetic";
+    std::size_t row_count = 1000;
+    // length of the Payload string column, sizes the per-row copy cost
+    std::size_t payload_length = 32;
+
+    LatencyModel exec_latency;
+    // fixed cost of each Next call plus a cost per row handed out
+    LatencyModel call_latency;
+    LatencyModel row_latency;
+
+    // occasional long pause of the provider, e.g. a repository lock
+    double stall_probability = 0.0;
+    std::chrono::microseconds stall_duration{100000};
+
+    // Next returns fewer rows than asked for, with status::False like a real provider
+    double partial_probability = 0.0;
+
+    // Next returns status::TimedOut without rows, even when blocking
+    double timeout_probability = 0.0;
+
+    // Next fails with failure_code, either at random or once failure_after_rows were served
+    double failure_probability = 0.0;
+    std::size_t failure_after_rows = SIZE_MAX;
+    HResult failure_code = status::Failed;
+
+    // false accounts the latencies without sleeping, for pure bookkeeping runs
+    bool sleep = true;
+
+    std::uint64_t seed = 0x5EED;
+};
+
+/**
+ * provider serving generated rows with injected latency and faults
+ * lets benchmarks reproduce slow, jittery or failing wmi providers deterministically:
+ * the same options and seed yield the same sequence of delays, batch sizes and errors
+ */
+class SyntheticBackend final : public Backend {
+   public:
+    /**
+     * counters summed over every enumerator of the backend
+     */
+    struct Stats {
+        std::uint64_t calls = 0;
+        std::uint64_t rows = 0;
+        std::uint64_t partial_batches = 0;
+        std::uint64_t timeouts = 0;
+        std::uint64_t stalls = 0;
+        std::uint64_t failures = 0;
+        std::uint64_t simulated_ns = 0;
+    };
+
+    explicit SyntheticBackend(SyntheticOptions options = {})
+        : options_(std::make_shared<const SyntheticOptions>(std::move(options))) {}
+
+    void Connect(std::string_view /*path*/) override {}
+
+    [[nodiscard]] std::shared_ptr<Enumerator> ExecQuery(const std::wstring_view query) override {
+        const auto parsed = ParseWql(query);
+        if (!parsed) {
+            throw Exception("WQL query execution failed for query: '" + NarrowString(query) +
+                            "'. " + FormatHResultError("Unsupported query", status::InvalidQuery));
+        }
+        if (!EqualsIgnoreCase(parsed->class_name, options_->class_name)) {
+            throw Exception("WQL query execution failed for query: '" + NarrowString(query) +
+                            "'. " + FormatHResultError("Unknown class", status::InvalidClass));
+        }
+
+        std::vector<std::size_t> fields;
+        auto columns = std::make_shared<MemoryRow::Columns>();
+        if (parsed->properties.empty()) {
+            for (std::size_t i = 0; i < FIELD_COUNT; ++i) {
+                fields.push_back(i);
+                columns->emplace_back(FIELD_NAMES[i]);
+            }
+        } else {
+            for (const auto& property : parsed->properties) {
+                const auto field = FindField(property);
+                if (field == FIELD_COUNT) {
+                    throw Exception(
+                        "WQL query execution failed for query: '" + NarrowString(query) + "'. " +
+                        FormatHResultError("Unknown property", status::InvalidQuery));
+                }
+                fields.push_back(field);
+                columns->emplace_back(FIELD_NAMES[field]);
+            }
+        }
+
+        std::optional<WqlCondition> condition;
+        if (!parsed->where.empty()) {
+            condition = WqlCondition::Parse(parsed->where);
+            if (!condition) {
+                throw Exception(
+                    "WQL query execution failed for query: '" + NarrowString(query) + "'. " +
+                    FormatHResultError("Unsupported condition", status::InvalidQuery));
+            }
+            for (const auto& property : condition->Properties()) {
+                if (FindField(property) == FIELD_COUNT) {
+                    throw Exception(
+                        "WQL query execution failed for query: '" + NarrowString(query) + "'. " +
+                        FormatHResultError("Unknown property", status::InvalidQuery));
+                }
+            }
+        }
+
+        // every execution gets its own, but reproducible, random stream
+        const auto execution = executions_.fetch_add(1, std::memory_order_relaxed);
+        std::mt19937_64 engine(options_->seed + execution);
+        Delay(*counters_, *options_, options_->exec_latency.Sample(engine));
+
+        return std::make_shared<SyntheticEnumerator>(counters_, options_,
+                                                     std::move(columns), std::move(fields),
+                                                     std::move(condition),
+                                                     options_->seed + execution);
+    }
+
+    [[nodiscard]] Stats GetStats() const noexcept {
+        return {counters_->calls.load(), counters_->rows.load(),
+                counters_->partial_batches.load(), counters_->timeouts.load(),
+                counters_->stalls.load(), counters_->failures.load(),
+                counters_->simulated_ns.load()};
+    }
+
+    [[nodiscard]] const SyntheticOptions& GetOptions() const noexcept { return *options_; }
+
+   private:
+    static constexpr std::size_t FIELD_COUNT = 3;
+
+    static constexpr const wchar_t* FIELD_NAMES[FIELD_COUNT] = {L"Index", L"Name", L"Payload"};
+
+    struct Counters {
+        std::atomic<std::uint64_t> calls{0};
+        std::atomic<std::uint64_t> rows{0};
+        std::atomic<std::uint64_t> partial_batches{0};
+        std::atomic<std::uint64_t> timeouts{0};
+        std::atomic<std::uint64_t> stalls{0};
+        std::atomic<std::uint64_t> failures{0};
+        std::atomic<std::uint64_t> simulated_ns{0};
+    };
+
+    [[nodiscard]] static std::size_t FindField(const std::wstring_view name) {
+        for (std::size_t i = 0; i < FIELD_COUNT; ++i) {
+            if (EqualsIgnoreCase(name, FIELD_NAMES[i])) {
+                return i;
+            }
+        }
+        return FIELD_COUNT;
+    }
+
+    /**
+     * spends simulated provider time, sleeping unless the options only account for it
+     */
+    static void Delay(Counters& counters, const SyntheticOptions& options,
+                      const std::uint64_t ns) {
+        counters.simulated_ns.fetch_add(ns, std::memory_order_relaxed);
+        if (options.sleep && ns > 0) {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(ns));
+        }
+    }
+
+    class SyntheticEnumerator final : public Enumerator {
+       public:
+        SyntheticEnumerator(std::shared_ptr<Counters> counters,
+                            std::shared_ptr<const SyntheticOptions> options,
+                            std::shared_ptr<const MemoryRow::Columns> columns,
+                            std::vector<std::size_t> fields,
+                            std::optional<WqlCondition> condition, const std::uint64_t seed)
+            : counters_(std::move(counters)),
+              options_(std::move(options)),
+              columns_(std::move(columns)),
+              fields_(std::move(fields)),
+              condition_(std::move(condition)),
+              seed_(seed),
+              engine_(seed) {}
+
+        HResult Next(const long timeout_ms, const std::size_t count,
+                     std::vector<RowPtr>& rows) override {
+            counters_->calls.fetch_add(1, std::memory_order_relaxed);
+            const auto& options = *options_;
+
+            // draw every decision up front so the random stream does not depend on timing
+            std::uint64_t cost = options.call_latency.Sample(engine_);
+            const bool stall = Chance(options.stall_probability);
+            const bool partial = Chance(options.partial_probability);
+            const bool timeout = Chance(options.timeout_probability);
+            const bool failure = Chance(options.failure_probability);
+
+            if (debt_ns_ > 0) {
+                // the previous call timed out, this one continues where it left off
+                cost = debt_ns_;
+                debt_ns_ = 0;
+            } else if (stall) {
+                counters_->stalls.fetch_add(1, std::memory_order_relaxed);
+                cost += static_cast<std::uint64_t>(options.stall_duration.count()) * 1000;
+            }
+
+            if (failure || position_ >= options.failure_after_rows) {
+                Delay(*counters_, options, cost);
+                counters_->failures.fetch_add(1, std::memory_order_relaxed);
+                return options.failure_code;
+            }
+
+            const auto budget = timeout_ms < 0 ? UINT64_MAX
+                                               : static_cast<std::uint64_t>(timeout_ms) * 1000000;
+            if (timeout || cost > budget) {
+                // the provider keeps working, whatever did not fit is owed by the next call
+                if (cost > budget) {
+                    debt_ns_ = cost - budget;
+                }
+                Delay(*counters_, options, std::min(cost, budget));
+                counters_->timeouts.fetch_add(1, std::memory_order_relaxed);
+                return status::TimedOut;
+            }
+
+            std::size_t wanted = std::min(count, options.row_count - position_);
+            if (partial && wanted > 1) {
+                wanted = std::uniform_int_distribution<std::size_t>(1, wanted - 1)(engine_);
+                counters_->partial_batches.fetch_add(1, std::memory_order_relaxed);
+            }
+            wanted = std::min(wanted, options.failure_after_rows - position_);
+
+            std::size_t served = 0;
+            bool out_of_time = false;
+            const auto end = std::min(options.row_count, options.failure_after_rows);
+            while (served < wanted && position_ < end) {
+                // rows failing the condition are skipped at no cost, like an indexed lookup
+                if (condition_ && !Matches(position_)) {
+                    ++position_;
+                    continue;
+                }
+                const auto row_cost = options.row_latency.Sample(engine_);
+                if (cost + row_cost > budget) {
+                    debt_ns_ = cost + row_cost - budget;
+                    cost = budget;
+                    out_of_time = true;
+                    break;
+                }
+                cost += row_cost;
+                rows.push_back(MakeRow(position_++));
+                ++served;
+            }
+            Delay(*counters_, options, cost);
+            counters_->rows.fetch_add(served, std::memory_order_relaxed);
+
+            if (served == count) {
+                return status::Ok;
+            }
+            if (out_of_time) {
+                counters_->timeouts.fetch_add(1, std::memory_order_relaxed);
+                return status::TimedOut;
+            }
+            return status::False;
+        }
+
+        HResult Reset() override {
+            // a rewound pass replays the exact same sequence
+            position_ = 0;
+            debt_ns_ = 0;
+            engine_.seed(seed_);
+            return status::Ok;
+        }
+
+       private:
+        [[nodiscard]] bool Chance(const double probability) {
+            return probability > 0 &&
+                   std::uniform_real_distribution<double>(0.0, 1.0)(engine_) < probability;
+        }
+
+        [[nodiscard]] Variant FieldValue(const std::size_t field, const std::size_t index) const {
+            switch (field) {
+                case 0:
+                    return static_cast<std::uint64_t>(index);
+                case 1:
+                    return Variant(std::wstring_view(L"Synthetic " + std::to_wstring(index)));
+                default:
+                    return WideString::Build(options_->payload_length, [this, index](wchar_t* out) {
+                        for (std::size_t i = 0; i < options_->payload_length; ++i) {
+                            out[i] = static_cast<wchar_t>(L'a' + (index + i) % 26);
+                        }
+                    });
+            }
+        }
+
+        [[nodiscard]] bool Matches(const std::size_t index) const {
+            Variant values[FIELD_COUNT];
+            return condition_->Matches([&](const std::wstring_view name) -> const Variant* {
+                const auto field = FindField(name);
+                values[field] = FieldValue(field, index);
+                return &values[field];
+            });
+        }
+
+        [[nodiscard]] RowPtr MakeRow(const std::size_t index) const {
+            std::vector<Variant> values;
+            values.reserve(fields_.size());
+            for (const auto field : fields_) {
+                values.push_back(FieldValue(field, index));
+            }
+            return std::make_shared<MemoryRow>(columns_, std::move(values));
+        }
+
+        std::shared_ptr<Counters> counters_;
+        std::shared_ptr<const SyntheticOptions> options_;
+        std::shared_ptr<const MemoryRow::Columns> columns_;
+        std::vector<std::size_t> fields_;
+        std::optional<WqlCondition> condition_;
+        std::uint64_t seed_;
+        std::mt19937_64 engine_;
+        std::size_t position_ = 0;
+        std::uint64_t debt_ns_ = 0;
+    };
+
+    std::shared_ptr<const SyntheticOptions> options_;
+    std::shared_ptr<Counters> counters_ = std::make_shared<Counters>();
+    std::atomic<std::uint64_t> executions_{0};
+};
+
+}  // namespace wmi
@@ -0,0 +1,283 @@
+#pragma once
+
+#ifdef __linux__
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <wmi/backend.hxx>
+#include <wmi/common.hxx>
+#include <wmi/thread_pool.hxx>
+#include <wmi/wql.hxx>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace wmi {
+
+/**
+ * native linux provider for Win32_DiskDrive
+ * every /sys/block entry with a device link is reported as a physical disk
+ * attributes are read with openat relative to each device directory, and devices are
+ * scanned concurrently on a small worker pool because large hosts expose hundreds of them
+ */
+class SysBlockBackend final : public Backend {
+   public:
+    /**
+     * attributes collected for one block device
+     */
+    struct Disk {
+        std::string name;
+        std::string model;
+        std::uint64_t size = 0;
+        bool removable = false;
+        bool rotational = false;
+        std::string interface_type;
+    };
+
+    /**
+     * \param root - sysfs block directory, overridable for fixtures
+     * \param workers - scan threads besides the caller, 0 scans serially
+     */
+    explicit SysBlockBackend(std::string root = "/sys/block", const std::size_t workers = 3)
+        : root_(std::move(root)),
+          pool_(workers > 0 ? std::make_unique<ThreadPool>(workers) : nullptr) {}
+
+    void Connect(std::string_view /*path*/) override {}
+
+    [[nodiscard]] std::shared_ptr<Enumerator> ExecQuery(const std::wstring_view query) override {
+        const auto parsed = ParseWql(query);
+        if (!parsed || !EqualsIgnoreCase(parsed->class_name, L"Win32_DiskDrive")) {
+            throw Exception("WQL query execution failed for query: '" + NarrowString(query) +
+                            "'. " + FormatHResultError("Unsupported query", status::InvalidQuery));
+        }
+
+        std::vector<std::size_t> fields;
+        auto columns = std::make_shared<MemoryRow::Columns>();
+        if (parsed->properties.empty()) {
+            for (std::size_t i = 0; i < FIELD_COUNT; ++i) {
+                fields.push_back(i);
+                columns->emplace_back(FIELD_NAMES[i]);
+            }
+        } else {
+            for (const auto& property : parsed->properties) {
+                const auto field = FindField(property);
+                if (field == FIELD_COUNT) {
+                    throw Exception(
+                        "WQL query execution failed for query: '" + NarrowString(query) + "'. " +
+                        FormatHResultError("Property not served by /sys/block",
+                                           status::InvalidQuery));
+                }
+                fields.push_back(field);
+                columns->emplace_back(FIELD_NAMES[field]);
+            }
+        }
+
+        const auto condition = ParseWqlWhere(query, *parsed, [](const std::wstring_view name) {
+            return FindField(name) != FIELD_COUNT;
+        });
+        // fields the condition tests without selecting them are read too and dropped after it
+        auto needed = fields;
+        if (condition) {
+            for (const auto& property : condition->Properties()) {
+                const auto field = FindField(property);
+                if (std::find(needed.begin(), needed.end(), field) == needed.end()) {
+                    needed.push_back(field);
+                }
+            }
+        }
+
+        const auto disks = Scan();
+
+        std::vector<RowPtr> rows;
+        rows.reserve(disks.size());
+        for (const auto& disk : disks) {
+            std::vector<Variant> values;
+            values.reserve(needed.size());
+            for (const auto field : needed) {
+                values.push_back(FieldValue(disk, field));
+            }
+            if (condition && !condition->Matches([&](const std::wstring_view name) {
+                    const auto slot = std::find(needed.begin(), needed.end(), FindField(name));
+                    return &values[static_cast<std::size_t>(slot - needed.begin())];
+                })) {
+                continue;
+            }
+            values.resize(fields.size());
+            rows.push_back(std::make_shared<MemoryRow>(columns, std::move(values)));
+        }
+
+        return std::make_shared<MemoryEnumerator>(std::move(rows));
+    }
+
+    /**
+     * walks the block directory and reads every device's attributes
+     * \returns disks in directory order
+     * \throws Exception if the block directory cannot be opened
+     */
+    [[nodiscard]] std::vector<Disk> Scan() const {
+        const int root_fd = open(root_.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (root_fd < 0) {
+            throw Exception("Could not open '" + root_ + "': " + std::strerror(errno));
+        }
+
+        std::vector<Disk> disks;
+        // fdopendir takes ownership, keep root_fd for the openat calls
+        const int listing_fd = dup(root_fd);
+        DIR* directory = listing_fd >= 0 ? fdopendir(listing_fd) : nullptr;
+        if (!directory && listing_fd >= 0) {
+            close(listing_fd);
+        }
+        if (directory) {
+            while (const dirent* entry = readdir(directory)) {
+                if (entry->d_name[0] == '.') {
+                    continue;
+                }
+                // partitions-only and virtual devices (dm, loop, ram) have no device link
+                const std::string device_link = std::string(entry->d_name) + "/device";
+                if (faccessat(root_fd, device_link.c_str(), F_OK, 0) != 0) {
+                    continue;
+                }
+                disks.push_back(Disk{entry->d_name, {}, 0, false, false, {}});
+            }
+            closedir(directory);
+        }
+
+        const auto read_disk = [root_fd, &disks](const std::size_t i) {
+            ReadDisk(root_fd, disks[i]);
+        };
+        if (pool_ && disks.size() > 1) {
+            pool_->ParallelFor(disks.size(), read_disk);
+        } else {
+            for (std::size_t i = 0; i < disks.size(); ++i) {
+                read_disk(i);
+            }
+        }
+
+        close(root_fd);
+        return disks;
+    }
+
+   private:
+    static constexpr std::size_t FIELD_COUNT = 6;
+
+    static constexpr const wchar_t* FIELD_NAMES[FIELD_COUNT] = {
+        L"DeviceID", L"Model", L"Size", L"MediaType", L"InterfaceType", L"Rotational"};
+
+    [[nodiscard]] static std::size_t FindField(const std::wstring_view name) {
+        for (std::size_t i = 0; i < FIELD_COUNT; ++i) {
+            if (EqualsIgnoreCase(name, FIELD_NAMES[i])) {
+                return i;
+            }
+        }
+        return FIELD_COUNT;
+    }
+
+    [[nodiscard]] static Variant FieldValue(const Disk& disk, const std::size_t field) {
+        switch (field) {
+            case 0:
+                return Variant(WidenString("/dev/" + disk.name));
+            case 1:
+                return disk.model.empty() ? Variant() : Variant(WidenString(disk.model));
+            case 2:
+                return Variant(disk.size);
+            case 3:
+                return Variant(disk.removable ? L"Removable Media" : L"Fixed hard disk media");
+            case 4:
+                return Variant(WidenString(disk.interface_type));
+            default:
+                // linux extension, win32 has no equivalent column
+                return Variant(disk.rotational);
+        }
+    }
+
+    /**
+     * reads a small sysfs attribute relative to a directory descriptor
+     * \returns attribute contents with trailing whitespace removed, nullopt if unreadable
+     */
+    [[nodiscard]] static std::optional<std::string> ReadAttribute(const int directory_fd,
+                                                                  const char* path) {
+        const int fd = openat(directory_fd, path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return std::nullopt;
+        }
+
+        char buffer[256];
+        const auto count = read(fd, buffer, sizeof(buffer));
+        close(fd);
+        if (count < 0) {
+            return std::nullopt;
+        }
+
+        std::string_view text(buffer, static_cast<std::size_t>(count));
+        while (!text.empty() && (text.back() == '\n' || text.back() == ' ')) {
+            text.remove_suffix(1);
+        }
+        return std::string(text);
+    }
+
+    /**
+     * maps the device's position in the sysfs hierarchy to a win32 interface type
+     * windows reports nvme and virtio disks as scsi and sata disks as ide
+     */
+    [[nodiscard]] static std::string ClassifyInterface(const int root_fd, const std::string& name) {
+        char target[1024];
+        const auto length = readlinkat(root_fd, name.c_str(), target, sizeof(target) - 1);
+        const std::string_view path(target, length > 0 ? static_cast<std::size_t>(length) : 0);
+
+        if (path.find("/usb") != std::string_view::npos) {
+            return "USB";
+        }
+        if (path.find("/ieee1394") != std::string_view::npos ||
+            path.find("/firewire") != std::string_view::npos) {
+            return "1394";
+        }
+        if (path.find("/ata") != std::string_view::npos) {
+            return "IDE";
+        }
+        return "SCSI";
+    }
+
+    static void ReadDisk(const int root_fd, Disk& disk) {
+        const int fd = openat(root_fd, disk.name.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+
+        if (auto sectors = ReadAttribute(fd, "size")) {
+            // sysfs always counts 512-byte sectors regardless of the logical block size
+            disk.size = std::strtoull(sectors->c_str(), nullptr, 10) * 512;
+        }
+        if (auto removable = ReadAttribute(fd, "removable")) {
+            disk.removable = *removable == "1";
+        }
+        if (auto rotational = ReadAttribute(fd, "queue/rotational")) {
+            disk.rotational = *rotational == "1";
+        }
+        if (auto model = ReadAttribute(fd, "device/model")) {
+            disk.model = std::move(*model);
+        }
+        disk.interface_type = ClassifyInterface(root_fd, disk.name);
+
+        close(fd);
+    }
+
+    std::string root_;
+    std::unique_ptr<ThreadPool> pool_;
+};
+
+}  // namespace wmi
+
+#endif  // __linux__
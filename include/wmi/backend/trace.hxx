@@ -0,0 +1,625 @@
+#pragma once
+
+#include <wmi/backend.hxx>
+#include <wmi/common.hxx>
+#include <wmi/variant.hxx>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace wmi {
+
+/**
+ * one call to Enumerator::Next as seen by the recorder
+ */
+struct TraceBatch {
+    std::uint64_t latency_ns = 0;
+    HResult result = status::Ok;
+    // each row is a list of (column index, value) pairs
+    std::vector<std::vector<std::pair<std::uint32_t, Variant>>> rows;
+};
+
+/**
+ * one executed query with everything needed to serve it again
+ */
+struct TraceRecord {
+    std::wstring query;
+    std::uint64_t exec_latency_ns = 0;
+    std::vector<std::wstring> columns;
+    std::vector<TraceBatch> batches;
+};
+
+namespace detail {
+
+inline constexpr char TRACE_MAGIC[8] = {'W', 'M', 'I', 'T', 'R', 'A', 'C', 'E'};
+inline constexpr std::uint64_t TRACE_VERSION = 1;
+
+enum TraceTag : std::uint8_t {
+    TRACE_EMPTY = 0,
+    TRACE_FALSE = 1,
+    TRACE_TRUE = 2,
+    TRACE_SIGNED = 3,
+    TRACE_UNSIGNED = 4,
+    TRACE_REAL = 5,
+    TRACE_STRING = 6,
+    TRACE_STRING_ARRAY = 7,
+};
+
+/**
+ * serializes trace records: little-endian varints, strings as utf-16 code units
+ * so traces captured on windows replay unchanged on platforms with 32-bit wchar_t
+ */
+class TraceWriter {
+   public:
+    void Varint(std::uint64_t value) {
+        while (value >= 0x80) {
+            buffer_.push_back(static_cast<char>(value | 0x80));
+            value >>= 7;
+        }
+        buffer_.push_back(static_cast<char>(value));
+    }
+
+    void Signed(const std::int64_t value) {
+        Varint((static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+    }
+
+    void String(const std::wstring_view text) {
+        std::u16string units;
+        units.reserve(text.size());
+        for (const wchar_t ch : text) {
+            const auto cp = static_cast<std::uint32_t>(ch);
+            if (cp > 0xFFFF) {
+                units.push_back(static_cast<char16_t>(0xD800 + ((cp - 0x10000) >> 10)));
+                units.push_back(static_cast<char16_t>(0xDC00 + ((cp - 0x10000) & 0x3FF)));
+            } else {
+                units.push_back(static_cast<char16_t>(cp));
+            }
+        }
+        Varint(units.size());
+        for (const char16_t unit : units) {
+            buffer_.push_back(static_cast<char>(unit & 0xFF));
+            buffer_.push_back(static_cast<char>(unit >> 8));
+        }
+    }
+
+    void Value(const Variant& value) {
+        if (const auto* boolean = value.GetIf<bool>()) {
+            buffer_.push_back(static_cast<char>(*boolean ? TRACE_TRUE : TRACE_FALSE));
+        } else if (const auto* number = value.GetIf<std::int64_t>()) {
+            buffer_.push_back(static_cast<char>(TRACE_SIGNED));
+            Signed(*number);
+        } else if (const auto* number = value.GetIf<std::uint64_t>()) {
+            buffer_.push_back(static_cast<char>(TRACE_UNSIGNED));
+            Varint(*number);
+        } else if (const auto* real = value.GetIf<double>()) {
+            buffer_.push_back(static_cast<char>(TRACE_REAL));
+            std::uint64_t bits = 0;
+            std::memcpy(&bits, real, sizeof(bits));
+            for (int i = 0; i < 8; ++i) {
+                buffer_.push_back(static_cast<char>(bits >> (i * 8)));
+            }
+        } else if (const auto* text = value.GetIf<WideString>()) {
+            buffer_.push_back(static_cast<char>(TRACE_STRING));
+            String(text->View());
+        } else if (const auto* texts = value.GetIf<std::vector<WideString>>()) {
+            buffer_.push_back(static_cast<char>(TRACE_STRING_ARRAY));
+            Varint(texts->size());
+            for (const auto& item : *texts) {
+                String(item.View());
+            }
+        } else {
+            buffer_.push_back(static_cast<char>(TRACE_EMPTY));
+        }
+    }
+
+    [[nodiscard]] const std::string& Buffer() const noexcept { return buffer_; }
+
+   private:
+    std::string buffer_;
+};
+
+/**
+ * reads what TraceWriter produced, throwing on truncated or corrupt input
+ */
+class TraceReader {
+   public:
+    explicit TraceReader(std::string data) : data_(std::move(data)) {}
+
+    [[nodiscard]] bool AtEnd() const noexcept { return position_ == data_.size(); }
+
+    [[nodiscard]] std::uint8_t Byte() {
+        if (position_ >= data_.size()) {
+            throw Exception("Truncated WMI trace");
+        }
+        return static_cast<std::uint8_t>(data_[position_++]);
+    }
+
+    [[nodiscard]] std::uint64_t Varint() {
+        std::uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            const auto byte = Byte();
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+        throw Exception("Corrupt varint in WMI trace");
+    }
+
+    [[nodiscard]] std::int64_t Signed() {
+        const auto value = Varint();
+        return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+    }
+
+    [[nodiscard]] std::size_t Count() {
+        const auto count = Varint();
+        if (count > data_.size() - position_) {
+            throw Exception("Corrupt count in WMI trace");
+        }
+        return static_cast<std::size_t>(count);
+    }
+
+    [[nodiscard]] std::wstring String() {
+        const auto units = Count();
+        std::wstring text;
+        text.reserve(units);
+        for (std::size_t i = 0; i < units; ++i) {
+            std::uint32_t unit = Byte();
+            unit |= static_cast<std::uint32_t>(Byte()) << 8;
+            if constexpr (sizeof(wchar_t) == 4) {
+                // rejoin surrogate pairs on platforms with 32-bit wchar_t
+                if (unit >= 0xDC00 && unit < 0xE000 && !text.empty()) {
+                    const auto high = static_cast<std::uint32_t>(text.back());
+                    if (high >= 0xD800 && high < 0xDC00) {
+                        text.back() = static_cast<wchar_t>(0x10000 + ((high - 0xD800) << 10) +
+                                                           (unit - 0xDC00));
+                        continue;
+                    }
+                }
+            }
+            text.push_back(static_cast<wchar_t>(unit));
+        }
+        return text;
+    }
+
+    [[nodiscard]] Variant Value() {
+        switch (Byte()) {
+            case TRACE_EMPTY:
+                return {};
+            case TRACE_FALSE:
+                return Variant(false);
+            case TRACE_TRUE:
+                return Variant(true);
+            case TRACE_SIGNED:
+                return Variant(Signed());
+            case TRACE_UNSIGNED:
+                return Variant(Varint());
+            case TRACE_REAL: {
+                std::uint64_t bits = 0;
+                for (int i = 0; i < 8; ++i) {
+                    bits |= static_cast<std::uint64_t>(Byte()) << (i * 8);
+                }
+                double real = 0;
+                std::memcpy(&real, &bits, sizeof(real));
+                return Variant(real);
+            }
+            case TRACE_STRING:
+                return Variant(String());
+            case TRACE_STRING_ARRAY: {
+                std::vector<WideString> texts(Count());
+                for (auto& text : texts) {
+                    text = WideString(String());
+                }
+                return Variant(std::move(texts));
+            }
+            default:
+                throw Exception("Unknown value tag in WMI trace");
+        }
+    }
+
+   private:
+    std::string data_;
+    std::size_t position_ = 0;
+};
+
+}  // namespace detail
+
+/**
+ * writes records to a compact binary trace file
+ * \param path - destination file, overwritten
+ * \param records - captured queries
+ * \throws Exception if the file cannot be written
+ */
+inline void WriteTrace(const std::string& path, const std::vector<TraceRecord>& records) {
+    detail::TraceWriter writer;
+    writer.Varint(detail::TRACE_VERSION);
+    writer.Varint(records.size());
+    for (const auto& record : records) {
+        writer.String(record.query);
+        writer.Varint(record.exec_latency_ns);
+        writer.Varint(record.columns.size());
+        for (const auto& column : record.columns) {
+            writer.String(column);
+        }
+        writer.Varint(record.batches.size());
+        for (const auto& batch : record.batches) {
+            writer.Varint(batch.latency_ns);
+            writer.Signed(batch.result);
+            writer.Varint(batch.rows.size());
+            for (const auto& row : batch.rows) {
+                writer.Varint(row.size());
+                for (const auto& [column, value] : row) {
+                    writer.Varint(column);
+                    writer.Value(value);
+                }
+            }
+        }
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(detail::TRACE_MAGIC, sizeof(detail::TRACE_MAGIC));
+    file.write(writer.Buffer().data(), static_cast<std::streamsize>(writer.Buffer().size()));
+    if (!file) {
+        throw Exception("Could not write WMI trace '" + path + "'");
+    }
+}
+
+/**
+ * loads a trace written by WriteTrace
+ * \param path - trace file
+ * \returns captured queries in capture order
+ * \throws Exception if the file is missing or malformed
+ */
+[[nodiscard]] inline std::vector<TraceRecord> ReadTrace(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw Exception("Could not open WMI trace '" + path + "'");
+    }
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (data.size() < sizeof(detail::TRACE_MAGIC) ||
+        std::memcmp(data.data(), detail::TRACE_MAGIC, sizeof(detail::TRACE_MAGIC)) != 0) {
+        throw Exception("'" + path + "' is not a WMI trace");
+    }
+
+    detail::TraceReader reader(data.substr(sizeof(detail::TRACE_MAGIC)));
+    if (reader.Varint() != detail::TRACE_VERSION) {
+        throw Exception("Unsupported WMI trace version in '" + path + "'");
+    }
+
+    std::vector<TraceRecord> records(reader.Count());
+    for (auto& record : records) {
+        record.query = reader.String();
+        record.exec_latency_ns = reader.Varint();
+        record.columns.resize(reader.Count());
+        for (auto& column : record.columns) {
+            column = reader.String();
+        }
+        record.batches.resize(reader.Count());
+        for (auto& batch : record.batches) {
+            batch.latency_ns = reader.Varint();
+            batch.result = static_cast<HResult>(reader.Signed());
+            batch.rows.resize(reader.Count());
+            for (auto& row : batch.rows) {
+                row.resize(reader.Count());
+                for (auto& [column, value] : row) {
+                    column = static_cast<std::uint32_t>(reader.Varint());
+                    if (column >= record.columns.size()) {
+                        throw Exception("Corrupt column index in WMI trace '" + path + "'");
+                    }
+                    value = reader.Value();
+                }
+            }
+        }
+    }
+    return records;
+}
+
+/**
+ * backend decorator capturing every query, row, property type and per-Next latency
+ * wrap the com backend on a real host, run the workload, then Save the trace
+ */
+class RecordingBackend final : public Backend {
+   public:
+    explicit RecordingBackend(std::shared_ptr<Backend> inner) : inner_(std::move(inner)) {
+        if (!inner_) {
+            throw Exception("RecordingBackend needs a backend to record");
+        }
+    }
+
+    void Connect(const std::string_view path) override { inner_->Connect(path); }
+
+    [[nodiscard]] std::optional<ClassSchema> GetClassSchema(
+        const std::wstring_view class_name) override {
+        return inner_->GetClassSchema(class_name);
+    }
+
+    [[nodiscard]] std::shared_ptr<Enumerator> ExecQuery(const std::wstring_view query) override {
+        const auto start = std::chrono::steady_clock::now();
+        auto enumerator = inner_->ExecQuery(query);
+
+        auto record = std::make_shared<TraceRecord>();
+        record->query = query;
+        record->exec_latency_ns = ElapsedNs(start);
+        {
+            const std::lock_guard lock(state_->mutex);
+            state_->records.push_back(record);
+        }
+
+        return std::make_shared<RecordingEnumerator>(std::move(enumerator), std::move(record),
+                                                     state_);
+    }
+
+    /**
+     * snapshot of everything captured so far
+     */
+    [[nodiscard]] std::vector<TraceRecord> Records() const {
+        const std::lock_guard lock(state_->mutex);
+        std::vector<TraceRecord> records;
+        records.reserve(state_->records.size());
+        for (const auto& record : state_->records) {
+            records.push_back(*record);
+        }
+        return records;
+    }
+
+    /**
+     * writes the captured queries to a trace file
+     * \param path - destination file
+     */
+    void Save(const std::string& path) const { WriteTrace(path, Records()); }
+
+   private:
+    struct State {
+        std::mutex mutex;
+        std::vector<std::shared_ptr<TraceRecord>> records;
+    };
+
+    [[nodiscard]] static std::uint64_t ElapsedNs(
+        const std::chrono::steady_clock::time_point start) {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                              std::chrono::steady_clock::now() - start)
+                                              .count());
+    }
+
+    class RecordingEnumerator final : public Enumerator {
+       public:
+        RecordingEnumerator(std::shared_ptr<Enumerator> inner,
+                            std::shared_ptr<TraceRecord> record, std::shared_ptr<State> state)
+            : inner_(std::move(inner)), record_(std::move(record)), state_(std::move(state)) {}
+
+        HResult Next(const long timeout_ms, const std::size_t count,
+                     std::vector<RowPtr>& rows) override {
+            const auto first = rows.size();
+            const auto start = std::chrono::steady_clock::now();
+            const auto result = inner_->Next(timeout_ms, count, rows);
+            if (!recording_) {
+                return result;
+            }
+
+            TraceBatch batch;
+            batch.latency_ns = ElapsedNs(start);
+            batch.result = result;
+            batch.rows.reserve(rows.size() - first);
+            for (auto i = first; i < rows.size(); ++i) {
+                auto& captured = batch.rows.emplace_back();
+                rows[i]->Enumerate([&](const std::wstring_view name, const Variant& value) {
+                    captured.emplace_back(ColumnIndex(name), value);
+                });
+            }
+
+            const std::lock_guard lock(state_->mutex);
+            record_->batches.push_back(std::move(batch));
+            return result;
+        }
+
+        HResult Reset() override {
+            // a second pass would duplicate rows, keep only the first one
+            if (!record_->batches.empty()) {
+                recording_ = false;
+            }
+            return inner_->Reset();
+        }
+
+       private:
+        [[nodiscard]] std::uint32_t ColumnIndex(const std::wstring_view name) {
+            for (std::size_t i = 0; i < columns_.size(); ++i) {
+                if (columns_[i] == name) {
+                    return static_cast<std::uint32_t>(i);
+                }
+            }
+            columns_.emplace_back(name);
+            const std::lock_guard lock(state_->mutex);
+            record_->columns = columns_;
+            return static_cast<std::uint32_t>(columns_.size() - 1);
+        }
+
+        std::shared_ptr<Enumerator> inner_;
+        std::shared_ptr<TraceRecord> record_;
+        std::shared_ptr<State> state_;
+        std::vector<std::wstring> columns_;
+        bool recording_ = true;
+    };
+
+    std::shared_ptr<Backend> inner_;
+    std::shared_ptr<State> state_ = std::make_shared<State>();
+};
+
+/**
+ * backend serving queries from a recorded trace
+ * runs at full speed, or reproduces the captured latencies when asked to
+ */
+class ReplayBackend final : public Backend {
+   public:
+    enum class Timing { Fast, Recorded };
+
+    explicit ReplayBackend(const std::vector<TraceRecord>& records,
+                           const Timing timing = Timing::Fast)
+        : timing_(timing) {
+        for (const auto& record : records) {
+            queries_.push_back(Prepare(record));
+        }
+    }
+
+    explicit ReplayBackend(const std::string& path, const Timing timing = Timing::Fast)
+        : ReplayBackend(ReadTrace(path), timing) {}
+
+    void Connect(std::string_view /*path*/) override {}
+
+    /**
+     * serves the next recorded execution of the query, cycling when a query ran several times
+     */
+    [[nodiscard]] std::shared_ptr<Enumerator> ExecQuery(const std::wstring_view query) override {
+        std::shared_ptr<const Query> match;
+        {
+            const std::lock_guard lock(mutex_);
+            std::vector<std::size_t> candidates;
+            for (std::size_t i = 0; i < queries_.size(); ++i) {
+                if (queries_[i]->text == query) {
+                    candidates.push_back(i);
+                }
+            }
+            if (candidates.empty()) {
+                for (std::size_t i = 0; i < queries_.size(); ++i) {
+                    if (EqualsIgnoreCase(queries_[i]->text, query)) {
+                        candidates.push_back(i);
+                    }
+                }
+            }
+            if (!candidates.empty()) {
+                auto& served = served_[std::wstring(query)];
+                match = queries_[candidates[served++ % candidates.size()]];
+            }
+        }
+
+        if (!match) {
+            throw Exception("WQL query execution failed for query: '" + NarrowString(query) +
+                            "'. " +
+                            FormatHResultError("Query is not in the trace", status::InvalidQuery));
+        }
+
+        if (timing_ == Timing::Recorded) {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(match->exec_latency_ns));
+        }
+        return std::make_shared<ReplayEnumerator>(std::move(match), timing_);
+    }
+
+   private:
+    struct Query {
+        std::wstring text;
+        std::uint64_t exec_latency_ns = 0;
+        std::vector<RowPtr> rows;
+        // time the provider spent producing each row, spread evenly over its batch
+        std::vector<std::uint64_t> row_cost_ns;
+        // time of the trailing calls that returned no rows
+        std::uint64_t tail_cost_ns = 0;
+        HResult final_result = status::False;
+    };
+
+    [[nodiscard]] static std::shared_ptr<const Query> Prepare(const TraceRecord& record) {
+        auto query = std::make_shared<Query>();
+        query->text = record.query;
+        query->exec_latency_ns = record.exec_latency_ns;
+
+        const auto columns = std::make_shared<const MemoryRow::Columns>(record.columns);
+        for (const auto& batch : record.batches) {
+            if (batch.rows.empty()) {
+                query->tail_cost_ns += batch.latency_ns;
+            } else {
+                const auto cost = batch.latency_ns / batch.rows.size();
+                for (const auto& row : batch.rows) {
+                    std::vector<Variant> values(columns->size());
+                    for (const auto& [column, value] : row) {
+                        values[column] = value;
+                    }
+                    query->rows.push_back(std::make_shared<MemoryRow>(columns, std::move(values)));
+                    query->row_cost_ns.push_back(cost);
+                }
+            }
+            if (batch.result != status::Ok && batch.result != status::TimedOut) {
+                query->final_result = batch.result;
+            }
+        }
+        return query;
+    }
+
+    class ReplayEnumerator final : public Enumerator {
+       public:
+        ReplayEnumerator(std::shared_ptr<const Query> query, const Timing timing)
+            : query_(std::move(query)), timing_(timing) {}
+
+        HResult Next(const long timeout_ms, const std::size_t count,
+                     std::vector<RowPtr>& rows) override {
+            const auto& all = query_->rows;
+            std::size_t taken = 0;
+
+            if (timing_ == Timing::Recorded) {
+                const auto budget = timeout_ms < 0
+                                        ? UINT64_MAX
+                                        : static_cast<std::uint64_t>(timeout_ms) * 1000000;
+                std::uint64_t spent = 0;
+                while (taken < count && position_ < all.size()) {
+                    const auto cost = query_->row_cost_ns[position_] - progress_ns_;
+                    if (spent + cost > budget) {
+                        // the provider is still working on this row when the timeout hits
+                        progress_ns_ += budget - spent;
+                        spent = budget;
+                        break;
+                    }
+                    spent += cost;
+                    progress_ns_ = 0;
+                    rows.push_back(all[position_++]);
+                    ++taken;
+                }
+                if (position_ == all.size() && taken < count) {
+                    spent += query_->tail_cost_ns;
+                }
+                std::this_thread::sleep_for(std::chrono::nanoseconds(std::min(spent, budget)));
+                if (taken < count && position_ < all.size()) {
+                    return status::TimedOut;
+                }
+            } else {
+                while (taken < count && position_ < all.size()) {
+                    rows.push_back(all[position_++]);
+                    ++taken;
+                }
+            }
+
+            if (taken == count) {
+                return status::Ok;
+            }
+            return query_->final_result;
+        }
+
+        HResult Reset() override {
+            position_ = 0;
+            progress_ns_ = 0;
+            return status::Ok;
+        }
+
+       private:
+        std::shared_ptr<const Query> query_;
+        Timing timing_;
+        std::size_t position_ = 0;
+        std::uint64_t progress_ns_ = 0;
+    };
+
+    Timing timing_;
+    std::vector<std::shared_ptr<const Query>> queries_;
+    std::mutex mutex_;
+    std::map<std::wstring, std::size_t> served_;
+};
+
+}  // namespace wmi
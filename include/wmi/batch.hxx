@@ -0,0 +1,154 @@
+#pragma once
+
+#include <wmi/thread_pool.hxx>
+#include <wmi/wmi.hxx>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace wmi {
+
+/**
+ * fully collected result of one query of a batch
+ */
+struct BatchResult {
+    std::wstring query;
+    std::vector<Object> objects;
+    QueryStatus status;
+    // time from the start of execution on the worker until the last object arrived
+    std::chrono::nanoseconds elapsed{0};
+};
+
+/**
+ * runs independent queries concurrently on a bounded pool of workers
+ * each worker joins the multithreaded com apartment once and keeps it for its lifetime,
+ * every query is collected completely on its worker before the result is handed out
+ */
+class Batch {
+   public:
+    using Callback = std::function<void(BatchResult&&, std::exception_ptr)>;
+
+    static constexpr std::size_t DEFAULT_WORKERS = 4;
+
+    /**
+     * \param iface - interface the queries run against
+     * \param workers - maximum number of queries in flight
+     */
+    explicit Batch(std::shared_ptr<const Interface> iface,
+                   const std::size_t workers = DEFAULT_WORKERS)
+        : iface_(std::move(iface)), pool_(std::max<std::size_t>(workers, 1)) {
+        if (!iface_) {
+            throw Exception("Cannot create a WMI batch without an interface");
+        }
+    }
+
+    /**
+     * waits for every query still running
+     */
+    ~Batch() noexcept { Wait(); }
+
+    Batch(const Batch&) = delete;
+    Batch& operator=(const Batch&) = delete;
+
+    /**
+     * queues a query
+     * \param query - wql query text
+     * \param options - batching behaviour, deadline and cancellation of the query
+     * \returns future holding the collected result, or the exception the query raised
+     */
+    [[nodiscard]] std::future<BatchResult> Add(const std::wstring_view query,
+                                               QueryOptions options = {}) {
+        auto promise = std::make_shared<std::promise<BatchResult>>();
+        auto future = promise->get_future();
+        Add(
+            query,
+            [promise](BatchResult&& result, const std::exception_ptr& error) {
+                if (error) {
+                    promise->set_exception(error);
+                } else {
+                    promise->set_value(std::move(result));
+                }
+            },
+            std::move(options));
+        return future;
+    }
+
+    /**
+     * queues a query whose result is handed to a callback on the worker thread
+     * \param query - wql query text
+     * \param callback - receives the result, or the exception the query raised; must not throw
+     * \param options - batching behaviour, deadline and cancellation of the query
+     */
+    void Add(const std::wstring_view query, Callback callback, QueryOptions options = {}) {
+        {
+            const std::lock_guard lock(mutex_);
+            ++pending_;
+        }
+        pool_.Submit([this, query = std::wstring(query), callback = std::move(callback),
+                      options = std::move(options)]() mutable {
+            BatchResult result;
+            std::exception_ptr error;
+            try {
+                result = Collect(std::move(query), options);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            callback(std::move(result), error);
+
+            {
+                const std::lock_guard lock(mutex_);
+                --pending_;
+            }
+            idle_.notify_all();
+        });
+    }
+
+    /**
+     * blocks until every query queued so far has delivered its result
+     */
+    void Wait() {
+        std::unique_lock lock(mutex_);
+        idle_.wait(lock, [this] { return pending_ == 0; });
+    }
+
+    [[nodiscard]] std::size_t Workers() const noexcept { return pool_.Size(); }
+
+   private:
+    [[nodiscard]] BatchResult Collect(std::wstring query, const QueryOptions& options) const {
+#ifdef _WIN32
+        // one apartment per worker thread, left when the pool shuts the thread down
+        static thread_local COMInitializer com_init(COINIT_MULTITHREADED);
+#endif
+        const auto start = std::chrono::steady_clock::now();
+
+        BatchResult result;
+        const auto query_result = iface_->ExecuteQuery(query, options);
+        for (const auto& object : query_result) {
+            result.objects.push_back(object);
+        }
+        result.status = query_result.GetStatus();
+        result.elapsed = std::chrono::steady_clock::now() - start;
+        result.query = std::move(query);
+        return result;
+    }
+
+    std::shared_ptr<const Interface> iface_;
+    std::mutex mutex_;
+    std::condition_variable idle_;
+    std::size_t pending_ = 0;
+    // declared last so the workers stop before the state they use goes away
+    ThreadPool pool_;
+};
+
+}  // namespace wmi
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <wmi/variant.hxx>
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+namespace wmi {
+
+/**
+ * data member of a struct bound to a wmi property of the same name
+ */
+template <typename Owner, typename Member>
+struct FieldBinding {
+    using MemberType = Member;
+
+    std::wstring_view name;
+    Member Owner::*member;
+};
+
+template <typename Owner, typename Member>
+[[nodiscard]] constexpr FieldBinding<Owner, Member> Field(const std::wstring_view name,
+                                                          Member Owner::*member) noexcept {
+    return {name, member};
+}
+
+/**
+ * wmi class whose objects are read into a struct, and the members receiving its properties
+ */
+template <typename... Fields>
+struct ClassBinding {
+    std::wstring_view class_name;
+    std::tuple<Fields...> fields;
+};
+
+template <typename... Fields>
+[[nodiscard]] constexpr ClassBinding<Fields...> Bind(const std::wstring_view class_name,
+                                                     const Fields... fields) noexcept {
+    static_assert(sizeof...(Fields) > 0, "a binding needs at least one member");
+    return {class_name, std::tuple<Fields...>(fields...)};
+}
+
+namespace detail {
+
+/**
+ * binding declared with WMI_BINDING, found by argument-dependent lookup in the namespace of T
+ */
+template <typename T>
+[[nodiscard]] constexpr auto BindingOf() {
+    return WmiBinding(static_cast<const T*>(nullptr));
+}
+
+inline constexpr std::wstring_view SELECT_KEYWORD = L"SELECT ";
+inline constexpr std::wstring_view FROM_KEYWORD = L" FROM ";
+inline constexpr std::wstring_view LIST_SEPARATOR = L", ";
+
+template <typename T>
+[[nodiscard]] constexpr std::size_t SelectLength() {
+    constexpr auto binding = BindingOf<T>();
+    std::size_t length = SELECT_KEYWORD.size() + FROM_KEYWORD.size() + binding.class_name.size();
+    std::apply(
+        [&length](const auto&... fields) {
+            ((length += fields.name.size() + LIST_SEPARATOR.size()), ...);
+        },
+        binding.fields);
+    return length - LIST_SEPARATOR.size();
+}
+
+template <typename T>
+[[nodiscard]] constexpr std::array<wchar_t, SelectLength<T>() + 1> BuildSelect() {
+    constexpr auto binding = BindingOf<T>();
+    std::array<wchar_t, SelectLength<T>() + 1> text{};
+    std::size_t position = 0;
+    const auto append = [&text, &position](const std::wstring_view part) {
+        for (const auto ch : part) {
+            text[position++] = ch;
+        }
+    };
+
+    append(SELECT_KEYWORD);
+    std::apply(
+        [&append](const auto&... fields) {
+            bool first = true;
+            ((append(first ? std::wstring_view() : LIST_SEPARATOR), append(fields.name),
+              first = false),
+             ...);
+        },
+        binding.fields);
+    append(FROM_KEYWORD);
+    append(binding.class_name);
+    return text;
+}
+
+/**
+ * null-terminated select statement of a bound struct, built at compile time
+ */
+template <typename T>
+struct SelectText {
+    static constexpr auto TEXT = BuildSelect<T>();
+    static constexpr std::wstring_view VALUE{TEXT.data(), TEXT.size() - 1};
+};
+
+template <typename T>
+struct IsOptional : std::false_type {};
+
+template <typename T>
+struct IsOptional<std::optional<T>> : std::true_type {};
+
+/**
+ * converts a property into a bound member, the conversion is picked from the member type
+ * a null or unconvertible value resets optional members and leaves the others untouched
+ */
+template <typename Member>
+void AssignField(Member& member, const Variant* value) {
+    if constexpr (IsOptional<Member>::value) {
+        member = value ? ConvertVariant<typename Member::value_type>(*value) : std::nullopt;
+    } else if (value) {
+        if (auto converted = ConvertVariant<Member>(*value)) {
+            member = std::move(*converted);
+        }
+    }
+}
+
+}  // namespace detail
+
+}  // namespace wmi
+
+#define WMI_DETAIL_EXPAND(x) x
+#define WMI_DETAIL_CONCAT(a, b) WMI_DETAIL_CONCAT_IMPL(a, b)
+#define WMI_DETAIL_CONCAT_IMPL(a, b) a##b
+#define WMI_DETAIL_FIELD(type, member) ::wmi::Field(L"" #member, &type::member)
+
+#define WMI_DETAIL_FIELDS_1(type, member) WMI_DETAIL_FIELD(type, member)
+#define WMI_DETAIL_FIELDS_2(type, member, ...) \
+    WMI_DETAIL_FIELD(type, member), WMI_DETAIL_EXPAND(WMI_DETAIL_FIELDS_1(type, __VA_ARGS__))
+#define WMI_DETAIL_FIELDS_3(type, member, ...) \
+    WMI_DETAIL_FIELD(type, member), WMI_DETAIL_EXPAND(WMI_DETAIL_FIELDS_2(type, __VA_ARGS__))
+#define WMI_DETAIL_FIELDS_4(type, member, ...) \
+    WMI_DETAIL_FIELD(type, member), WMI_DETAIL_EXPAND(WMI_DETAIL_FIELDS_3(type, __VA_ARGS__))
+#define WMI_DETAIL_FIELDS_5(type, member, ...) \
+    WMI_DETAIL_FIELD(type, member), WMI_DETAIL_EXPAND(WMI_DETAIL_FIELDS_4(type, __VA_ARGS__))
+#define WMI_DETAIL_FIELDS_6(type, member, ...) \
+    WMI_DETAIL_FIELD(type, member), WMI_DETAIL_EXPAND(WMI_DETAIL_FIELDS_5(type, __VA_ARGS__))
+#define WMI_DETAIL_FIELDS_7(type, member, ...) \
+    WMI_DETAIL_FIELD(type, member), WMI_DETAIL_EXPAND(WMI_DETAIL_FIELDS_6(type, __VA_ARGS__))
+#define WMI_DETAIL_FIELDS_8(type, member, ...) \
+    WMI_DETAIL_FIELD(type, member), WMI_DETAIL_EXPAND(WMI_DETAIL_FIELDS_7(type, __VA_ARGS__))
+#define WMI_DETAIL_FIELDS_9(type, member, ...) \
+    WMI_DETAIL_FIELD(type, member), WMI_DETAIL_EXPAND(WMI_DETAIL_FIELDS_8(type, __VA_ARGS__))
+#define WMI_DETAIL_FIELDS_10(type, member, ...) \
+    WMI_DETAIL_FIELD(type, member), WMI_DETAIL_EXPAND(WMI_DETAIL_FIELDS_9(type, __VA_ARGS__))
+#define WMI_DETAIL_FIELDS_11(type, member, ...) \
+    WMI_DETAIL_FIELD(type, member), WMI_DETAIL_EXPAND(WMI_DETAIL_FIELDS_10(type, __VA_ARGS__))
+#define WMI_DETAIL_FIELDS_12(type, member, ...) \
+    WMI_DETAIL_FIELD(type, member), WMI_DETAIL_EXPAND(WMI_DETAIL_FIELDS_11(type, __VA_ARGS__))
+#define WMI_DETAIL_FIELDS_13(type, member, ...) \
+    WMI_DETAIL_FIELD(type, member), WMI_DETAIL_EXPAND(WMI_DETAIL_FIELDS_12(type, __VA_ARGS__))
+#define WMI_DETAIL_FIELDS_14(type, member, ...) \
+    WMI_DETAIL_FIELD(type, member), WMI_DETAIL_EXPAND(WMI_DETAIL_FIELDS_13(type, __VA_ARGS__))
+#define WMI_DETAIL_FIELDS_15(type, member, ...) \
+    WMI_DETAIL_FIELD(type, member), WMI_DETAIL_EXPAND(WMI_DETAIL_FIELDS_14(type, __VA_ARGS__))
+#define WMI_DETAIL_FIELDS_16(type, member, ...) \
+    WMI_DETAIL_FIELD(type, member), WMI_DETAIL_EXPAND(WMI_DETAIL_FIELDS_15(type, __VA_ARGS__))
+#define WMI_DETAIL_FIELDS_17(type, member, ...) \
+    WMI_DETAIL_FIELD(type, member), WMI_DETAIL_EXPAND(WMI_DETAIL_FIELDS_16(type, __VA_ARGS__))
+#define WMI_DETAIL_FIELDS_18(type, member, ...) \
+    WMI_DETAIL_FIELD(type, member), WMI_DETAIL_EXPAND(WMI_DETAIL_FIELDS_17(type, __VA_ARGS__))
+#define WMI_DETAIL_FIELDS_19(type, member, ...) \
+    WMI_DETAIL_FIELD(type, member), WMI_DETAIL_EXPAND(WMI_DETAIL_FIELDS_18(type, __VA_ARGS__))
+#define WMI_DETAIL_FIELDS_20(type, member, ...) \
+    WMI_DETAIL_FIELD(type, member), WMI_DETAIL_EXPAND(WMI_DETAIL_FIELDS_19(type, __VA_ARGS__))
+#define WMI_DETAIL_FIELDS_21(type, member, ...) \
+    WMI_DETAIL_FIELD(type, member), WMI_DETAIL_EXPAND(WMI_DETAIL_FIELDS_20(type, __VA_ARGS__))
+#define WMI_DETAIL_FIELDS_22(type, member, ...) \
+    WMI_DETAIL_FIELD(type, member), WMI_DETAIL_EXPAND(WMI_DETAIL_FIELDS_21(type, __VA_ARGS__))
+#define WMI_DETAIL_FIELDS_23(type, member, ...) \
+    WMI_DETAIL_FIELD(type, member), WMI_DETAIL_EXPAND(WMI_DETAIL_FIELDS_22(type, __VA_ARGS__))
+#define WMI_DETAIL_FIELDS_24(type, member, ...) \
+    WMI_DETAIL_FIELD(type, member), WMI_DETAIL_EXPAND(WMI_DETAIL_FIELDS_23(type, __VA_ARGS__))
+#define WMI_DETAIL_FIELDS_25(type, member, ...) \
+    WMI_DETAIL_FIELD(type, member), WMI_DETAIL_EXPAND(WMI_DETAIL_FIELDS_24(type, __VA_ARGS__))
+#define WMI_DETAIL_FIELDS_26(type, member, ...) \
+    WMI_DETAIL_FIELD(type, member), WMI_DETAIL_EXPAND(WMI_DETAIL_FIELDS_25(type, __VA_ARGS__))
+#define WMI_DETAIL_FIELDS_27(type, member, ...) \
+    WMI_DETAIL_FIELD(type, member), WMI_DETAIL_EXPAND(WMI_DETAIL_FIELDS_26(type, __VA_ARGS__))
+#define WMI_DETAIL_FIELDS_28(type, member, ...) \
+    WMI_DETAIL_FIELD(type, member), WMI_DETAIL_EXPAND(WMI_DETAIL_FIELDS_27(type, __VA_ARGS__))
+#define WMI_DETAIL_FIELDS_29(type, member, ...) \
+    WMI_DETAIL_FIELD(type, member), WMI_DETAIL_EXPAND(WMI_DETAIL_FIELDS_28(type, __VA_ARGS__))
+#define WMI_DETAIL_FIELDS_30(type, member, ...) \
+    WMI_DETAIL_FIELD(type, member), WMI_DETAIL_EXPAND(WMI_DETAIL_FIELDS_29(type, __VA_ARGS__))
+#define WMI_DETAIL_FIELDS_31(type, member, ...) \
+    WMI_DETAIL_FIELD(type, member), WMI_DETAIL_EXPAND(WMI_DETAIL_FIELDS_30(type, __VA_ARGS__))
+#define WMI_DETAIL_FIELDS_32(type, member, ...) \
+    WMI_DETAIL_FIELD(type, member), WMI_DETAIL_EXPAND(WMI_DETAIL_FIELDS_31(type, __VA_ARGS__))
+
+#define WMI_DETAIL_COUNT_N(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, \
+    _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, N, ...) N
+#define WMI_DETAIL_COUNT(...) WMI_DETAIL_EXPAND(WMI_DETAIL_COUNT_N(__VA_ARGS__, 32, 31, 30, 29, \
+    28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, \
+    3, 2, 1, 0))
+
+#define WMI_DETAIL_FIELDS(type, ...)                                                        \
+    WMI_DETAIL_EXPAND(WMI_DETAIL_CONCAT(WMI_DETAIL_FIELDS_, WMI_DETAIL_COUNT(__VA_ARGS__))( \
+        type, __VA_ARGS__))
+
+/**
+ * binds the members of a struct to the properties of a wmi class, see Interface::Query
+ * place it in the namespace of the struct, members are named after the properties:
+ *     struct Disk { std::string DeviceID; std::uint64_t Size; };
+ *     WMI_BINDING(Disk, L"Win32_LogicalDisk", DeviceID, Size)
+ * up to 32 members, a member of type std::optional<T> tells a null property apart
+ */
+#define WMI_BINDING(type, class_name, ...)                                         \
+    [[maybe_unused]] constexpr auto WmiBinding(const type*) {                     \
+        return ::wmi::Bind(class_name, WMI_DETAIL_FIELDS(type, __VA_ARGS__));     \
+    }
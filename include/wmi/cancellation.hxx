@@ -0,0 +1,155 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace wmi {
+
+class CancellationToken;
+
+namespace detail {
+
+/**
+ * state shared by a cancellation source and its tokens
+ */
+struct CancellationState {
+    std::atomic<bool> cancelled{false};
+    std::mutex mutex;
+    std::size_t next_id = 0;
+    std::vector<std::pair<std::size_t, std::function<void()>>> callbacks;
+};
+
+}  // namespace detail
+
+/**
+ * keeps a cancellation callback registered, unregisters it when destroyed
+ * once the destructor returns the callback is guaranteed not to be running
+ */
+class CancellationRegistration {
+    friend class CancellationToken;
+
+   public:
+    CancellationRegistration() noexcept = default;
+
+    ~CancellationRegistration() noexcept { Reset(); }
+
+    CancellationRegistration(const CancellationRegistration&) = delete;
+    CancellationRegistration& operator=(const CancellationRegistration&) = delete;
+
+    CancellationRegistration(CancellationRegistration&& other) noexcept
+        : state_(std::move(other.state_)), id_(other.id_) {}
+
+    CancellationRegistration& operator=(CancellationRegistration&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            state_ = std::move(other.state_);
+            id_ = other.id_;
+        }
+        return *this;
+    }
+
+    void Reset() noexcept {
+        if (!state_) {
+            return;
+        }
+        const std::lock_guard lock(state_->mutex);
+        auto& callbacks = state_->callbacks;
+        for (auto it = callbacks.begin(); it != callbacks.end(); ++it) {
+            if (it->first == id_) {
+                callbacks.erase(it);
+                break;
+            }
+        }
+        state_.reset();
+    }
+
+   private:
+    CancellationRegistration(std::shared_ptr<detail::CancellationState> state, const std::size_t id)
+        : state_(std::move(state)), id_(id) {}
+
+    std::shared_ptr<detail::CancellationState> state_;
+    std::size_t id_ = 0;
+};
+
+/**
+ * observer side of a cancellation request, cheap to copy
+ * a default constructed token can never be cancelled
+ */
+class CancellationToken {
+    friend class CancellationSource;
+
+   public:
+    CancellationToken() noexcept = default;
+
+    [[nodiscard]] bool IsCancelled() const noexcept {
+        return state_ && state_->cancelled.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] bool CanBeCancelled() const noexcept { return state_ != nullptr; }
+
+    /**
+     * runs a callback when cancellation is requested, right away if it already was
+     * callbacks run on the cancelling thread and must not register or unregister callbacks
+     * \param callback - action to run once
+     * \returns registration keeping the callback alive
+     */
+    [[nodiscard]] CancellationRegistration Register(std::function<void()> callback) const {
+        if (!state_) {
+            return {};
+        }
+        {
+            const std::lock_guard lock(state_->mutex);
+            if (!state_->cancelled.load(std::memory_order_acquire)) {
+                const auto id = state_->next_id++;
+                state_->callbacks.emplace_back(id, std::move(callback));
+                return {state_, id};
+            }
+        }
+        callback();
+        return {};
+    }
+
+   private:
+    explicit CancellationToken(std::shared_ptr<detail::CancellationState> state) noexcept
+        : state_(std::move(state)) {}
+
+    std::shared_ptr<detail::CancellationState> state_;
+};
+
+/**
+ * owner side of a cancellation request, hands out tokens to the queries it may stop
+ */
+class CancellationSource {
+   public:
+    [[nodiscard]] CancellationToken GetToken() const noexcept { return CancellationToken(state_); }
+
+    [[nodiscard]] bool IsCancelled() const noexcept {
+        return state_->cancelled.load(std::memory_order_acquire);
+    }
+
+    /**
+     * requests cancellation and runs the registered callbacks, later calls do nothing
+     */
+    void Cancel() {
+        const std::lock_guard lock(state_->mutex);
+        if (state_->cancelled.exchange(true, std::memory_order_acq_rel)) {
+            return;
+        }
+        // run under the lock so an unregistering owner waits for its callback to finish
+        for (auto& [id, callback] : state_->callbacks) {
+            callback();
+        }
+        state_->callbacks.clear();
+    }
+
+   private:
+    std::shared_ptr<detail::CancellationState> state_ =
+        std::make_shared<detail::CancellationState>();
+};
+
+}  // namespace wmi
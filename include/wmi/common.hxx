@@ -0,0 +1,178 @@
+#pragma once
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace wmi {
+
+/**
+ * custom exception type for wmi operations that provides clear error context
+ * wraps standard runtime_error to maintain compatibility while adding wmi-specific context
+ */
+struct Exception final : std::runtime_error {
+    explicit Exception(const std::string& message) : std::runtime_error(message) {}
+};
+
+/**
+ * portable hresult used by every backend
+ * mirrors the com convention: negative values are failures, everything else is success
+ */
+using HResult = std::int32_t;
+
+/**
+ * wbem status codes shared by all backends
+ * values match the windows wbemstatus constants so the com backend can pass them through as-is
+ */
+namespace status {
+inline constexpr HResult Ok = 0;                                             // WBEM_S_NO_ERROR
+inline constexpr HResult False = 1;                                          // WBEM_S_FALSE
+inline constexpr HResult TimedOut = 0x40004;                                 // WBEM_S_TIMEDOUT
+inline constexpr HResult Failed = static_cast<HResult>(0x80041001);          // WBEM_E_FAILED
+inline constexpr HResult NotFound = static_cast<HResult>(0x80041002);        // WBEM_E_NOT_FOUND
+inline constexpr HResult AccessDenied = static_cast<HResult>(0x80041003);    // WBEM_E_ACCESS_DENIED
+inline constexpr HResult InvalidClass = static_cast<HResult>(0x80041010);    // WBEM_E_INVALID_CLASS
+inline constexpr HResult InvalidQuery = static_cast<HResult>(0x80041017);    // WBEM_E_INVALID_QUERY
+inline constexpr HResult NotSupported = static_cast<HResult>(0x8004100C);    // WBEM_E_NOT_SUPPORTED
+inline constexpr HResult Cancelled = static_cast<HResult>(0x80041032);     // WBEM_E_CALL_CANCELLED
+}  // namespace status
+
+/**
+ * timeout value meaning "block until the provider answers"
+ * equivalent to WBEM_INFINITE
+ */
+inline constexpr long INFINITE_TIMEOUT = -1;
+
+[[nodiscard]] constexpr bool Succeeded(const HResult hr) noexcept { return hr >= 0; }
+
+[[nodiscard]] constexpr bool Failed(const HResult hr) noexcept { return hr < 0; }
+
+/**
+ * formats hresult error codes into human-readable strings for debugging
+ * combines operation description with hex error code for quick diagnosis
+ * \param operation - description of what failed
+ * \param hr - the hresult error code from windows api
+ * \returns formatted error string with operation context
+ */
+[[nodiscard]] inline std::string FormatHResultError(const std::string& operation, HResult hr) {
+    return operation + " (HRESULT: 0x" + std::to_string(static_cast<unsigned>(hr)) + ")";
+}
+
+/**
+ * ascii case-insensitive comparison of wide strings
+ * wmi class and property names are case-insensitive and always ascii
+ * \returns true if both strings match ignoring ascii case
+ */
+[[nodiscard]] constexpr bool EqualsIgnoreCase(const std::wstring_view lhs,
+                                              const std::wstring_view rhs) noexcept {
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < lhs.size(); ++i) {
+        auto a = lhs[i];
+        auto b = rhs[i];
+        if (a >= L'A' && a <= L'Z') {
+            a = static_cast<wchar_t>(a - L'A' + L'a');
+        }
+        if (b >= L'A' && b <= L'Z') {
+            b = static_cast<wchar_t>(b - L'A' + L'a');
+        }
+        if (a != b) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * converts a wide string to the narrow encoding used by the rest of the program
+ * windows keeps the ansi code page like _com_util did, other platforms produce utf-8
+ * \param text - wide string (utf-16 on windows, utf-32 elsewhere)
+ * \returns narrow copy of the text
+ */
+[[nodiscard]] inline std::string NarrowString(const std::wstring_view text) {
+    if (text.empty()) {
+        return {};
+    }
+#ifdef _WIN32
+    const int length = WideCharToMultiByte(CP_ACP, 0, text.data(), static_cast<int>(text.size()),
+                                           nullptr, 0, nullptr, nullptr);
+    std::string result(static_cast<std::size_t>(length), '\0');
+    WideCharToMultiByte(CP_ACP, 0, text.data(), static_cast<int>(text.size()), result.data(),
+                        length, nullptr, nullptr);
+    return result;
+#else
+    std::string result;
+    result.reserve(text.size());
+    for (const wchar_t ch : text) {
+        const auto cp = static_cast<std::uint32_t>(ch);
+        if (cp < 0x80) {
+            result.push_back(static_cast<char>(cp));
+        } else if (cp < 0x800) {
+            result.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+            result.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        } else if (cp < 0x10000) {
+            result.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+            result.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+            result.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        } else {
+            result.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+            result.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+            result.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+            result.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        }
+    }
+    return result;
+#endif
+}
+
+/**
+ * widens a narrow string, the inverse of NarrowString
+ * \param text - ansi text on windows, utf-8 elsewhere
+ * \returns wide copy of the text
+ */
+[[nodiscard]] inline std::wstring WidenString(const std::string_view text) {
+    if (text.empty()) {
+        return {};
+    }
+#ifdef _WIN32
+    const int length =
+        MultiByteToWideChar(CP_ACP, 0, text.data(), static_cast<int>(text.size()), nullptr, 0);
+    std::wstring result(static_cast<std::size_t>(length), L'\0');
+    MultiByteToWideChar(CP_ACP, 0, text.data(), static_cast<int>(text.size()), result.data(),
+                        length);
+    return result;
+#else
+    std::wstring result;
+    result.reserve(text.size());
+    for (std::size_t i = 0; i < text.size();) {
+        const auto lead = static_cast<unsigned char>(text[i]);
+        std::size_t extra = 0;
+        std::uint32_t cp = lead;
+        if (lead >= 0xF0) {
+            extra = 3;
+            cp = lead & 0x07;
+        } else if (lead >= 0xE0) {
+            extra = 2;
+            cp = lead & 0x0F;
+        } else if (lead >= 0xC0) {
+            extra = 1;
+            cp = lead & 0x1F;
+        }
+        ++i;
+        for (std::size_t k = 0; k < extra && i < text.size(); ++k, ++i) {
+            cp = (cp << 6) | (static_cast<unsigned char>(text[i]) & 0x3F);
+        }
+        result.push_back(static_cast<wchar_t>(cp));
+    }
+    return result;
+#endif
+}
+
+}  // namespace wmi
@@ -0,0 +1,504 @@
+#pragma once
+
+#include <wmi/wmi.hxx>
+
+// coroutine support needs a c++20 compiler, the header is empty otherwise
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace wmi {
+
+template <typename T = void>
+class Task;
+
+namespace detail {
+
+class TaskPromiseBase {
+   public:
+    struct FinalAwaiter {
+        [[nodiscard]] bool await_ready() const noexcept { return false; }
+
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            return handle.promise().continuation_;
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    [[nodiscard]] std::suspend_always initial_suspend() const noexcept { return {}; }
+    [[nodiscard]] FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() noexcept { error_ = std::current_exception(); }
+
+    void SetContinuation(const std::coroutine_handle<> continuation) noexcept {
+        continuation_ = continuation;
+    }
+
+   protected:
+    void RethrowIfFailed() const {
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+    }
+
+   private:
+    std::coroutine_handle<> continuation_ = std::noop_coroutine();
+    std::exception_ptr error_;
+};
+
+template <typename T>
+class TaskPromise final : public TaskPromiseBase {
+   public:
+    Task<T> get_return_object() noexcept;
+
+    template <typename U>
+    void return_value(U&& value) {
+        value_.emplace(std::forward<U>(value));
+    }
+
+    T TakeResult() {
+        RethrowIfFailed();
+        return std::move(*value_);
+    }
+
+   private:
+    std::optional<T> value_;
+};
+
+template <>
+class TaskPromise<void> final : public TaskPromiseBase {
+   public:
+    Task<void> get_return_object() noexcept;
+
+    void return_void() const noexcept {}
+
+    void TakeResult() const { RethrowIfFailed(); }
+};
+
+}  // namespace detail
+
+/**
+ * lazily started coroutine producing a value, runs when awaited
+ * exceptions thrown inside the coroutine come out of the co_await
+ * \tparam T - result type, void for none
+ */
+template <typename T>
+class Task {
+   public:
+    using promise_type = detail::TaskPromise<T>;
+
+    explicit Task(const std::coroutine_handle<promise_type> handle) noexcept : handle_(handle) {}
+
+    ~Task() noexcept {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+
+    /**
+     * starts the task, the awaiter takes the coroutine over and frees it after the co_await
+     */
+    auto operator co_await() && noexcept {
+        class Awaiter {
+           public:
+            explicit Awaiter(const std::coroutine_handle<promise_type> handle) noexcept
+                : handle_(handle) {}
+
+            ~Awaiter() noexcept {
+                if (handle_) {
+                    handle_.destroy();
+                }
+            }
+
+            Awaiter(const Awaiter&) = delete;
+            Awaiter& operator=(const Awaiter&) = delete;
+
+            Awaiter(Awaiter&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+            Awaiter& operator=(Awaiter&&) = delete;
+
+            [[nodiscard]] bool await_ready() const noexcept { return !handle_ || handle_.done(); }
+
+            std::coroutine_handle<> await_suspend(const std::coroutine_handle<> awaiting) noexcept {
+                handle_.promise().SetContinuation(awaiting);
+                return handle_;
+            }
+
+            T await_resume() {
+                if (!handle_) {
+                    throw Exception("Cannot await an empty task");
+                }
+                return handle_.promise().TakeResult();
+            }
+
+           private:
+            std::coroutine_handle<promise_type> handle_;
+        };
+        return Awaiter(std::exchange(handle_, nullptr));
+    }
+
+   private:
+    std::coroutine_handle<promise_type> handle_;
+};
+
+namespace detail {
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() noexcept {
+    return Task<T>(std::coroutine_handle<TaskPromise>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() noexcept {
+    return Task<void>(std::coroutine_handle<TaskPromise>::from_promise(*this));
+}
+
+}  // namespace detail
+
+/**
+ * coroutine yielding values one at a time, the consumer awaits each of them
+ * \tparam T - type of the yielded values
+ */
+template <typename T>
+class AsyncGenerator {
+   public:
+    class promise_type {
+        friend class AsyncGenerator;
+
+       public:
+        struct YieldAwaiter {
+            [[nodiscard]] bool await_ready() const noexcept { return false; }
+
+            std::coroutine_handle<> await_suspend(
+                const std::coroutine_handle<promise_type> handle) noexcept {
+                return handle.promise().consumer_;
+            }
+
+            void await_resume() const noexcept {}
+        };
+
+        AsyncGenerator get_return_object() noexcept {
+            return AsyncGenerator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        [[nodiscard]] std::suspend_always initial_suspend() const noexcept { return {}; }
+        [[nodiscard]] YieldAwaiter final_suspend() const noexcept { return {}; }
+
+        template <typename U>
+        YieldAwaiter yield_value(U&& value) {
+            current_.emplace(std::forward<U>(value));
+            return {};
+        }
+
+        void return_void() const noexcept {}
+        void unhandled_exception() noexcept { error_ = std::current_exception(); }
+
+       private:
+        std::coroutine_handle<> consumer_ = std::noop_coroutine();
+        std::optional<T> current_;
+        std::exception_ptr error_;
+    };
+
+    explicit AsyncGenerator(const std::coroutine_handle<promise_type> handle) noexcept
+        : handle_(handle) {}
+
+    ~AsyncGenerator() noexcept {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    AsyncGenerator(const AsyncGenerator&) = delete;
+    AsyncGenerator& operator=(const AsyncGenerator&) = delete;
+
+    AsyncGenerator(AsyncGenerator&& other) noexcept
+        : handle_(std::exchange(other.handle_, nullptr)) {}
+
+    AsyncGenerator& operator=(AsyncGenerator&& other) noexcept {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+
+    /**
+     * runs the generator up to its next value
+     * \returns awaitable resulting in the value, nullopt once the generator finished
+     */
+    auto Next() noexcept {
+        struct Awaiter {
+            std::coroutine_handle<promise_type> handle;
+
+            [[nodiscard]] bool await_ready() const noexcept { return !handle || handle.done(); }
+
+            std::coroutine_handle<> await_suspend(const std::coroutine_handle<> consumer) noexcept {
+                handle.promise().consumer_ = consumer;
+                handle.promise().current_.reset();
+                return handle;
+            }
+
+            std::optional<T> await_resume() {
+                if (!handle) {
+                    return std::nullopt;
+                }
+                auto& promise = handle.promise();
+                if (promise.error_) {
+                    std::rethrow_exception(std::exchange(promise.error_, nullptr));
+                }
+                if (handle.done()) {
+                    return std::nullopt;
+                }
+                return std::move(promise.current_);
+            }
+        };
+        return Awaiter{handle_};
+    }
+
+   private:
+    std::coroutine_handle<promise_type> handle_;
+};
+
+/**
+ * runs coroutines on the threads calling Run, one or several of them
+ * a coroutine waiting for objects holds no thread, the query wakes it up through the loop
+ * the loop must outlive the tasks spawned on it
+ */
+class EventLoop {
+   public:
+    EventLoop() = default;
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    /**
+     * starts a task detached from the caller, it first runs inside Run
+     * \param task - coroutine to drive to completion
+     */
+    void Spawn(Task<void> task) {
+        {
+            const std::lock_guard lock(mutex_);
+            ++outstanding_;
+        }
+        Post(Drive(*this, std::move(task)).handle);
+    }
+
+    /**
+     * queues a suspended coroutine to be resumed by one of the running threads, thread safe
+     */
+    void Post(const std::coroutine_handle<> handle) {
+        {
+            const std::lock_guard lock(mutex_);
+            ready_.push_back(handle);
+        }
+        changed_.notify_one();
+    }
+
+    /**
+     * resumes queued coroutines until every spawned task finished
+     * \throws the first exception a spawned task let escape
+     */
+    void Run() {
+        EventLoop* const previous = std::exchange(current_, this);
+        std::unique_lock lock(mutex_);
+        for (;;) {
+            changed_.wait(lock, [this] { return !ready_.empty() || outstanding_ == 0; });
+            if (ready_.empty()) {
+                break;
+            }
+            const auto handle = ready_.front();
+            ready_.pop_front();
+            lock.unlock();
+            handle.resume();
+            lock.lock();
+        }
+        current_ = previous;
+        if (error_) {
+            std::rethrow_exception(std::exchange(error_, nullptr));
+        }
+    }
+
+    /**
+     * number of spawned tasks that have not finished yet
+     */
+    [[nodiscard]] std::size_t Outstanding() const {
+        const std::lock_guard lock(mutex_);
+        return outstanding_;
+    }
+
+    /**
+     * loop whose Run is executing on the calling thread
+     * \returns loop, nullptr outside of Run
+     */
+    [[nodiscard]] static EventLoop* Current() noexcept { return current_; }
+
+   private:
+    // fire-and-forget frame that frees itself once the task it drives returned
+    struct Detached {
+        struct promise_type {
+            Detached get_return_object() noexcept {
+                return {std::coroutine_handle<promise_type>::from_promise(*this)};
+            }
+            [[nodiscard]] std::suspend_always initial_suspend() const noexcept { return {}; }
+            [[nodiscard]] std::suspend_never final_suspend() const noexcept { return {}; }
+            void return_void() const noexcept {}
+            void unhandled_exception() const noexcept {}
+        };
+
+        std::coroutine_handle<promise_type> handle;
+    };
+
+    static Detached Drive(EventLoop& loop, Task<void> task) {
+        std::exception_ptr error;
+        try {
+            co_await std::move(task);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        loop.Finish(std::move(error));
+    }
+
+    void Finish(std::exception_ptr error) {
+        {
+            const std::lock_guard lock(mutex_);
+            if (error && !error_) {
+                error_ = std::move(error);
+            }
+            --outstanding_;
+        }
+        changed_.notify_all();
+    }
+
+    static inline thread_local EventLoop* current_ = nullptr;
+
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    std::deque<std::coroutine_handle<>> ready_;
+    std::size_t outstanding_ = 0;
+    std::exception_ptr error_;
+};
+
+namespace detail {
+
+/**
+ * suspends until objects or the final status arrive after an epoch was read
+ * the coroutine is resumed on the event loop it was running on
+ */
+class QueryChange {
+   public:
+    QueryChange(AsyncQuery& query, const std::uint64_t seen) noexcept
+        : query_(query), seen_(seen) {}
+
+    [[nodiscard]] bool await_ready() const { return query_.Epoch() != seen_; }
+
+    bool await_suspend(const std::coroutine_handle<> handle) {
+        EventLoop* const loop = EventLoop::Current();
+        if (!loop) {
+            throw Exception("Asynchronous WMI queries can only be awaited inside EventLoop::Run");
+        }
+        return query_.Subscribe(seen_, [loop, handle] { loop->Post(handle); });
+    }
+
+    void await_resume() const noexcept {}
+
+   private:
+    AsyncQuery& query_;
+    std::uint64_t seen_;
+};
+
+/**
+ * turns the final status of a finished query into an exception, cancellation is not an error
+ */
+inline void ThrowIfFailed(const AsyncQuery& query) {
+    if (const auto error = query.GetError()) {
+        std::rethrow_exception(error);
+    }
+    const auto result = query.GetStatus().value_or(status::Ok);
+    if (Failed(result) && result != status::Cancelled) {
+        throw Exception(FormatHResultError("Asynchronous WMI query failed", result));
+    }
+}
+
+}  // namespace detail
+
+/**
+ * yields the objects of an asynchronous query as they arrive, to be consumed inside EventLoop::Run
+ * \param query - running query, see Interface::ExecuteQueryAsync
+ * \returns generator ending after the last object
+ * \throws Exception if the query failed, objects before the failure are still yielded
+ */
+inline AsyncGenerator<Object> Rows(std::shared_ptr<AsyncQuery> query) {
+    for (;;) {
+        const auto seen = query->Epoch();
+        while (auto object = query->TryNext()) {
+            co_yield std::move(*object);
+        }
+        if (query->GetStatus()) {
+            // objects queued before the status are visible now
+            while (auto object = query->TryNext()) {
+                co_yield std::move(*object);
+            }
+            break;
+        }
+        co_await detail::QueryChange(*query, seen);
+    }
+    detail::ThrowIfFailed(*query);
+}
+
+/**
+ * collects every object of an asynchronous query without blocking the thread
+ * \param query - running query, see Interface::ExecuteQueryAsync
+ * \returns task resulting in the objects, the ones that arrived if the query was cancelled
+ * \throws Exception if the query failed
+ */
+inline Task<std::vector<Object>> Collect(std::shared_ptr<AsyncQuery> query) {
+    std::vector<Object> objects;
+    for (;;) {
+        const auto seen = query->Epoch();
+        query->Drain([&objects](const Object& object) { objects.push_back(object); });
+        if (query->GetStatus()) {
+            query->Drain([&objects](const Object& object) { objects.push_back(object); });
+            break;
+        }
+        co_await detail::QueryChange(*query, seen);
+    }
+    detail::ThrowIfFailed(*query);
+    co_return objects;
+}
+
+/**
+ * lets a coroutine write co_await iface->ExecuteQueryAsync(query) to get every object
+ */
+inline auto operator co_await(std::shared_ptr<AsyncQuery> query) {
+    return Collect(std::move(query)).operator co_await();
+}
+
+}  // namespace wmi
+
+#endif
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace wmi {
+
+/**
+ * cim interval, the duration form "ddddddddHHMMSS.mmmmmm:000" of a datetime property
+ * properties such as the up time of a job hold an interval instead of a point in time
+ */
+struct Interval {
+    std::chrono::microseconds duration{0};
+
+    [[nodiscard]] constexpr bool operator==(const Interval& other) const noexcept {
+        return duration == other.duration;
+    }
+
+    [[nodiscard]] constexpr bool operator!=(const Interval& other) const noexcept {
+        return !(*this == other);
+    }
+};
+
+namespace detail {
+
+// both forms are fixed width: 21 characters of date or duration, then the offset or ":000"
+inline constexpr std::size_t DMTF_LENGTH = 25;
+inline constexpr std::int64_t SECONDS_PER_DAY = 86400;
+inline constexpr std::int64_t MICROSECONDS_PER_SECOND = 1000000;
+
+/**
+ * value of a fixed run of decimal digits
+ * a non-digit only raises the flag instead of returning early, so decoding a whole column
+ * runs the same instructions for every value
+ * \param text - characters to read, at least offset + count of them
+ * \param offset - position of the first digit
+ * \param count - number of digits
+ * \param invalid - set when one of the characters is not a digit
+ */
+[[nodiscard]] constexpr std::int64_t DmtfDigits(const std::wstring_view text,
+                                                const std::size_t offset, const std::size_t count,
+                                                bool& invalid) noexcept {
+    std::int64_t value = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto digit =
+            static_cast<std::uint32_t>(text[offset + i]) - static_cast<std::uint32_t>(L'0');
+        invalid = invalid || digit > 9;
+        value = value * 10 + static_cast<std::int64_t>(digit);
+    }
+    return value;
+}
+
+[[nodiscard]] constexpr std::int64_t DaysInMonth(const std::int64_t year,
+                                                 const std::int64_t month) noexcept {
+    if (month == 2) {
+        return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0 ? 29 : 28;
+    }
+    return 30 + ((month + (month > 7 ? 1 : 0)) & 1);
+}
+
+/**
+ * days between 1970-01-01 and a date of the proleptic gregorian calendar
+ */
+[[nodiscard]] constexpr std::int64_t DaysFromCivil(std::int64_t year, const std::int64_t month,
+                                                   const std::int64_t day) noexcept {
+    year -= month <= 2 ? 1 : 0;
+    const auto era = (year >= 0 ? year : year - 399) / 400;
+    const auto year_of_era = year - era * 400;
+    const auto day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const auto day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+}
+
+/**
+ * decodes a cim datetime "yyyymmddHHMMSS.mmmmmmsUUU" straight from the utf-16 text
+ * the trailing sign and minutes are the offset of the local time from utc, the result is utc
+ * \param text - exactly 25 characters
+ * \param microseconds - receives the time since the unix epoch on success
+ * \returns false if the text is not a complete and valid datetime
+ */
+[[nodiscard]] constexpr bool ParseDateTime(const std::wstring_view text,
+                                           std::int64_t& microseconds) noexcept {
+    if (text.size() != DMTF_LENGTH) {
+        return false;
+    }
+
+    bool invalid = false;
+    const auto year = DmtfDigits(text, 0, 4, invalid);
+    const auto month = DmtfDigits(text, 4, 2, invalid);
+    const auto day = DmtfDigits(text, 6, 2, invalid);
+    const auto hour = DmtfDigits(text, 8, 2, invalid);
+    const auto minute = DmtfDigits(text, 10, 2, invalid);
+    const auto second = DmtfDigits(text, 12, 2, invalid);
+    const auto fraction = DmtfDigits(text, 15, 6, invalid);
+    const auto offset = DmtfDigits(text, 22, 3, invalid);
+    const auto sign = text[21];
+    invalid = invalid || text[14] != L'.' || (sign != L'+' && sign != L'-');
+    invalid = invalid || month < 1 || month > 12 || day < 1 || hour > 23 || minute > 59 ||
+              second > 59;
+    if (invalid || day > DaysInMonth(year, month)) {
+        return false;
+    }
+
+    const auto local = DaysFromCivil(year, month, day) * SECONDS_PER_DAY + hour * 3600 +
+                       minute * 60 + second;
+    const auto utc = local - (sign == L'-' ? -offset : offset) * 60;
+    microseconds = utc * MICROSECONDS_PER_SECOND + fraction;
+    return true;
+}
+
+/**
+ * decodes a cim interval "ddddddddHHMMSS.mmmmmm:000" straight from the utf-16 text
+ * \param text - exactly 25 characters
+ * \param microseconds - receives the length of the interval on success
+ * \returns false if the text is not a complete and valid interval
+ */
+[[nodiscard]] constexpr bool ParseInterval(const std::wstring_view text,
+                                           std::int64_t& microseconds) noexcept {
+    if (text.size() != DMTF_LENGTH) {
+        return false;
+    }
+
+    bool invalid = false;
+    const auto days = DmtfDigits(text, 0, 8, invalid);
+    const auto hours = DmtfDigits(text, 8, 2, invalid);
+    const auto minutes = DmtfDigits(text, 10, 2, invalid);
+    const auto seconds = DmtfDigits(text, 12, 2, invalid);
+    const auto fraction = DmtfDigits(text, 15, 6, invalid);
+    const auto zero = DmtfDigits(text, 22, 3, invalid);
+    invalid = invalid || text[14] != L'.' || text[21] != L':' || zero != 0;
+    if (invalid || hours > 23 || minutes > 59 || seconds > 59) {
+        return false;
+    }
+
+    // 99999999 days still fit a signed 64-bit count of microseconds
+    const auto total = ((days * 24 + hours) * 60 + minutes) * 60 + seconds;
+    microseconds = total * MICROSECONDS_PER_SECOND + fraction;
+    return true;
+}
+
+/**
+ * decodes a cim datetime into a point of the system clock
+ * \returns nullopt if the text is invalid or outside the range of the clock
+ */
+[[nodiscard]] inline std::optional<std::chrono::system_clock::time_point> ToTimePoint(
+    const std::wstring_view text) noexcept {
+    using Clock = std::chrono::system_clock;
+    // nanosecond clocks end in 2262, while dmtf years run to 9999
+    constexpr auto LIMIT =
+        std::chrono::duration_cast<std::chrono::microseconds>(Clock::duration::max()).count();
+
+    std::int64_t microseconds = 0;
+    if (!ParseDateTime(text, microseconds) || microseconds > LIMIT || microseconds < -LIMIT) {
+        return std::nullopt;
+    }
+    return Clock::time_point(
+        std::chrono::duration_cast<Clock::duration>(std::chrono::microseconds(microseconds)));
+}
+
+}  // namespace detail
+
+/**
+ * decodes a column of cim datetimes, e.g. one column of the rows of a prepared query
+ * every value takes the same fixed-width path without allocating, so the loop has no
+ * per-value setup and no data-dependent exits
+ * \param texts - datetime strings
+ * \param count - number of strings
+ * \param values - receives count results, nullopt where a text is not a valid datetime
+ * \returns number of values decoded
+ */
+inline std::size_t ParseDateTimes(const std::wstring_view* texts, const std::size_t count,
+                                  std::optional<std::chrono::system_clock::time_point>* values) {
+    std::size_t decoded = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        values[i] = detail::ToTimePoint(texts[i]);
+        decoded += values[i] ? 1 : 0;
+    }
+    return decoded;
+}
+
+}  // namespace wmi
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <wmi/common.hxx>
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+namespace wmi {
+
+namespace detail {
+
+/**
+ * fnv-1a over the ascii-lowercased name, names equal under EqualsIgnoreCase hash alike
+ */
+[[nodiscard]] constexpr std::uint64_t HashName(const std::wstring_view name) noexcept {
+    constexpr std::uint64_t OFFSET_BASIS = 14695981039346656037ull;
+    constexpr std::uint64_t PRIME = 1099511628211ull;
+
+    std::uint64_t hash = OFFSET_BASIS;
+    for (auto ch : name) {
+        if (ch >= L'A' && ch <= L'Z') {
+            ch = static_cast<wchar_t>(ch - L'A' + L'a');
+        }
+        hash = (hash ^ static_cast<std::uint64_t>(ch)) * PRIME;
+    }
+    return hash;
+}
+
+/**
+ * length of the text of a character array, up to its first null or the last element
+ */
+[[nodiscard]] constexpr std::size_t TerminatedLength(const wchar_t* text,
+                                                     const std::size_t size) noexcept {
+    std::size_t length = 0;
+    while (length + 1 < size && text[length] != L'\0') {
+        ++length;
+    }
+    return length;
+}
+
+/**
+ * keeps one copy of a name built at runtime for the rest of the process
+ * \returns stable, null-terminated view of the copy
+ */
+[[nodiscard]] inline std::wstring_view InternName(const std::wstring_view name) {
+    static std::mutex mutex;
+    static std::unordered_set<std::wstring> names;
+
+    const std::lock_guard lock(mutex);
+    return *names.emplace(name).first;
+}
+
+}  // namespace detail
+
+/**
+ * property name token, built once and reused for every row and query
+ * literals are taken as they are at compile time, other names are interned once; either way the
+ * text is null-terminated, never copied again and carries a precomputed hash
+ *     static constexpr wmi::PropertyName SIZE(L"Size");
+ */
+class PropertyName {
+   public:
+    /**
+     * the name ends at the first null character, so a literal with an embedded null or a
+     * larger array holding a shorter name does not pick up the characters past it
+     * \param literal - string literal, or a null-terminated const array with static storage;
+     *                  the text is referenced, not copied, and must outlive every use of the name
+     */
+    template <std::size_t N>
+    explicit constexpr PropertyName(const wchar_t (&literal)[N]) noexcept
+        : text_(literal, detail::TerminatedLength(literal, N)), hash_(detail::HashName(text_)) {}
+
+    /**
+     * mutable buffers are usually locals about to be reused or destroyed, intern them instead
+     * through PropertyName(std::wstring_view(buffer))
+     */
+    template <std::size_t N>
+    explicit PropertyName(wchar_t (&buffer)[N]) = delete;
+
+    /**
+     * \param name - name built at runtime, interned the first time it is seen
+     */
+    explicit PropertyName(const std::wstring_view name)
+        : text_(detail::InternName(name)), hash_(detail::HashName(text_)) {}
+
+    [[nodiscard]] constexpr std::wstring_view View() const noexcept { return text_; }
+
+    /**
+     * null-terminated text, passed to com as it is
+     */
+    [[nodiscard]] constexpr const wchar_t* CStr() const noexcept { return text_.data(); }
+
+    [[nodiscard]] constexpr std::uint64_t Hash() const noexcept { return hash_; }
+
+    /**
+     * case-insensitive comparison, the hashes rule most mismatches out without reading the text
+     */
+    [[nodiscard]] constexpr bool operator==(const PropertyName& other) const noexcept {
+        return hash_ == other.hash_ && EqualsIgnoreCase(text_, other.text_);
+    }
+
+    [[nodiscard]] constexpr bool operator!=(const PropertyName& other) const noexcept {
+        return !(*this == other);
+    }
+
+   private:
+    std::wstring_view text_;
+    std::uint64_t hash_;
+};
+
+}  // namespace wmi
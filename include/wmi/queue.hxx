@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <utility>
+
+namespace wmi {
+
+/**
+ * bounded lock-free multi-producer multi-consumer queue
+ * every slot carries a sequence number telling producers and consumers whose turn it is,
+ * so neither side ever takes a lock (vyukov's array queue)
+ * \tparam T - element type, must be default constructible and move assignable
+ */
+template <typename T>
+class BoundedQueue {
+   public:
+    /**
+     * \param capacity - maximum number of queued elements, rounded up to a power of two
+     */
+    explicit BoundedQueue(std::size_t capacity) {
+        std::size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        mask_ = size - 1;
+        slots_ = std::make_unique<Slot[]>(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    /**
+     * appends an element unless the queue is full
+     * \param value - element, left untouched when the push fails
+     * \returns true if the element was queued
+     */
+    [[nodiscard]] bool TryPush(T& value) {
+        auto position = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            auto& slot = slots_[position & mask_];
+            const auto sequence = slot.sequence.load(std::memory_order_acquire);
+            const auto difference =
+                static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+            if (difference == 0) {
+                if (tail_.compare_exchange_weak(position, position + 1,
+                                                std::memory_order_relaxed)) {
+                    slot.value = std::move(value);
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * removes the oldest element
+     * \returns the element, nullopt if the queue is empty
+     */
+    [[nodiscard]] std::optional<T> TryPop() {
+        auto position = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            auto& slot = slots_[position & mask_];
+            const auto sequence = slot.sequence.load(std::memory_order_acquire);
+            const auto difference =
+                static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+            if (difference == 0) {
+                if (head_.compare_exchange_weak(position, position + 1,
+                                                std::memory_order_relaxed)) {
+                    std::optional<T> value(std::move(slot.value));
+                    slot.value = T();
+                    slot.sequence.store(position + mask_ + 1, std::memory_order_release);
+                    return value;
+                }
+            } else if (difference < 0) {
+                return std::nullopt;
+            } else {
+                position = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    [[nodiscard]] std::size_t Capacity() const noexcept { return mask_ + 1; }
+
+    /**
+     * approximate number of queued elements, exact only while nobody pushes or pops
+     */
+    [[nodiscard]] std::size_t SizeApprox() const noexcept {
+        const auto tail = tail_.load(std::memory_order_relaxed);
+        const auto head = head_.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+   private:
+    // producers and consumers hammer different counters, keep them on separate cache lines
+    static constexpr std::size_t CACHE_LINE = 64;
+
+    struct Slot {
+        std::atomic<std::size_t> sequence{0};
+        T value{};
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    std::size_t mask_ = 0;
+    alignas(CACHE_LINE) std::atomic<std::size_t> head_{0};
+    alignas(CACHE_LINE) std::atomic<std::size_t> tail_{0};
+};
+
+}  // namespace wmi
@@ -0,0 +1,347 @@
+#pragma once
+
+#include <wmi/batch.hxx>
+#include <wmi/wmi.hxx>
+#include <wmi/wql.hxx>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace wmi {
+
+namespace detail {
+
+/**
+ * row of a range sub-query without the key property the executor added to its select list
+ */
+class KeyHidingRow final : public Row {
+   public:
+    KeyHidingRow(RowPtr row, std::wstring key) : row_(std::move(row)), key_(std::move(key)) {}
+
+    [[nodiscard]] const Variant* Find(const std::wstring_view name) const override {
+        return Hidden(name) ? nullptr : row_->Find(name);
+    }
+
+    [[nodiscard]] const Variant* FindName(const PropertyName& name) const override {
+        return Hidden(name.View()) ? nullptr : row_->FindName(name);
+    }
+
+    void Enumerate(
+        const std::function<void(std::wstring_view, const Variant&)>& visitor) const override {
+        row_->Enumerate([this, &visitor](const std::wstring_view name, const Variant& value) {
+            if (!Hidden(name)) {
+                visitor(name, value);
+            }
+        });
+    }
+
+    std::size_t FindAll(const std::wstring_view* names, const std::size_t count,
+                        const Variant** values) const override {
+        auto found = row_->FindAll(names, count, values);
+        for (std::size_t i = 0; i < count; ++i) {
+            if (values[i] && Hidden(names[i])) {
+                values[i] = nullptr;
+                --found;
+            }
+        }
+        return found;
+    }
+
+    [[nodiscard]] PropertyHandle Resolve(const std::wstring_view name) const override {
+        return Hidden(name) ? Row::Resolve(name) : row_->Resolve(name);
+    }
+
+    [[nodiscard]] const void* Layout() const noexcept override { return row_->Layout(); }
+
+    [[nodiscard]] const Variant* Read(const PropertyHandle& handle) const override {
+        return Hidden(handle.name) ? nullptr : row_->Read(handle);
+    }
+
+   private:
+    [[nodiscard]] bool Hidden(const std::wstring_view name) const noexcept {
+        return EqualsIgnoreCase(name, key_);
+    }
+
+    RowPtr row_;
+    std::wstring key_;
+};
+
+}  // namespace detail
+
+struct ShardOptions {
+    static constexpr std::size_t DEFAULT_SHARDS = 4;
+
+    // false runs the query as a whole, for comparing against the sharded run
+    bool enabled = true;
+    // integer property the ranges are cut on, e.g. ProcessId or Handle
+    std::wstring key;
+    std::size_t shards = DEFAULT_SHARDS;
+    // batching, deadline and cancellation of every sub-query
+    QueryOptions query_options;
+};
+
+struct ShardStats {
+    // false when sharding was disabled or the key did not allow it, the query then ran whole
+    bool sharded = false;
+    // time of the key-only pre-scan picking the ranges
+    std::chrono::nanoseconds prescan_time{0};
+    // wall time of the whole call, pre-scan included
+    std::chrono::nanoseconds total_time{0};
+    // per sub-query, in key order
+    std::vector<std::chrono::nanoseconds> shard_times;
+    std::vector<std::size_t> shard_rows;
+};
+
+struct ShardedResult {
+    std::vector<Object> objects;
+    ShardStats stats;
+};
+
+/**
+ * enumerates one large class as several key-range sub-queries running side by side
+ * a key-only pre-scan picks ranges holding about the same number of objects, every range runs
+ * as "WHERE <condition> AND key >= a AND key < b" on one of the connections, and the results are
+ * concatenated in key order; the outer ranges are open so objects created after the pre-scan
+ * are not lost
+ */
+class ShardedExecutor {
+   public:
+    /**
+     * \param connections - interfaces the sub-queries are spread over, at least one
+     * \param workers_per_connection - sub-queries in flight on each connection
+     */
+    explicit ShardedExecutor(std::vector<std::shared_ptr<const Interface>> connections,
+                             const std::size_t workers_per_connection = Batch::DEFAULT_WORKERS) {
+        if (connections.empty()) {
+            throw Exception("Cannot shard queries without a connection");
+        }
+        batches_.reserve(connections.size());
+        for (const auto& connection : connections) {
+            batches_.push_back(std::make_unique<Batch>(connection, workers_per_connection));
+        }
+        connections_ = std::move(connections);
+    }
+
+    /**
+     * \param iface - single connection all sub-queries share
+     * \param workers - sub-queries in flight
+     */
+    explicit ShardedExecutor(std::shared_ptr<const Interface> iface,
+                             const std::size_t workers = Batch::DEFAULT_WORKERS)
+        : ShardedExecutor(std::vector<std::shared_ptr<const Interface>>{std::move(iface)},
+                          workers) {}
+
+    /**
+     * runs a query, sharded on options.key unless disabled
+     * falls back to a single query when the text cannot be parsed, the key is not an integer
+     * or there are too few objects to split, and reruns it as a single query when a shard
+     * returns objects outside its key range because the provider ignored the condition
+     * \param query - wql query text
+     * \param options - key, number of shards and per sub-query options
+     * \returns every object of the query, in key-range order when sharded
+     * \throws Exception if the query or one of the sub-queries fails
+     */
+    [[nodiscard]] ShardedResult Execute(const std::wstring_view query,
+                                        const ShardOptions& options) {
+        const auto start = std::chrono::steady_clock::now();
+        ShardedResult result;
+
+        const auto parsed = ParseWql(query);
+        std::vector<std::int64_t> bounds;
+        if (options.enabled && options.shards > 1 && !options.key.empty() && parsed) {
+            const auto prescan_start = std::chrono::steady_clock::now();
+            bounds = PickBounds(*parsed, options);
+            result.stats.prescan_time = std::chrono::steady_clock::now() - prescan_start;
+        }
+
+        if (bounds.empty()) {
+            auto whole = Run(0, std::wstring(query), options.query_options).get();
+            result.objects = std::move(whole.objects);
+            result.stats.shard_times.push_back(whole.elapsed);
+            result.stats.shard_rows.push_back(result.objects.size());
+            result.stats.total_time = std::chrono::steady_clock::now() - start;
+            return result;
+        }
+
+        result.stats.sharded = true;
+        std::vector<std::future<BatchResult>> shards;
+        shards.reserve(bounds.size() + 1);
+        for (std::size_t i = 0; i <= bounds.size(); ++i) {
+            const auto range = Range(bounds, i);
+            shards.push_back(Run(i, RangeQuery(*parsed, options.key, range.first, range.second),
+                                 options.query_options));
+        }
+        // every sub-query selects the key so its range can be verified, see RangeQuery
+        const bool hide_key = !Selects(*parsed, options.key);
+
+        // wait for every shard before reporting the first failure
+        std::exception_ptr error;
+        bool filtered = true;
+        for (std::size_t i = 0; i < shards.size(); ++i) {
+            try {
+                auto part = shards[i].get();
+                // a provider ignoring the range condition would hand every shard every object,
+                // an object without a readable key cannot be shown to be in range either
+                const auto range = Range(bounds, i);
+                filtered = filtered && std::all_of(part.objects.begin(), part.objects.end(),
+                                                   [&options, &range](const Object& object) {
+                                                       return InRange(Key(object, options.key),
+                                                                      range);
+                                                   });
+                if (hide_key) {
+                    for (auto& object : part.objects) {
+                        object.row_ = std::make_shared<detail::KeyHidingRow>(
+                            std::move(object.row_), options.key);
+                    }
+                }
+                result.stats.shard_times.push_back(part.elapsed);
+                result.stats.shard_rows.push_back(part.objects.size());
+                result.objects.insert(result.objects.end(),
+                                      std::make_move_iterator(part.objects.begin()),
+                                      std::make_move_iterator(part.objects.end()));
+            } catch (...) {
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        if (!filtered) {
+            // run it whole rather than return duplicates
+            auto whole = Run(0, std::wstring(query), options.query_options).get();
+            result.objects = std::move(whole.objects);
+            result.stats.sharded = false;
+            result.stats.shard_times.assign(1, whole.elapsed);
+            result.stats.shard_rows.assign(1, result.objects.size());
+        }
+
+        result.stats.total_time = std::chrono::steady_clock::now() - start;
+        return result;
+    }
+
+    [[nodiscard]] std::size_t Connections() const noexcept { return connections_.size(); }
+
+   private:
+    std::future<BatchResult> Run(const std::size_t shard, const std::wstring& query,
+                                 const QueryOptions& options) {
+        return batches_[shard % batches_.size()]->Add(query, options);
+    }
+
+    /**
+     * reads every key and cuts the sorted list into ranges of about the same size
+     * \returns lower bounds of the second and later ranges, empty if sharding does not apply
+     */
+    [[nodiscard]] std::vector<std::int64_t> PickBounds(const WqlQuery& parsed,
+                                                       const ShardOptions& options) const {
+        WqlQuery prescan = parsed;
+        prescan.properties = {options.key};
+
+        std::vector<std::int64_t> keys;
+        for (const auto& object : connections_.front()->ExecuteQuery(FormatWql(prescan))) {
+            const auto key = Key(object, options.key);
+            if (!key) {
+                return {};
+            }
+            keys.push_back(*key);
+        }
+
+        std::sort(keys.begin(), keys.end());
+        const auto shards = std::min(options.shards, keys.size());
+        std::vector<std::int64_t> bounds;
+        for (std::size_t i = 1; i < shards; ++i) {
+            const auto bound = keys[i * keys.size() / shards];
+            // duplicate keys can collapse neighbouring ranges
+            if (bound > keys.front() && (bounds.empty() || bound > bounds.back())) {
+                bounds.push_back(bound);
+            }
+        }
+        return bounds;
+    }
+
+    /**
+     * key of an object as a signed integer
+     * \returns nullopt if the key is missing, not an integer or out of range of std::int64_t
+     */
+    [[nodiscard]] static std::optional<std::int64_t> Key(const Object& object,
+                                                         const std::wstring& key) {
+        const auto value = object.GetProperty(key);
+        const auto number = value ? detail::ToWqlNumber(*value) : std::nullopt;
+        if (!number || number->kind == detail::WqlNumber::Kind::Real ||
+            (number->kind == detail::WqlNumber::Kind::Unsigned &&
+             number->unsigned_value >
+                 static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max()))) {
+            return std::nullopt;
+        }
+        return number->kind == detail::WqlNumber::Kind::Signed
+                   ? number->signed_value
+                   : static_cast<std::int64_t>(number->unsigned_value);
+    }
+
+    using KeyRange = std::pair<std::optional<std::int64_t>, std::optional<std::int64_t>>;
+
+    /**
+     * key range of a shard, the first and the last are open
+     * \returns inclusive lower and exclusive upper bound
+     */
+    [[nodiscard]] static KeyRange Range(const std::vector<std::int64_t>& bounds,
+                                        const std::size_t shard) {
+        return {shard == 0 ? std::nullopt : std::optional<std::int64_t>(bounds[shard - 1]),
+                shard == bounds.size() ? std::nullopt : std::optional<std::int64_t>(bounds[shard])};
+    }
+
+    [[nodiscard]] static bool InRange(const std::optional<std::int64_t> key,
+                                      const KeyRange& range) noexcept {
+        return key && (!range.first || *key >= *range.first) &&
+               (!range.second || *key < *range.second);
+    }
+
+    /**
+     * whether the objects of a query carry the key, SELECT * included
+     */
+    [[nodiscard]] static bool Selects(const WqlQuery& parsed, const std::wstring& key) {
+        return parsed.properties.empty() ||
+               std::any_of(parsed.properties.begin(), parsed.properties.end(),
+                           [&key](const std::wstring& property) {
+                               return EqualsIgnoreCase(property, key);
+                           });
+    }
+
+    /**
+     * sub-query of one key range, the key is added to the select list when it is missing
+     */
+    [[nodiscard]] static std::wstring RangeQuery(WqlQuery parsed, const std::wstring& key,
+                                                 const std::optional<std::int64_t> low,
+                                                 const std::optional<std::int64_t> high) {
+        if (!Selects(parsed, key)) {
+            parsed.properties.push_back(key);
+        }
+        std::wstring range;
+        if (low) {
+            range = key + L" >= " + std::to_wstring(*low);
+        }
+        if (high) {
+            range += (range.empty() ? L"" : L" AND ") + key + L" < " + std::to_wstring(*high);
+        }
+        parsed.where = parsed.where.empty() ? range : L"(" + parsed.where + L") AND " + range;
+        return FormatWql(parsed);
+    }
+
+    std::vector<std::shared_ptr<const Interface>> connections_;
+    std::vector<std::unique_ptr<Batch>> batches_;
+};
+
+}  // namespace wmi
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace wmi {
+
+/**
+ * small fixed-size pool of worker threads
+ * used by providers that fan work out and by the multi-query executors
+ */
+class ThreadPool {
+   public:
+    explicit ThreadPool(std::size_t size = std::max(1u, std::thread::hardware_concurrency())) {
+        workers_.reserve(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            workers_.emplace_back([this] { Work(); });
+        }
+    }
+
+    ~ThreadPool() noexcept {
+        {
+            const std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ThreadPool(ThreadPool&&) = delete;
+    ThreadPool& operator=(ThreadPool&&) = delete;
+
+    /**
+     * queues a task for the next idle worker
+     * \param task - work item, must not throw
+     */
+    void Submit(std::function<void()> task) {
+        {
+            const std::lock_guard lock(mutex_);
+            tasks_.push_back(std::move(task));
+        }
+        wake_.notify_one();
+    }
+
+    [[nodiscard]] std::size_t Size() const noexcept { return workers_.size(); }
+
+    /**
+     * runs body(i) for every i in [0, count) on the pool and the calling thread
+     * returns once every index has been processed
+     * \param count - number of indices
+     * \param body - callable taking the index, must not throw
+     */
+    template <typename Body>
+    void ParallelFor(const std::size_t count, Body&& body) {
+        if (count == 0) {
+            return;
+        }
+
+        struct State {
+            std::atomic<std::size_t> next{0};
+            std::size_t pending = 0;
+            std::mutex mutex;
+            std::condition_variable done;
+        } state;
+
+        const auto drain = [&state, &body, count] {
+            for (auto i = state.next.fetch_add(1); i < count; i = state.next.fetch_add(1)) {
+                body(i);
+            }
+        };
+
+        const auto helpers = std::min(workers_.size(), count - 1);
+        state.pending = helpers;
+        for (std::size_t i = 0; i < helpers; ++i) {
+            Submit([&state, &drain] {
+                drain();
+                const std::lock_guard lock(state.mutex);
+                if (--state.pending == 0) {
+                    state.done.notify_one();
+                }
+            });
+        }
+
+        drain();
+
+        std::unique_lock lock(state.mutex);
+        state.done.wait(lock, [&state] { return state.pending == 0; });
+    }
+
+   private:
+    void Work() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock lock(mutex_);
+                wake_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+                if (tasks_.empty()) {
+                    return;
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+};
+
+}  // namespace wmi
@@ -0,0 +1,481 @@
+#pragma once
+
+#include <wmi/common.hxx>
+#include <wmi/datetime.hxx>
+
+#ifdef _WIN32
+#include <oleauto.h>
+#endif
+
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cwchar>
+#include <iostream>
+#include <limits>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace wmi {
+
+/**
+ * owning, null-terminated wide string used for every string value a backend hands out
+ * on windows it wraps a bstr so the com backend can adopt provider strings without copying
+ * on other platforms it is a plain std::wstring
+ */
+class WideString {
+   public:
+    WideString() noexcept = default;
+
+    explicit WideString(const std::wstring_view text)
+#ifdef _WIN32
+        : bstr_(SysAllocStringLen(text.data(), static_cast<UINT>(text.size()))) {
+        if (!bstr_) {
+            throw std::bad_alloc();
+        }
+    }
+#else
+        : text_(text) {
+    }
+#endif
+
+    /**
+     * allocates a string of the given length and lets the caller fill it in place
+     * avoids a temporary when converting from another encoding
+     * \param length - number of characters
+     * \param fill - callable receiving a writable wchar_t* of length characters
+     * \returns the filled string
+     */
+    template <typename Fill>
+    [[nodiscard]] static WideString Build(const std::size_t length, Fill&& fill) {
+        WideString result;
+#ifdef _WIN32
+        result.bstr_ = SysAllocStringLen(nullptr, static_cast<UINT>(length));
+        if (!result.bstr_) {
+            throw std::bad_alloc();
+        }
+        fill(result.bstr_);
+#else
+        result.text_.resize(length);
+        fill(result.text_.data());
+#endif
+        return result;
+    }
+
+#ifdef _WIN32
+    /**
+     * takes ownership of a bstr allocated by the provider
+     * \param bstr - string to adopt, freed with SysFreeString when this object dies
+     * \returns wide string owning the bstr
+     */
+    [[nodiscard]] static WideString Attach(BSTR bstr) noexcept {
+        WideString result;
+        result.bstr_ = bstr;
+        return result;
+    }
+
+    ~WideString() noexcept { SysFreeString(bstr_); }
+
+    WideString(const WideString& other) : WideString(other.View()) {}
+
+    WideString& operator=(const WideString& other) {
+        if (this != &other) {
+            WideString copy(other);
+            std::swap(bstr_, copy.bstr_);
+        }
+        return *this;
+    }
+
+    WideString(WideString&& other) noexcept : bstr_(std::exchange(other.bstr_, nullptr)) {}
+
+    WideString& operator=(WideString&& other) noexcept {
+        std::swap(bstr_, other.bstr_);
+        return *this;
+    }
+
+    [[nodiscard]] std::wstring_view View() const noexcept {
+        return bstr_ ? std::wstring_view(bstr_, SysStringLen(bstr_)) : std::wstring_view();
+    }
+
+    [[nodiscard]] const wchar_t* CStr() const noexcept { return bstr_ ? bstr_ : L""; }
+#else
+    [[nodiscard]] std::wstring_view View() const noexcept { return text_; }
+
+    [[nodiscard]] const wchar_t* CStr() const noexcept { return text_.c_str(); }
+#endif
+
+   private:
+#ifdef _WIN32
+    BSTR bstr_ = nullptr;
+#else
+    std::wstring text_;
+#endif
+};
+
+/**
+ * portable value of a single wmi property
+ * covers the shapes wmi hands out (null, boolean, integers, reals, strings, string arrays)
+ * without tying the library to com variants
+ */
+class Variant {
+   public:
+    enum class Type : std::uint8_t { Empty, Boolean, Signed, Unsigned, Real, String, StringArray };
+
+    Variant() noexcept = default;
+
+    Variant(const bool value) : value_(value) {}
+
+    template <typename T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool> &&
+                                               !std::is_same_v<T, wchar_t>,
+                                           int> = 0>
+    Variant(const T value) {
+        if constexpr (std::is_signed_v<T>) {
+            value_ = static_cast<std::int64_t>(value);
+        } else {
+            value_ = static_cast<std::uint64_t>(value);
+        }
+    }
+
+    Variant(const double value) : value_(value) {}
+
+    Variant(WideString value) : value_(std::move(value)) {}
+
+    Variant(const std::wstring_view value) : value_(WideString(value)) {}
+
+    Variant(const wchar_t* value) : value_(WideString(value)) {}
+
+    Variant(std::vector<WideString> value) : value_(std::move(value)) {}
+
+    [[nodiscard]] Type GetType() const noexcept { return static_cast<Type>(value_.index()); }
+
+    [[nodiscard]] bool IsEmpty() const noexcept { return GetType() == Type::Empty; }
+
+    /**
+     * typed access to the stored alternative
+     * \tparam T - one of bool, std::int64_t, std::uint64_t, double, WideString, std::vector<WideString>
+     * \returns pointer to the value, nullptr if another alternative is stored
+     */
+    template <typename T>
+    [[nodiscard]] const T* GetIf() const noexcept {
+        return std::get_if<T>(&value_);
+    }
+
+   private:
+    std::variant<std::monostate, bool, std::int64_t, std::uint64_t, double, WideString,
+                 std::vector<WideString>>
+        value_;
+};
+
+namespace detail {
+
+/**
+ * reports a failed conversion the same way for every target type
+ */
+inline void ReportConversionFailure(const char* reason) {
+    std::cerr << "ConvertVariant failed: " << reason << std::endl;
+}
+
+/**
+ * formats a numeric alternative as text
+ */
+[[nodiscard]] inline std::optional<std::wstring> FormatNumber(const Variant& variant) {
+    if (const auto* value = variant.GetIf<bool>()) {
+        return std::wstring(*value ? L"True" : L"False");
+    }
+    if (const auto* value = variant.GetIf<std::int64_t>()) {
+        return std::to_wstring(*value);
+    }
+    if (const auto* value = variant.GetIf<std::uint64_t>()) {
+        return std::to_wstring(*value);
+    }
+    if (const auto* value = variant.GetIf<double>()) {
+        wchar_t buffer[32];
+        std::swprintf(buffer, sizeof(buffer) / sizeof(buffer[0]), L"%.15g", *value);
+        return std::wstring(buffer);
+    }
+    return std::nullopt;
+}
+
+/**
+ * outcome of parsing the text of an integer property
+ */
+enum class ParseStatus : std::uint8_t { Ok, Invalid, Overflow };
+
+/**
+ * parses an optionally signed run of decimal digits straight from the utf-16 text
+ * no allocation, no locale and no errno: the first 19 digits cannot overflow a 64-bit
+ * accumulator and are summed with a single validity check at the end, only the digits
+ * after them take the checked path
+ * \param text - digits with an optional leading sign and nothing else
+ * \param value - receives the parsed number on success
+ * \returns ParseStatus::Ok, Invalid when the text is not an integer, Overflow when it is
+ *          out of range of T
+ */
+template <typename T>
+[[nodiscard]] constexpr ParseStatus ParseInteger(std::wstring_view text, T& value) noexcept {
+    static_assert(std::is_integral_v<T> && sizeof(T) <= sizeof(std::uint64_t));
+    constexpr std::size_t UNCHECKED_DIGITS = 19;
+    constexpr auto ZERO = static_cast<std::uint32_t>(L'0');
+
+    bool negative = false;
+    if (!text.empty() && (text.front() == L'-' || text.front() == L'+')) {
+        negative = text.front() == L'-';
+        text.remove_prefix(1);
+    }
+    if (text.empty()) {
+        return ParseStatus::Invalid;
+    }
+    // leading zeros do not use up the unchecked digits
+    while (text.size() > 1 && text.front() == L'0') {
+        text.remove_prefix(1);
+    }
+
+    std::uint64_t magnitude = 0;
+    std::uint32_t invalid = 0;
+    const auto unchecked = text.size() < UNCHECKED_DIGITS ? text.size() : UNCHECKED_DIGITS;
+    for (std::size_t i = 0; i < unchecked; ++i) {
+        const auto digit = static_cast<std::uint32_t>(text[i]) - ZERO;
+        invalid |= static_cast<std::uint32_t>(digit > 9);
+        magnitude = magnitude * 10 + digit;
+    }
+    if (invalid != 0) {
+        return ParseStatus::Invalid;
+    }
+
+    bool overflow = false;
+    for (std::size_t i = unchecked; i < text.size(); ++i) {
+        const auto digit = static_cast<std::uint32_t>(text[i]) - ZERO;
+        if (digit > 9) {
+            return ParseStatus::Invalid;
+        }
+        if (overflow || magnitude > (std::numeric_limits<std::uint64_t>::max() - digit) / 10) {
+            // keep going so trailing garbage is still reported as invalid
+            overflow = true;
+        } else {
+            magnitude = magnitude * 10 + digit;
+        }
+    }
+    if (overflow) {
+        return ParseStatus::Overflow;
+    }
+
+    if constexpr (std::is_signed_v<T>) {
+        constexpr auto MAXIMUM = static_cast<std::uint64_t>(std::numeric_limits<T>::max());
+        if (magnitude > MAXIMUM + (negative ? 1 : 0)) {
+            return ParseStatus::Overflow;
+        }
+        // negate in the signed domain without overflowing at the minimum
+        value = negative && magnitude != 0
+                    ? static_cast<T>(-static_cast<std::int64_t>(magnitude - 1) - 1)
+                    : static_cast<T>(magnitude);
+    } else {
+        if ((negative && magnitude != 0) || magnitude > std::numeric_limits<T>::max()) {
+            return ParseStatus::Overflow;
+        }
+        value = static_cast<T>(magnitude);
+    }
+    return ParseStatus::Ok;
+}
+
+/**
+ * range-checked cast between numeric alternatives
+ */
+template <typename T, typename U>
+[[nodiscard]] std::optional<T> CastNumber(const U value) {
+    if constexpr (std::is_floating_point_v<T>) {
+        if constexpr (std::is_floating_point_v<U> && sizeof(T) < sizeof(U)) {
+            if (std::isfinite(value) && std::fabs(value) > std::numeric_limits<T>::max()) {
+                return std::nullopt;
+            }
+        }
+        return static_cast<T>(value);
+    } else if constexpr (std::is_floating_point_v<U>) {
+        // the cast truncates toward zero and is undefined unless the result fits T,
+        // 2^digits is exact in U so the upper bound needs no rounding
+        constexpr U UPPER = static_cast<U>(std::numeric_limits<T>::max() / 2 + 1) * 2;
+        const auto whole = std::trunc(value);
+        if (!(whole >= static_cast<U>(std::numeric_limits<T>::min()) && whole < UPPER)) {
+            return std::nullopt;
+        }
+        return static_cast<T>(whole);
+    } else if constexpr (std::is_signed_v<U> && !std::is_signed_v<T>) {
+        if (value < 0 ||
+            static_cast<std::make_unsigned_t<U>>(value) > std::numeric_limits<T>::max()) {
+            return std::nullopt;
+        }
+        return static_cast<T>(value);
+    } else if constexpr (!std::is_signed_v<U> && std::is_signed_v<T>) {
+        if (value > static_cast<std::make_unsigned_t<T>>(std::numeric_limits<T>::max())) {
+            return std::nullopt;
+        }
+        return static_cast<T>(value);
+    } else {
+        if (value < std::numeric_limits<T>::min() || value > std::numeric_limits<T>::max()) {
+            return std::nullopt;
+        }
+        return static_cast<T>(value);
+    }
+}
+
+/**
+ * parses a numeric string into an arithmetic type
+ * \returns parsed value, nullopt when the text is not a number or does not fit
+ */
+template <typename T>
+[[nodiscard]] std::optional<T> ParseNumber(const WideString& text) {
+    if constexpr (std::is_floating_point_v<T>) {
+        const wchar_t* begin = text.CStr();
+        wchar_t* end = nullptr;
+        errno = 0;
+        const auto value = std::wcstod(begin, &end);
+        if (end == begin || *end != L'\0' || errno == ERANGE) {
+            return std::nullopt;
+        }
+        return CastNumber<T>(value);
+    } else {
+        T value{};
+        if (ParseInteger(text.View(), value) != ParseStatus::Ok) {
+            return std::nullopt;
+        }
+        return value;
+    }
+}
+
+template <typename T>
+struct IsVector : std::false_type {};
+
+template <typename T>
+struct IsVector<std::vector<T>> : std::true_type {};
+
+}  // namespace detail
+
+/**
+ * generic converter for variants to c++ types with comprehensive error handling
+ * follows the coercion rules of VariantChangeType: numbers and strings convert into each other
+ * cim datetime strings convert to std::chrono::system_clock::time_point and Interval
+ * \tparam T - target c++ type for conversion
+ * \param variant - variant to convert from
+ * \returns optional containing converted value or nullopt on failure
+ */
+template <typename T>
+[[nodiscard]] std::optional<T> ConvertVariant(const Variant& variant) {
+    if (variant.IsEmpty()) {
+        return std::nullopt;
+    }
+
+    if constexpr (std::is_same_v<T, bool>) {
+        if (const auto* value = variant.GetIf<bool>()) {
+            return *value;
+        }
+        if (const auto* value = variant.GetIf<WideString>()) {
+            if (EqualsIgnoreCase(value->View(), L"true")) {
+                return true;
+            }
+            if (EqualsIgnoreCase(value->View(), L"false")) {
+                return false;
+            }
+        }
+        if (const auto* value = variant.GetIf<std::int64_t>()) {
+            return *value != 0;
+        }
+        if (const auto* value = variant.GetIf<std::uint64_t>()) {
+            return *value != 0;
+        }
+        detail::ReportConversionFailure("value is not a boolean");
+        return std::nullopt;
+    } else if constexpr (std::is_arithmetic_v<T>) {
+        std::optional<T> result;
+        if (const auto* value = variant.GetIf<bool>()) {
+            result = static_cast<T>(*value ? 1 : 0);
+        } else if (const auto* value = variant.GetIf<std::int64_t>()) {
+            result = detail::CastNumber<T>(*value);
+        } else if (const auto* value = variant.GetIf<std::uint64_t>()) {
+            result = detail::CastNumber<T>(*value);
+        } else if (const auto* value = variant.GetIf<double>()) {
+            result = detail::CastNumber<T>(*value);
+        } else if (const auto* value = variant.GetIf<WideString>()) {
+            if constexpr (std::is_integral_v<T>) {
+                // 64-bit integers arrive as strings, parsed in place without a copy
+                T parsed{};
+                const auto parse_status = detail::ParseInteger(value->View(), parsed);
+                if (parse_status == detail::ParseStatus::Overflow) {
+                    detail::ReportConversionFailure("number overflows the target type");
+                    return std::nullopt;
+                }
+                if (parse_status == detail::ParseStatus::Ok) {
+                    result = parsed;
+                }
+            } else {
+                result = detail::ParseNumber<T>(*value);
+            }
+        }
+        if (!result) {
+            detail::ReportConversionFailure("value is not a number in range of the target type");
+        }
+        return result;
+    } else if constexpr (std::is_same_v<T, std::chrono::system_clock::time_point>) {
+        if (const auto* value = variant.GetIf<WideString>()) {
+            if (auto time_point = detail::ToTimePoint(value->View())) {
+                return time_point;
+            }
+        }
+        detail::ReportConversionFailure("value is not a CIM datetime in range of the clock");
+        return std::nullopt;
+    } else if constexpr (std::is_same_v<T, Interval>) {
+        std::int64_t microseconds = 0;
+        if (const auto* value = variant.GetIf<WideString>()) {
+            if (detail::ParseInterval(value->View(), microseconds)) {
+                return Interval{std::chrono::microseconds(microseconds)};
+            }
+        }
+        detail::ReportConversionFailure("value is not a CIM interval");
+        return std::nullopt;
+    } else if constexpr (std::is_same_v<T, std::wstring>) {
+        if (const auto* value = variant.GetIf<WideString>()) {
+            return std::wstring(value->View());
+        }
+        return detail::FormatNumber(variant);
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        if (const auto* value = variant.GetIf<WideString>()) {
+            return NarrowString(value->View());
+        }
+        if (auto text = detail::FormatNumber(variant)) {
+            return NarrowString(*text);
+        }
+        return std::nullopt;
+    } else if constexpr (detail::IsVector<T>::value) {
+        using Element = typename T::value_type;
+        static_assert(std::is_same_v<Element, std::string> || std::is_same_v<Element, std::wstring>,
+                      "only string arrays are supported");
+
+        const auto* values = variant.GetIf<std::vector<WideString>>();
+        if (!values) {
+            // no array string
+            return std::nullopt;
+        }
+
+        T result;
+        result.reserve(values->size());
+        for (const auto& value : *values) {
+            if constexpr (std::is_same_v<Element, std::string>) {
+                result.emplace_back(NarrowString(value.View()));
+            } else {
+                result.emplace_back(value.View());
+            }
+        }
+        return result;
+    } else {
+        static_assert(!sizeof(T), "unsupported property type");
+    }
+}
+
+}  // namespace wmi
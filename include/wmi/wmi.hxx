@@ -9,221 +9,748 @@
 
 #pragma once
 
-#include <Wbemidl.h>
-#include <atlsafe.h>
-#include <comdef.h>
-
-#include <iostream>
+#include <wmi/backend.hxx>
+#include <wmi/binding.hxx>
+#include <wmi/cancellation.hxx>
+#include <wmi/common.hxx>
+#include <wmi/datetime.hxx>
+#include <wmi/property_name.hxx>
+#include <wmi/queue.hxx>
+#include <wmi/variant.hxx>
+#include <wmi/wql.hxx>
+
+#ifdef _WIN32
+#include <wmi/backend/com.hxx>
+#elif defined(__linux__)
+#include <wmi/backend/composite.hxx>
+#include <wmi/backend/meminfo.hxx>
+#include <wmi/backend/mountinfo.hxx>
+#include <wmi/backend/smbios.hxx>
+#include <wmi/backend/sysblock.hxx>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <initializer_list>
 #include <iterator>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
-#pragma comment(lib, "wbemuuid.lib")
-
 namespace wmi {
 
 class Interface;
+class PreparedQuery;
+class ShardedExecutor;
 
-/**
- * custom exception type for wmi operations that provides clear error context
- * wraps standard runtime_error to maintain compatibility while adding wmi-specific context
- */
-struct Exception final : std::runtime_error {
-    explicit Exception(const std::string& message) : std::runtime_error(message) {}
-};
-
-/**
- * formats hresult error codes into human-readable strings for debugging
- * combines operation description with hex error code for quick diagnosis
- * \param operation - description of what failed
- * \param hr - the hresult error code from windows api
- * \returns formatted error string with operation context
- */
-[[nodiscard]] inline std::string FormatHResultError(const std::string& operation, HRESULT hr) {
-    return operation + " (HRESULT: 0x" + std::to_string(static_cast<unsigned>(hr)) + ")";
-}
+namespace detail {
 
 /**
- * converts com variant containing bstr to standard string safely
- * handles null bstr values and type checking to prevent crashes
- * \param variant - com variant that may contain bstr data
- * \returns optional string if conversion succeeds, nullopt otherwise
+ * text of a string value as stored in the row
  */
-[[nodiscard]] inline std::optional<std::string> ConvertBstrToString(const CComVariant& variant) {
-    if (variant.vt == VT_BSTR && variant.bstrVal) {
-        return std::string(_com_util::ConvertBSTRToString(variant.bstrVal));
+[[nodiscard]] inline std::optional<std::wstring_view> ViewString(const Variant* variant) noexcept {
+    if (const auto* value = variant ? variant->GetIf<WideString>() : nullptr) {
+        return value->View();
     }
     return std::nullopt;
 }
 
+}  // namespace detail
+
 /**
- * manages com library initialization and cleanup using raii pattern
- * ensures proper com initialization on construction and cleanup on destruction
- * prevents resource leaks by automatically calling couninitialize when needed
+ * represents a single wmi object with property access capabilities
+ * provides type-safe property retrieval from wmi class instances
+ * manages underlying backend row lifecycle automatically
  */
-class COMInitializer {
+class Object {
+    friend class QueryResult;
+    friend class AsyncQuery;
+    friend class PreparedResult;
+    friend class ShardedExecutor;
+
+   protected:
+    Object(std::shared_ptr<const Interface> iface, RowPtr row)
+        : iface_(std::move(iface)), row_(std::move(row)) {}
+
    public:
-    explicit COMInitializer(DWORD threading_model = COINIT_MULTITHREADED) : initialized_(false) {
-        HRESULT hr = CoInitializeEx(nullptr, threading_model);
-        if (SUCCEEDED(hr)) {
-            initialized_ = true;
-        } else if (hr != RPC_E_CHANGED_MODE) {
-            // jgn dulu plis
-            throw Exception(FormatHResultError("Failed to initialize COM library", hr));
-        }
-
-        hr = CoInitializeSecurity(NULL, -1, NULL, NULL, RPC_C_AUTHN_LEVEL_DEFAULT,
-                                  RPC_C_IMP_LEVEL_IMPERSONATE, NULL, EOAC_NONE, NULL);
-
-        if (FAILED(hr) && hr != RPC_E_TOO_LATE) {
-            // YYYYYYYYY
-            if (initialized_) {
-                CoUninitialize();
-                initialized_ = false;
-            }
-            throw Exception(FormatHResultError("Failed to initialize COM security", hr));
+    /**
+     * retrieves a property value from the wmi object with type conversion
+     * automatically handles variant conversion to requested c++ type
+     * \tparam T - target type for property value (defaults to Variant)
+     * \param name - property name as wide string view
+     * \returns optional containing property value if available and convertible
+     */
+    template <typename T = Variant>
+    [[nodiscard]] std::optional<T> GetProperty(const std::wstring_view name) const {
+        const auto* variant = row_->Find(name);
+
+        if (!variant) {
+            return std::nullopt;
+        }
+
+        if constexpr (std::is_same_v<T, Variant>) {
+            return *variant;
+        } else {
+            return ConvertVariant<T>(*variant);
         }
     }
 
-    ~COMInitializer() noexcept {
-        if (initialized_) {
-            CoUninitialize();
+    /**
+     * retrieves a property through a prebuilt name token
+     * no copy of the name is made and cached lookups compare precomputed hashes
+     * \tparam T - target type for property value (defaults to Variant)
+     * \param name - property name token, typically a static constexpr PropertyName
+     * \returns optional containing property value if available and convertible
+     */
+    template <typename T = Variant>
+    [[nodiscard]] std::optional<T> GetProperty(const PropertyName& name) const {
+        const auto* variant = row_->FindName(name);
+
+        if (!variant) {
+            return std::nullopt;
+        }
+
+        if constexpr (std::is_same_v<T, Variant>) {
+            return *variant;
+        } else {
+            return ConvertVariant<T>(*variant);
         }
     }
 
-    COMInitializer(const COMInitializer&) = delete;
-    COMInitializer& operator=(const COMInitializer&) = delete;
-    COMInitializer(COMInitializer&&) = delete;
-    COMInitializer& operator=(COMInitializer&&) = delete;
+    /**
+     * borrows the text of a string property without copying or transcoding it
+     * on windows the view points into the bstr the provider returned
+     * \param name - property name as wide string view
+     * \returns view valid as long as this object or a copy of it, nullopt if the property is
+     *          missing, null or not a string
+     */
+    [[nodiscard]] std::optional<std::wstring_view> GetStringView(
+        const std::wstring_view name) const {
+        return detail::ViewString(row_->Find(name));
+    }
+
+    /**
+     * borrows the text of a string property through a prebuilt name token
+     * \param name - property name token, typically a static constexpr PropertyName
+     * \returns view valid as long as this object or a copy of it, nullopt if the property is
+     *          missing, null or not a string
+     */
+    [[nodiscard]] std::optional<std::wstring_view> GetStringView(const PropertyName& name) const {
+        return detail::ViewString(row_->FindName(name));
+    }
+
+    /**
+     * reads several properties in one pass over the object
+     * on windows this is a single property walk instead of one IWbemClassObject::Get per name
+     * \param names - property names
+     * \param count - number of names
+     * \param values - caller buffer, resized to count; receives pointers to the values, owned
+     *                 by the object and valid as long as it, nullptr for missing properties
+     * \returns number of names found
+     */
+    std::size_t GetProperties(const std::wstring_view* names, const std::size_t count,
+                              std::vector<const Variant*>& values) const {
+        values.resize(count);
+        return row_->FindAll(names, count, values.data());
+    }
+
+    /**
+     * reads several properties through prebuilt name tokens in one pass over the object
+     * on windows the walk compares the precomputed hashes before any text
+     * \param names - property name tokens, typically a static constexpr array of PropertyName
+     * \param count - number of names
+     * \param values - caller buffer, resized to count; receives pointers to the values, owned
+     *                 by the object and valid as long as it, nullptr for missing properties
+     * \returns number of names found
+     */
+    std::size_t GetProperties(const PropertyName* names, const std::size_t count,
+                              std::vector<const Variant*>& values) const {
+        values.resize(count);
+        return row_->FindAllNames(names, count, values.data());
+    }
+
+    std::size_t GetProperties(const std::vector<std::wstring_view>& names,
+                              std::vector<const Variant*>& values) const {
+        return GetProperties(names.data(), names.size(), values);
+    }
+
+    std::size_t GetProperties(const std::initializer_list<std::wstring_view> names,
+                              std::vector<const Variant*>& values) const {
+        return GetProperties(names.begin(), names.size(), values);
+    }
+
+    /**
+     * visits every non-system property of the object in one walk
+     * \param visitor - callable taking the property name as std::wstring_view and its value as
+     *                  const Variant&, both valid only during the call
+     */
+    template <typename Visitor>
+    void ForEachProperty(Visitor&& visitor) const {
+        row_->Enumerate([&visitor](const std::wstring_view name, const Variant& value) {
+            visitor(name, value);
+        });
+    }
+
+    /**
+     * resolves a property once for fast reads from every object of the same class
+     * resolve it on the first object of a result and pass it to Read for the others
+     * \param name - property name as wide string view
+     * \returns handle for Read, falling back to a name lookup where the backend has none
+     */
+    [[nodiscard]] PropertyHandle GetPropertyHandle(const std::wstring_view name) const {
+        return row_->Resolve(name);
+    }
+
+    /**
+     * reads a property through a handle, skipping the name lookup of GetProperty
+     * on windows numbers come straight from IWbemObjectAccess without a com variant
+     * \tparam T - target type for property value (defaults to Variant)
+     * \param handle - result of GetPropertyHandle on an object of the same class
+     * \returns optional containing property value if available and convertible
+     */
+    template <typename T = Variant>
+    [[nodiscard]] std::optional<T> Read(const PropertyHandle& handle) const {
+        const auto* variant = row_->Read(handle);
+
+        if (!variant) {
+            return std::nullopt;
+        }
 
-    [[nodiscard]] bool IsInitialized() const noexcept { return initialized_; }
+        if constexpr (std::is_same_v<T, Variant>) {
+            return *variant;
+        } else {
+            return ConvertVariant<T>(*variant);
+        }
+    }
 
    private:
-    bool initialized_;
+    std::shared_ptr<const Interface> iface_;
+    RowPtr row_;
 };
 
 /**
- * generic converter for com variants to c++ types with comprehensive error handling
- * handles type conversion failures gracefully and provides detailed error logging
- * \tparam T - target c++ type for conversion
- * \param variant - com variant to convert from
- * \returns optional containing converted value or nullopt on failure
+ * per-query tuning of how rows are pulled from the enumerator
  */
-template <typename T>
-[[nodiscard]] std::optional<T> ConvertVariant(const CComVariant& variant) {
-    try {
-        return static_cast<T>(variant_t(variant));
-    } catch (const _com_error& e) {
-        // error com
-        std::cerr << "ConvertVariant failed: COM error 0x" << std::hex << e.Error() << " - "
-                  << e.ErrorMessage() << std::endl;
-        return std::nullopt;
-    } catch (const std::exception& e) {
-        // error std
-        std::cerr << "ConvertVariant failed: " << e.what() << std::endl;
-        return std::nullopt;
-    } catch (...) {
-        // ga jelas njir
-        std::cerr << "ConvertVariant failed: Unknown error" << std::endl;
-        return std::nullopt;
+struct QueryOptions {
+    enum class BatchMode {
+        // every Next call asks for batch_size rows
+        Fixed,
+        // starts at batch_size, grows while full batches arrive within target_latency,
+        // shrinks when a call takes longer
+        Adaptive
+    };
+
+    static constexpr std::uint32_t DEFAULT_BATCH_SIZE = 10;
+
+    BatchMode batch_mode = BatchMode::Fixed;
+    std::uint32_t batch_size = DEFAULT_BATCH_SIZE;
+    std::uint32_t min_batch_size = 1;
+    std::uint32_t max_batch_size = 1024;
+    double growth = 2.0;
+    std::chrono::microseconds target_latency{10000};
+    // adaptive only: fetch the first batch at min_batch_size so the first row arrives sooner
+    bool fast_first_row = false;
+    // batches a worker thread fetches ahead while the caller works, 0 fetches on demand
+    std::size_t prefetch_depth = 0;
+    // iteration stops at the deadline or on cancellation, keeping the rows fetched so far
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    CancellationToken cancellation;
+    // longest a single Next call blocks while a deadline or cancellation token is set
+    std::chrono::milliseconds timeout_slice{100};
+    // keep the rows of the first pass in memory and replay them on later passes instead of
+    // resetting the enumerator, which a forward-only provider enumerator does not support
+    bool multi_pass = false;
+
+    [[nodiscard]] static QueryOptions Fixed(const std::uint32_t size) {
+        QueryOptions options;
+        options.batch_size = size;
+        return options;
     }
-}
+
+    [[nodiscard]] static QueryOptions Adaptive(const std::uint32_t initial = DEFAULT_BATCH_SIZE,
+                                               const std::uint32_t maximum = 1024) {
+        QueryOptions options;
+        options.batch_mode = BatchMode::Adaptive;
+        options.batch_size = initial;
+        options.max_batch_size = maximum;
+        return options;
+    }
+};
 
 /**
- * specialized converter for string variants using optimized bstr conversion
- * delegates to dedicated bstr converter for consistent string handling
- * \param variant - com variant expected to contain bstr data
- * \returns optional string if variant contains valid bstr data
+ * what one pass over a query result cost, for tuning QueryOptions
  */
-template <>
-[[nodiscard]] inline std::optional<std::string> ConvertVariant<std::string>(
-    const CComVariant& variant) {
-    return ConvertBstrToString(variant);
-}
+struct QueryStats {
+    // batch size requested by each Next round trip, in order
+    std::vector<std::uint32_t> batch_sizes;
+    std::size_t rows = 0;
+    std::chrono::nanoseconds first_row_latency{0};
+    std::chrono::nanoseconds fetch_time{0};
+    // rows of this pass served from the multi-pass buffer instead of the provider
+    std::size_t replayed_rows = 0;
+};
 
 /**
- * specialized converter for string arrays from com safe arrays
- * handles bstr array conversion to std::vector<std::string> with proper memory management
- * \param variant - com variant expected to contain safe array of bstr strings
- * \returns vector of strings if variant contains valid bstr array, nullopt otherwise
+ * how the current or last pass over a query result ended
  */
-template <>
-[[nodiscard]] inline std::optional<std::vector<std::string>>
-ConvertVariant<std::vector<std::string>>(const CComVariant& variant) {
-    //array string
-    if (variant.vt != (VT_ARRAY | VT_BSTR)) {
-        // no array string
-        return std::nullopt;
+struct QueryStatus {
+    enum class State { Running, Complete, DeadlineExceeded, Cancelled, Failed };
+
+    State state = State::Running;
+    // last status returned by the enumerator, or the reason iteration stopped
+    HResult result = status::Ok;
+    // rows were handed out before the pass ended early
+    bool partial = false;
+};
+
+namespace detail {
+
+/**
+ * enumerator plus the batching state of a query, shared by the result and its iterators
+ * with prefetching enabled a worker thread keeps up to prefetch_depth batches ready
+ * while the caller processes the current one
+ */
+class BatchCursor {
+   public:
+    // longest a prefetching Next call blocks before checking for cancellation
+    static constexpr long PREFETCH_SLICE_MS = 50;
+
+    BatchCursor(std::shared_ptr<Enumerator> enumerator, const QueryOptions& options)
+        : enumerator_(std::move(enumerator)), options_(options) {
+        options_.min_batch_size = std::max<std::uint32_t>(options_.min_batch_size, 1);
+        options_.max_batch_size = std::max(options_.max_batch_size, options_.min_batch_size);
+        options_.batch_size =
+            std::clamp(options_.batch_size, options_.min_batch_size, options_.max_batch_size);
+        options_.growth = std::max(options_.growth, 1.0);
+        Restart();
     }
 
-    CComSafeArray<BSTR> safe_array;
-    try {
-        safe_array.Attach(variant.parray);
-    } catch (...) {
-        return std::nullopt;
+    ~BatchCursor() noexcept { StopPrefetch(); }
+
+    BatchCursor(const BatchCursor&) = delete;
+    BatchCursor& operator=(const BatchCursor&) = delete;
+    BatchCursor(BatchCursor&&) = delete;
+    BatchCursor& operator=(BatchCursor&&) = delete;
+
+    /**
+     * rewinds the enumerator and starts a fresh set of statistics
+     * in multi-pass mode the enumerator is left alone, the next pass replays the kept rows
+     * and continues where the provider left off
+     */
+    void Rewind() {
+        StopPrefetch();
+        if (options_.multi_pass) {
+            replay_position_ = 0;
+        } else if (enumerator_) {
+            enumerator_->Reset();
+        }
+        Restart();
     }
 
-    std::vector<std::string> result;
-    const ULONG count = safe_array.GetCount();
-    result.reserve(count);
+    /**
+     * hands out the next batch, from the multi-pass buffer or the enumerator
+     * \param rows - receives the fetched rows
+     * \returns status of the last Next call
+     * \throws whatever the enumerator threw on the prefetch worker
+     */
+    HResult Fetch(std::vector<RowPtr>& rows) {
+        if (!options_.multi_pass) {
+            return Pull(rows);
+        }
 
-    for (ULONG i = 0; i < count; ++i) {
-        if (auto bstr = safe_array.GetAt(i)) {
-            result.emplace_back(_com_util::ConvertBSTRToString(bstr));
-            // hell yeahhh
+        if (replay_position_ < replay_.size()) {
+            const auto count =
+                std::min<std::size_t>(batch_size_, replay_.size() - replay_position_);
+            const auto first = replay_.begin() + static_cast<std::ptrdiff_t>(replay_position_);
+            rows.insert(rows.end(), first, first + static_cast<std::ptrdiff_t>(count));
+            replay_position_ += count;
+            const std::lock_guard lock(state_mutex_);
+            stats_.rows += count;
+            stats_.replayed_rows += count;
+            return status::Ok;
+        }
+        if (replay_complete_) {
+            const std::lock_guard lock(state_mutex_);
+            status_.state = QueryStatus::State::Complete;
+            status_.result = status::False;
+            return status::False;
         }
+
+        const auto first = rows.size();
+        const auto result = Pull(rows);
+        Keep(rows.begin() + static_cast<std::ptrdiff_t>(first), rows.end(), result);
+        replay_position_ = replay_.size();
+        return result;
     }
 
-    safe_array.Detach();
-    return result; // YEAHHHHHHHHHHHHHHHHHHHHH
-}
+    /**
+     * number of rows of the whole result
+     * a multi-pass cursor answers from memory once a pass reached the end,
+     * otherwise this runs a pass of its own
+     */
+    [[nodiscard]] std::size_t Count() {
+        if (options_.multi_pass && replay_complete_) {
+            return replay_.size();
+        }
 
-/**
- * represents a single wmi object with property access capabilities
- * provides type-safe property retrieval from wmi class instances
- * manages underlying com object lifecycle automatically
- */
-class Object {
-    friend class QueryResult;
+        Rewind();
+        std::size_t count = 0;
+        std::vector<RowPtr> rows;
+        for (;;) {
+            rows.clear();
+            const auto result = Fetch(rows);
+            // same end condition as iteration, rows arriving with a failure are not handed out
+            if (Failed(result) || rows.empty()) {
+                return count;
+            }
+            count += rows.size();
+        }
+    }
 
-   protected:
-    Object(std::shared_ptr<const Interface> iface, CComPtr<IWbemClassObject> object)
-        : iface_(std::move(iface)), object_(std::move(object)) {}
+    /**
+     * snapshot of the statistics, complete once the pass reached the end
+     * safe to call while a prefetch worker is still updating them
+     */
+    [[nodiscard]] QueryStats GetStats() const {
+        const std::lock_guard lock(state_mutex_);
+        return stats_;
+    }
 
-   public:
     /**
-     * retrieves a property value from the wmi object with type conversion
-     * automatically handles com variant conversion to requested c++ type
-     * \tparam T - target type for property value (defaults to variant_t)
-     * \param name - property name as wide string view
-     * \returns optional containing property value if available and convertible
+     * snapshot of the status, same synchronization as GetStats
      */
-    template <typename T = variant_t>
-    [[nodiscard]] std::optional<T> GetProperty(const std::wstring_view name) const {
-        CComVariant variant;
-        const auto result = object_->Get(name.data(), 0, &variant, nullptr, nullptr);
+    [[nodiscard]] QueryStatus GetStatus() const {
+        const std::lock_guard lock(state_mutex_);
+        return status_;
+    }
 
-        if (FAILED(result)) {
-            return std::nullopt;
+    [[nodiscard]] const QueryOptions& GetOptions() const noexcept { return options_; }
+
+   private:
+    struct Prefetched {
+        std::vector<RowPtr> rows;
+        HResult result = status::Ok;
+        std::exception_ptr error;
+        bool last = false;
+    };
+
+    /**
+     * hands out the next batch fetched now or by the prefetch worker
+     */
+    HResult Pull(std::vector<RowPtr>& rows) {
+        if (options_.prefetch_depth == 0) {
+            return FetchBatch(rows, INFINITE_TIMEOUT);
+        }
+
+        if (finished_) {
+            return status::False;
+        }
+        if (!worker_.joinable()) {
+            stopping_ = false;
+            worker_ = std::thread([this] { Prefetch(); });
         }
 
-        if constexpr (std::is_same_v<T, variant_t>) {
-            return variant;
+        Prefetched batch;
+        {
+            std::unique_lock lock(mutex_);
+            filled_.wait(lock, [this] { return !ready_.empty(); });
+            batch = std::move(ready_.front());
+            ready_.pop_front();
         }
+        space_.notify_one();
 
-        return ConvertVariant<T>(variant);
+        if (batch.last) {
+            finished_ = true;
+        }
+        if (batch.error) {
+            std::rethrow_exception(batch.error);
+        }
+        rows.insert(rows.end(), std::make_move_iterator(batch.rows.begin()),
+                    std::make_move_iterator(batch.rows.end()));
+        return batch.result;
     }
 
-   private:
-    std::shared_ptr<const Interface> iface_;
-    CComPtr<IWbemClassObject> object_;
+    void Restart() {
+        finished_ = false;
+        const std::lock_guard lock(state_mutex_);
+        stats_ = {};
+        // a cancelled or expired query released its enumerator and stays that way
+        if (enumerator_) {
+            status_.state = QueryStatus::State::Running;
+            status_.result = status::Ok;
+            status_.partial = false;
+        }
+        batch_size_ = options_.batch_mode == QueryOptions::BatchMode::Adaptive &&
+                              options_.fast_first_row
+                          ? options_.min_batch_size
+                          : options_.batch_size;
+    }
+
+    /**
+     * fetches one batch, retrying calls that timed out without rows
+     * until the deadline passes, the token is cancelled or the cursor stops
+     */
+    HResult FetchBatch(std::vector<RowPtr>& rows, const long timeout_ms) {
+        if (!enumerator_) {
+            const std::lock_guard lock(state_mutex_);
+            return status_.result;
+        }
+
+        const auto size = batch_size_;
+        const auto start = std::chrono::steady_clock::now();
+        const bool bounded = options_.cancellation.CanBeCancelled() ||
+                             options_.deadline != std::chrono::steady_clock::time_point::max();
+
+        HResult result = status::TimedOut;
+        for (;;) {
+            auto slice = timeout_ms;
+            if (bounded) {
+                if (options_.cancellation.IsCancelled()) {
+                    result = Abandon(QueryStatus::State::Cancelled, status::Cancelled);
+                    break;
+                }
+                const auto now = std::chrono::steady_clock::now();
+                if (now >= options_.deadline) {
+                    result = Abandon(QueryStatus::State::DeadlineExceeded, status::TimedOut);
+                    break;
+                }
+                const auto remaining =
+                    std::chrono::ceil<std::chrono::milliseconds>(options_.deadline - now);
+                const auto bound = std::min(remaining, options_.timeout_slice).count();
+                slice = slice == INFINITE_TIMEOUT ? static_cast<long>(bound)
+                                                  : std::min(slice, static_cast<long>(bound));
+            }
+
+            result = enumerator_->Next(slice, size, rows);
+            // a provider may still time out a blocking call, that is not the end of the result
+            if (result != status::TimedOut || !rows.empty() ||
+                stopping_.load(std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        const std::lock_guard lock(state_mutex_);
+        if (enumerator_) {
+            status_.result = result;
+            if (Failed(result)) {
+                status_.state = QueryStatus::State::Failed;
+                status_.partial = stats_.rows + rows.size() > 0;
+            } else if (rows.empty() && result != status::TimedOut) {
+                status_.state = QueryStatus::State::Complete;
+            }
+        }
+
+        if (stats_.rows == 0 && !rows.empty()) {
+            stats_.first_row_latency = stats_.fetch_time + elapsed;
+        }
+        stats_.fetch_time += elapsed;
+        stats_.batch_sizes.push_back(size);
+        stats_.rows += rows.size();
+
+        if (options_.batch_mode == QueryOptions::BatchMode::Adaptive) {
+            Adapt(size, rows.size(), elapsed);
+        }
+        return result;
+    }
+
+    /**
+     * gives up on the query: releasing the enumerator cancels the call on the provider side
+     */
+    HResult Abandon(const QueryStatus::State state, const HResult result) {
+        enumerator_.reset();
+        const std::lock_guard lock(state_mutex_);
+        status_.state = state;
+        status_.result = result;
+        status_.partial = stats_.rows > 0;
+        return result;
+    }
+
+    void Adapt(const std::uint32_t requested, const std::size_t received,
+               const std::chrono::steady_clock::duration elapsed) {
+        if (elapsed > options_.target_latency) {
+            // the provider is slow, smaller batches hand out rows sooner
+            batch_size_ = std::max(options_.min_batch_size,
+                                   static_cast<std::uint32_t>(requested / options_.growth));
+        } else if (options_.fast_first_row && stats_.batch_sizes.size() == 1) {
+            // the first row is out, continue at the regular size
+            batch_size_ = options_.batch_size;
+        } else if (received == requested) {
+            // rows keep arriving fast, fewer round trips
+            const auto grown = std::ceil(requested * options_.growth);
+            batch_size_ = grown >= options_.max_batch_size ? options_.max_batch_size
+                                                           : static_cast<std::uint32_t>(grown);
+        }
+    }
+
+    /**
+     * worker loop: fetches ahead until the queue is full, the result ends or the cursor stops
+     * blocks in sliced Next calls so cancellation never waits on a slow provider for long
+     */
+    void Prefetch() {
+        try {
+#ifdef _WIN32
+            COMInitializer com_init(COINIT_MULTITHREADED);
+#endif
+            for (;;) {
+                {
+                    std::unique_lock lock(mutex_);
+                    space_.wait(lock, [this] {
+                        return stopping_.load(std::memory_order_relaxed) ||
+                               ready_.size() < options_.prefetch_depth;
+                    });
+                }
+                if (stopping_.load(std::memory_order_relaxed)) {
+                    return;
+                }
+
+                Prefetched batch;
+                batch.result = FetchBatch(batch.rows, PREFETCH_SLICE_MS);
+                if (stopping_.load(std::memory_order_relaxed)) {
+                    // rows already taken from a forward-only enumerator must not get lost
+                    if (options_.multi_pass && !batch.rows.empty()) {
+                        const std::lock_guard lock(mutex_);
+                        ready_.push_back(std::move(batch));
+                    }
+                    return;
+                }
+                const bool last = Failed(batch.result) || batch.rows.empty();
+                batch.last = last;
+
+                {
+                    const std::lock_guard lock(mutex_);
+                    ready_.push_back(std::move(batch));
+                }
+                filled_.notify_one();
+                if (last) {
+                    return;
+                }
+            }
+        } catch (...) {
+            Prefetched batch;
+            batch.result = status::Failed;
+            batch.error = std::current_exception();
+            batch.last = true;
+            {
+                const std::lock_guard lock(mutex_);
+                ready_.push_back(std::move(batch));
+            }
+            filled_.notify_one();
+        }
+    }
+
+    void StopPrefetch() noexcept {
+        if (!worker_.joinable()) {
+            return;
+        }
+        {
+            const std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        space_.notify_one();
+        worker_.join();
+        // batches fetched ahead but never handed out belong to the next multi-pass replay
+        if (options_.multi_pass) {
+            for (const auto& batch : ready_) {
+                Keep(batch.rows.begin(), batch.rows.end(), batch.result);
+            }
+        }
+        ready_.clear();
+    }
+
+    /**
+     * stores handed out rows for later passes, compacted into rows sharing their column names
+     * \param result - status the rows arrived with, tells whether the result is complete
+     */
+    void Keep(const std::vector<RowPtr>::const_iterator first,
+              const std::vector<RowPtr>::const_iterator last, const HResult result) {
+        replay_.reserve(replay_.size() + static_cast<std::size_t>(last - first));
+        for (auto it = first; it != last; ++it) {
+            replay_.push_back(Compact(*it));
+        }
+        if (first == last && !Failed(result) && result != status::TimedOut) {
+            replay_complete_ = true;
+        }
+    }
+
+    /**
+     * copies a row into a memory row, provider objects are released
+     * consecutive rows with the same properties share one column list
+     */
+    RowPtr Compact(const RowPtr& row) {
+        if (dynamic_cast<const MemoryRow*>(row.get())) {
+            return row;
+        }
+
+        const auto* columns = replay_columns_.get();
+        bool same = columns != nullptr;
+        std::vector<std::wstring> names;
+        std::vector<Variant> values;
+        values.reserve(columns ? columns->size() : 0);
+        row->Enumerate([&](const std::wstring_view name, const Variant& value) {
+            const auto index = values.size();
+            if (same && (index >= columns->size() || (*columns)[index] != name)) {
+                same = false;
+                names.assign(columns->begin(),
+                             columns->begin() + static_cast<std::ptrdiff_t>(index));
+            }
+            if (!same) {
+                names.emplace_back(name);
+            }
+            values.push_back(value);
+        });
+        if (same && values.size() != columns->size()) {
+            same = false;
+            names.assign(columns->begin(),
+                         columns->begin() + static_cast<std::ptrdiff_t>(values.size()));
+        }
+        if (!same) {
+            replay_columns_ = std::make_shared<const MemoryRow::Columns>(std::move(names));
+        }
+        return std::make_shared<MemoryRow>(replay_columns_, std::move(values));
+    }
+
+    std::shared_ptr<Enumerator> enumerator_;
+    QueryOptions options_;
+    // written by the prefetch worker while the caller may read them
+    mutable std::mutex state_mutex_;
+    QueryStats stats_;
+    QueryStatus status_;
+    std::uint32_t batch_size_ = 0;
+
+    std::thread worker_;
+    std::mutex mutex_;
+    std::condition_variable filled_;
+    std::condition_variable space_;
+    std::deque<Prefetched> ready_;
+    std::atomic<bool> stopping_{false};
+    bool finished_ = false;
+
+    // multi-pass mode: rows taken from the enumerator so far and the replay position
+    std::vector<RowPtr> replay_;
+    std::size_t replay_position_ = 0;
+    bool replay_complete_ = false;
+    std::shared_ptr<const MemoryRow::Columns> replay_columns_;
 };
 
+}  // namespace detail
+
 /**
  * represents the result of a wmi query with iterator-based access
  * provides lazy evaluation of query results through input iterators
@@ -241,15 +768,13 @@ class QueryResult {
         using pointer = const Object*;
         using reference = const Object&;
 
-        static constexpr ULONG BATCH_SIZE = 10;
-
-        Iterator(std::shared_ptr<const Interface> iface, CComPtr<IEnumWbemClassObject> enumerator,
+        Iterator(std::shared_ptr<const Interface> iface, std::shared_ptr<detail::BatchCursor> cursor,
                  bool is_end = false)
             : iface_(std::move(iface)),
-              enumerator_(std::move(enumerator)),
-              is_end_(is_end),
-              current_index_(0) {
-            if (!is_end_ && enumerator_) {
+              cursor_(std::move(cursor)),
+              current_index_(0),
+              is_end_(is_end) {
+            if (!is_end_ && cursor_) {
                 FetchNextBatch();
             }
         }
@@ -283,8 +808,9 @@ class QueryResult {
 
        private:
         std::shared_ptr<const Interface> iface_;
-        CComPtr<IEnumWbemClassObject> enumerator_;
+        std::shared_ptr<detail::BatchCursor> cursor_;
         std::vector<Object> batch_;
+        std::vector<RowPtr> rows_;
         std::size_t current_index_;
         bool is_end_ = false;
 
@@ -292,34 +818,32 @@ class QueryResult {
             batch_.clear();
             current_index_ = 0;
 
-            if (!enumerator_) {
+            if (!cursor_) {
                 is_end_ = true;
                 return;
             }
 
-            ULONG returned_count = 0;
-            CComPtr<IWbemClassObject> objects[BATCH_SIZE];
+            rows_.clear();
+            const auto result = cursor_->Fetch(rows_);
 
-            const auto result =
-                enumerator_->Next(WBEM_INFINITE, BATCH_SIZE,
-                                  reinterpret_cast<IWbemClassObject**>(objects), &returned_count);
-
-            if (FAILED(result) || returned_count == 0) {
+            if (Failed(result) || rows_.empty()) {
                 is_end_ = true;
                 return;
             }
 
-            batch_.reserve(returned_count);
-            for (ULONG i = 0; i < returned_count; ++i) {
-                batch_.emplace_back(Object(iface_, objects[i]));
+            batch_.reserve(rows_.size());
+            for (auto& row : rows_) {
+                batch_.emplace_back(Object(iface_, std::move(row)));
             }
         }
     };
 
    protected:
-    QueryResult(std::shared_ptr<const Interface> iface,
-                const CComPtr<IEnumWbemClassObject>& enumerator)
-        : iface_(std::move(iface)), enumerator_(enumerator) {}
+    QueryResult(std::shared_ptr<const Interface> iface, std::shared_ptr<Enumerator> enumerator,
+                const QueryOptions& options = {})
+        : iface_(std::move(iface)),
+          cursor_(enumerator ? std::make_shared<detail::BatchCursor>(std::move(enumerator), options)
+                             : nullptr) {}
 
    public:
     /**
@@ -328,10 +852,10 @@ class QueryResult {
      * \returns iterator pointing to first result object
      */
     [[nodiscard]] Iterator begin() const {
-        if (enumerator_) {
-            enumerator_->Reset();
+        if (cursor_) {
+            cursor_->Rewind();
         }
-        return Iterator(iface_, enumerator_);
+        return Iterator(iface_, cursor_);
     }
 
     /**
@@ -341,103 +865,1062 @@ class QueryResult {
      */
     [[nodiscard]] Iterator end() const { return Iterator(iface_, nullptr, true); }
 
+    /**
+     * counts the objects of the result
+     * with QueryOptions::multi_pass this costs no provider round trip once a pass completed,
+     * remaining rows are pulled into the buffer otherwise; without it a pass is used up
+     * \returns number of objects a complete iteration yields
+     */
+    [[nodiscard]] std::size_t Count() const { return cursor_ ? cursor_->Count() : 0; }
+
+    /**
+     * batch sizes and timings of the current or last pass, as a snapshot
+     */
+    [[nodiscard]] QueryStats GetStats() const {
+        return cursor_ ? cursor_->GetStats() : QueryStats{};
+    }
+
+    /**
+     * whether the current or last pass completed, failed, timed out or was cancelled
+     */
+    [[nodiscard]] QueryStatus GetStatus() const {
+        return cursor_ ? cursor_->GetStatus() : QueryStatus{};
+    }
+
    private:
     std::shared_ptr<const Interface> iface_;
-    CComPtr<IEnumWbemClassObject> enumerator_;
+    std::shared_ptr<detail::BatchCursor> cursor_;
 };
 
+namespace detail {
+
 /**
- * main interface for wmi operations providing namespace connection and query execution
- * manages underlying com connections and provides thread-safe query capabilities
- * uses shared_ptr for automatic lifetime management across threads
+ * wakes a thread waiting on any of several asynchronous queries
+ * waiters read the epoch before checking their queues so no notification is lost
  */
-class Interface : public std::enable_shared_from_this<const Interface> {
+class Signal {
    public:
-    struct PassKey {
-        explicit PassKey() = default;
-    };
-
-    /**
-     * factory method to create interface instances with proper initialization
-     * \param path - wmi namespace path (defaults to "cimv2")
-     * \returns shared_ptr to initialized interface ready for queries
-     */
-    static std::shared_ptr<Interface> Create(std::string_view path = "cimv2");
-
-    explicit Interface(PassKey, const std::string_view path) {
-        auto result = CoCreateInstance(CLSID_WbemLocator, nullptr, CLSCTX_INPROC_SERVER,
-                                       IID_IWbemLocator, reinterpret_cast<LPVOID*>(&locator_));
-        if (FAILED(result)) {
-            // error locator
-            throw Exception("Failed to create WbemLocator object. " +
-                            FormatHResultError("Check if WMI service is available", result));
-        }
-
-        // wmi namespace
-        result = locator_->ConnectServer(bstr_t(R"(\\.\root\)") + bstr_t(path.data()), nullptr,
-                                         nullptr, nullptr, 0, nullptr, nullptr, &services_);
-        if (FAILED(result)) {
-            throw Exception(
-                "Could not connect to WMI namespace '" + std::string(path) + "'. " +
-                FormatHResultError("Verify namespace exists and access permissions", result));
+    void Notify() {
+        std::vector<std::function<void()>> subscribers;
+        {
+            const std::lock_guard lock(mutex_);
+            ++epoch_;
+            subscribers.swap(subscribers_);
         }
-
-        // apcb
-        result = CoSetProxyBlanket(services_, RPC_C_AUTHN_DEFAULT, RPC_C_AUTHZ_NONE,
-                                   COLE_DEFAULT_PRINCIPAL, RPC_C_AUTHN_LEVEL_DEFAULT,
-                                   RPC_C_IMP_LEVEL_IMPERSONATE, nullptr, EOAC_NONE);
-        if (FAILED(result)) {
-            // error security
-            throw Exception("Could not set proxy blanket for WMI connection. " +
-                            FormatHResultError("Authentication may have failed", result));
+        changed_.notify_all();
+        for (auto& subscriber : subscribers) {
+            subscriber();
         }
     }
 
-    ~Interface() noexcept = default;
-
-    Interface(const Interface& other) = delete;
-    Interface& operator=(const Interface& other) = delete;
-
-    Interface(Interface&& other) noexcept = default;
-    Interface& operator=(Interface&& other) noexcept = default;
+    [[nodiscard]] std::uint64_t Epoch() const {
+        const std::lock_guard lock(mutex_);
+        return epoch_;
+    }
 
     /**
-     * executes wql query against connected wmi namespace
-     * provides lazy-evaluated results through queryresult iterator interface
-     * \param query - wql query string as wide character view
-     * \returns queryresult object for iterating over matching wmi objects
-     * \throws Exception if query execution fails with detailed error context
+     * blocks until Notify was called after the given epoch was read
      */
-    [[nodiscard]] QueryResult ExecuteQuery(const std::wstring_view query) const {
-        CComPtr<IEnumWbemClassObject> enumerator;
-        const auto query_bstr = bstr_t(query.data());
-        const auto result = services_->ExecQuery(
-            bstr_t("WQL"), query_bstr, WBEM_FLAG_FORWARD_ONLY | WBEM_FLAG_RETURN_IMMEDIATELY,
-            nullptr, &enumerator);
+    void Wait(const std::uint64_t seen) const {
+        std::unique_lock lock(mutex_);
+        changed_.wait(lock, [this, seen] { return epoch_ != seen; });
+    }
 
-        if (FAILED(result)) {
-            const std::string query_str = _com_util::ConvertBSTRToString(query_bstr);
-            throw Exception(
-                "WQL query execution failed for query: '" + query_str + "'. " +
-                FormatHResultError("Check query syntax and target class availability", result));
+    /**
+     * runs a callback once, on the notifying thread, at the first Notify after the given epoch
+     * \returns false without registering if Notify was already called since
+     */
+    [[nodiscard]] bool Subscribe(const std::uint64_t seen, std::function<void()> callback) {
+        const std::lock_guard lock(mutex_);
+        if (epoch_ != seen) {
+            return false;
         }
-
-        return {shared_from_this(), enumerator};
+        subscribers_.push_back(std::move(callback));
+        return true;
     }
 
    private:
-    CComPtr<IWbemLocator> locator_;
-    CComPtr<IWbemServices> services_;
+    mutable std::mutex mutex_;
+    mutable std::condition_variable changed_;
+    std::uint64_t epoch_ = 0;
+    std::vector<std::function<void()>> subscribers_;
 };
 
 /**
- * factory implementation that creates interface instances through make_shared
- * ensures proper memory management and exception safety during construction
- * \param path - wmi namespace to connect to
- * \returns shared_ptr to fully initialized interface instance
+ * object sink feeding a bounded lock-free queue
+ * a full queue blocks the provider thread until the consumer pops or abandons the query,
+ * the consumer only touches the lock while a provider is waiting
  */
-inline std::shared_ptr<Interface> Interface::Create(const std::string_view path) {
-    return std::make_shared<Interface>(PassKey{}, path);
+class QueueSink final : public ObjectSink {
+   public:
+    QueueSink(const std::size_t capacity, std::shared_ptr<Signal> signal)
+        : queue_(capacity), signal_(std::move(signal)) {}
+
+    void Indicate(std::vector<RowPtr>& rows) override {
+        for (auto& row : rows) {
+            if (queue_.TryPush(row)) {
+                continue;
+            }
+            if (abandoned_.load(std::memory_order_relaxed)) {
+                return;
+            }
+            // the consumer may be asleep with the queue full, wake it before waiting for space
+            signal_->Notify();
+            std::unique_lock lock(space_mutex_);
+            // pairs with TryPop: whichever side updates the counter second sees the other
+            waiting_.fetch_add(1, std::memory_order_acq_rel);
+            space_.wait(lock, [this, &row] {
+                return abandoned_.load(std::memory_order_relaxed) || queue_.TryPush(row);
+            });
+            waiting_.fetch_sub(1, std::memory_order_relaxed);
+            if (abandoned_.load(std::memory_order_relaxed)) {
+                return;
+            }
+        }
+        signal_->Notify();
+    }
+
+    void SetStatus(const HResult result, std::exception_ptr error) override {
+        error_ = std::move(error);
+        // rows were dropped after the consumer left, the provider may still see a clean end
+        const bool dropped = abandoned_.load(std::memory_order_relaxed) && !Failed(result);
+        result_ = dropped ? status::Cancelled : result;
+        done_.store(true, std::memory_order_release);
+        signal_->Notify();
+    }
+
+    [[nodiscard]] std::optional<RowPtr> TryPop() {
+        auto row = queue_.TryPop();
+        // a read-modify-write rather than a load, so it is ordered against the waiter's
+        if (row && waiting_.fetch_add(0, std::memory_order_acq_rel) != 0) {
+            // the waiter holds the lock until it sleeps, so the wakeup cannot be missed
+            { const std::lock_guard lock(space_mutex_); }
+            space_.notify_one();
+        }
+        return row;
+    }
+
+    /**
+     * true once the final status arrived, every row pushed before it is already queued
+     */
+    [[nodiscard]] bool IsDone() const noexcept { return done_.load(std::memory_order_acquire); }
+
+    // exact once IsDone returned true, nothing is pushed after the status
+    [[nodiscard]] bool IsEmpty() const noexcept { return queue_.SizeApprox() == 0; }
+
+    /**
+     * the consumer is gone, drop whatever still arrives instead of waiting for space
+     */
+    void Abandon() noexcept {
+        {
+            const std::lock_guard lock(space_mutex_);
+            abandoned_.store(true, std::memory_order_relaxed);
+        }
+        space_.notify_all();
+    }
+
+    // valid once IsDone returned true
+    [[nodiscard]] HResult GetResult() const noexcept { return result_; }
+    [[nodiscard]] const std::exception_ptr& GetError() const noexcept { return error_; }
+
+   private:
+    BoundedQueue<RowPtr> queue_;
+    std::shared_ptr<Signal> signal_;
+    std::atomic<bool> done_{false};
+    std::atomic<bool> abandoned_{false};
+    std::mutex space_mutex_;
+    std::condition_variable space_;
+    // providers blocked on a full queue
+    std::atomic<std::size_t> waiting_{0};
+    HResult result_ = status::Ok;
+    std::exception_ptr error_;
+};
+
+}  // namespace detail
+
+/**
+ * push-based query in flight, rows arrive in a bounded queue while the caller does other work
+ * one thread can keep many of these running and pick up objects as they come in
+ */
+class AsyncQuery {
+    friend class Interface;
+
+   public:
+    static constexpr std::size_t DEFAULT_QUEUE_CAPACITY = 256;
+
+    struct PassKey {
+        explicit PassKey() = default;
+    };
+
+    AsyncQuery(PassKey, std::shared_ptr<const Interface> iface, const std::size_t capacity,
+               std::shared_ptr<detail::Signal> signal)
+        : iface_(std::move(iface)),
+          signal_(std::move(signal)),
+          sink_(std::make_shared<detail::QueueSink>(capacity, signal_)) {}
+
+    ~AsyncQuery() noexcept {
+        // waits for a token callback that is cancelling right now
+        registration_.Reset();
+        Cancel();
+    }
+
+    AsyncQuery(const AsyncQuery&) = delete;
+    AsyncQuery& operator=(const AsyncQuery&) = delete;
+    AsyncQuery(AsyncQuery&&) = delete;
+    AsyncQuery& operator=(AsyncQuery&&) = delete;
+
+    /**
+     * takes the next object if one already arrived
+     * \returns object, nullopt if none is queued right now
+     */
+    [[nodiscard]] std::optional<Object> TryNext() {
+        if (auto row = sink_->TryPop()) {
+            return Object(iface_, std::move(*row));
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * waits for the next object
+     * \returns object, nullopt once the query ended and every object was taken
+     */
+    [[nodiscard]] std::optional<Object> Next() {
+        for (;;) {
+            const auto seen = signal_->Epoch();
+            if (auto object = TryNext()) {
+                return object;
+            }
+            if (sink_->IsDone()) {
+                // rows queued before the status are visible now
+                return TryNext();
+            }
+            signal_->Wait(seen);
+        }
+    }
+
+    /**
+     * hands every object that already arrived to a callback, without waiting
+     * \param callback - invoked with each const Object&
+     * \returns number of objects delivered
+     */
+    template <typename Callback>
+    std::size_t Drain(Callback&& callback) {
+        std::size_t delivered = 0;
+        while (auto object = TryNext()) {
+            callback(static_cast<const Object&>(*object));
+            ++delivered;
+        }
+        return delivered;
+    }
+
+    /**
+     * true once the query ended and every object was taken
+     */
+    [[nodiscard]] bool IsDone() const { return sink_->IsDone() && sink_->IsEmpty(); }
+
+    /**
+     * final status of the query
+     * \returns status::Ok, status::Cancelled or a failure code, nullopt while running
+     */
+    [[nodiscard]] std::optional<HResult> GetStatus() const {
+        if (!sink_->IsDone()) {
+            return std::nullopt;
+        }
+        return sink_->GetResult();
+    }
+
+    /**
+     * exception the backend raised while running the query, if any
+     */
+    [[nodiscard]] std::exception_ptr GetError() const {
+        return sink_->IsDone() ? sink_->GetError() : nullptr;
+    }
+
+    /**
+     * change counter of the query, read it before looking for objects and pass it to Subscribe
+     */
+    [[nodiscard]] std::uint64_t Epoch() const { return signal_->Epoch(); }
+
+    /**
+     * asks to be told once objects or the final status arrive, without blocking a thread
+     * the callback runs on the thread delivering the objects and should only schedule work
+     * \param seen - value of Epoch read before the query was last found empty
+     * \param callback - action to run once
+     * \returns false without registering if something arrived since seen was read
+     */
+    [[nodiscard]] bool Subscribe(const std::uint64_t seen, std::function<void()> callback) {
+        return signal_->Subscribe(seen, std::move(callback));
+    }
+
+    /**
+     * stops the query and drops objects that did not arrive yet
+     */
+    void Cancel() noexcept {
+        sink_->Abandon();
+        // the caller and a cancellation token may race here
+        const std::lock_guard lock(cancel_mutex_);
+        if (call_) {
+            call_->Cancel();
+        }
+    }
+
+   private:
+    std::shared_ptr<const Interface> iface_;
+    std::shared_ptr<detail::Signal> signal_;
+    std::shared_ptr<detail::QueueSink> sink_;
+    std::unique_ptr<AsyncCall> call_;
+    std::mutex cancel_mutex_;
+    CancellationRegistration registration_;
+};
+
+namespace detail {
+
+/**
+ * class schemas of one interface, each fetched from the backend once
+ * classes the backend cannot describe are remembered as well so they are not asked for again
+ */
+class SchemaCache {
+   public:
+    [[nodiscard]] std::shared_ptr<const ClassSchema> Get(Backend& backend,
+                                                         const std::wstring_view class_name) {
+        std::wstring key(class_name);
+        for (auto& ch : key) {
+            if (ch >= L'A' && ch <= L'Z') {
+                ch = static_cast<wchar_t>(ch - L'A' + L'a');
+            }
+        }
+        {
+            const std::lock_guard lock(mutex_);
+            if (const auto it = schemas_.find(key); it != schemas_.end()) {
+                return it->second;
+            }
+        }
+
+        // fetched unlocked, a slow provider must not hold up lookups of other classes
+        auto schema = backend.GetClassSchema(class_name);
+        std::shared_ptr<const ClassSchema> entry;
+        if (schema) {
+            entry = std::make_shared<const ClassSchema>(std::move(*schema));
+        }
+        const std::lock_guard lock(mutex_);
+        return schemas_.emplace(std::move(key), std::move(entry)).first->second;
+    }
+
+   private:
+    std::mutex mutex_;
+    // keyed by the lowercased class name, nullptr for classes without a schema
+    std::map<std::wstring, std::shared_ptr<const ClassSchema>> schemas_;
+};
+
+}  // namespace detail
+
+/**
+ * main interface for wmi operations providing namespace connection and query execution
+ * delegates the actual work to a backend: com on windows, or any provider passed to Create
+ * uses shared_ptr for automatic lifetime management across threads
+ */
+class Interface : public std::enable_shared_from_this<const Interface> {
+   public:
+    struct PassKey {
+        explicit PassKey() = default;
+    };
+
+    /**
+     * factory method to create interface instances with proper initialization
+     * uses the native backend of the platform
+     * \param path - wmi namespace path (defaults to "cimv2")
+     * \returns shared_ptr to initialized interface ready for queries
+     */
+    static std::shared_ptr<Interface> Create(std::string_view path = "cimv2");
+
+    /**
+     * factory method for interfaces over a caller-provided backend
+     * \param backend - provider answering the queries
+     * \param path - wmi namespace path (defaults to "cimv2")
+     * \returns shared_ptr to initialized interface ready for queries
+     */
+    static std::shared_ptr<Interface> Create(std::shared_ptr<Backend> backend,
+                                             std::string_view path = "cimv2");
+
+    explicit Interface(PassKey, std::shared_ptr<Backend> backend, const std::string_view path)
+        : backend_(std::move(backend)) {
+        if (!backend_) {
+            throw Exception("Cannot create WMI interface without a backend");
+        }
+        backend_->Connect(path);
+    }
+
+    ~Interface() noexcept = default;
+
+    Interface(const Interface& other) = delete;
+    Interface& operator=(const Interface& other) = delete;
+
+    Interface(Interface&& other) noexcept = default;
+    Interface& operator=(Interface&& other) noexcept = default;
+
+    /**
+     * executes wql query against connected wmi namespace
+     * provides lazy-evaluated results through queryresult iterator interface
+     * \param query - wql query string as wide character view
+     * \param options - batching behaviour of the result
+     * \returns queryresult object for iterating over matching wmi objects
+     * \throws Exception if query execution fails with detailed error context
+     */
+    [[nodiscard]] QueryResult ExecuteQuery(const std::wstring_view query,
+                                           const QueryOptions& options = {}) const {
+        return {shared_from_this(), backend_->ExecQuery(query), options};
+    }
+
+    /**
+     * executes a query that stops iterating at a deadline instead of waiting on a hung provider
+     * \param query - wql query string as wide character view
+     * \param deadline - point in time after which iteration ends, see QueryResult::GetStatus
+     * \param cancellation - token that ends iteration early when cancelled
+     * \param options - batching behaviour of the result
+     * \returns queryresult object for iterating over matching wmi objects
+     * \throws Exception if query execution fails with detailed error context
+     */
+    [[nodiscard]] QueryResult ExecuteQuery(const std::wstring_view query,
+                                           const std::chrono::steady_clock::time_point deadline,
+                                           CancellationToken cancellation = {},
+                                           QueryOptions options = {}) const {
+        options.deadline = deadline;
+        options.cancellation = std::move(cancellation);
+        return ExecuteQuery(query, options);
+    }
+
+    /**
+     * executes a query whose iteration ends early when the token is cancelled
+     * \param query - wql query string as wide character view
+     * \param cancellation - token that ends iteration early when cancelled
+     * \param options - batching behaviour of the result
+     * \returns queryresult object for iterating over matching wmi objects
+     * \throws Exception if query execution fails with detailed error context
+     */
+    [[nodiscard]] QueryResult ExecuteQuery(const std::wstring_view query,
+                                           CancellationToken cancellation,
+                                           QueryOptions options = {}) const {
+        options.cancellation = std::move(cancellation);
+        return ExecuteQuery(query, options);
+    }
+
+    /**
+     * starts a query whose objects are pushed into a bounded queue as the provider produces them
+     * \param query - wql query string as wide character view
+     * \param queue_capacity - objects buffered before the provider is held back
+     * \returns handle to take objects from, cancels the query when destroyed
+     * \throws Exception if the query cannot be started
+     */
+    [[nodiscard]] std::shared_ptr<AsyncQuery> ExecuteQueryAsync(
+        const std::wstring_view query,
+        const std::size_t queue_capacity = AsyncQuery::DEFAULT_QUEUE_CAPACITY) const {
+        return StartAsync(query, queue_capacity, std::make_shared<detail::Signal>());
+    }
+
+    /**
+     * starts a push-based query that is cancelled on the provider side along with the token
+     * \param query - wql query string as wide character view
+     * \param cancellation - token cancelling the query
+     * \param queue_capacity - objects buffered before the provider is held back
+     * \returns handle to take objects from, cancels the query when destroyed
+     * \throws Exception if the query cannot be started
+     */
+    [[nodiscard]] std::shared_ptr<AsyncQuery> ExecuteQueryAsync(
+        const std::wstring_view query, const CancellationToken& cancellation,
+        const std::size_t queue_capacity = AsyncQuery::DEFAULT_QUEUE_CAPACITY) const {
+        auto async_query = ExecuteQueryAsync(query, queue_capacity);
+        async_query->registration_ =
+            cancellation.Register([raw = async_query.get()] { raw->Cancel(); });
+        return async_query;
+    }
+
+    /**
+     * property types of a class, read from the class definition on first use and cached
+     * for the lifetime of the interface
+     * \param class_name - wmi class name, matched case-insensitively
+     * \returns schema of the class, nullptr if the backend cannot describe classes
+     * \throws Exception if the class does not exist
+     */
+    [[nodiscard]] std::shared_ptr<const ClassSchema> GetSchema(
+        const std::wstring_view class_name) const {
+        return schemas_->Get(*backend_, class_name);
+    }
+
+    /**
+     * parses a query once and binds the properties it selects to column positions
+     * the selected properties are checked against the class schema when one is available
+     * \param query - wql query with an explicit property list
+     * \returns prepared query that can be executed any number of times
+     * \throws Exception if the query cannot be parsed, selects every property with * or
+     *         selects a property the class does not declare
+     */
+    [[nodiscard]] PreparedQuery Prepare(std::wstring_view query) const;
+
+    /**
+     * reads every object of a class into structs declared with WMI_BINDING
+     * the select statement is generated at compile time from the bound members and each
+     * member is filled by the converter of its type, without per-property optionals
+     * \tparam T - default-constructible struct with a WMI_BINDING in its namespace
+     * \param options - batching behaviour of the query
+     * \returns one T per object; members whose property is null keep their default value
+     * \throws Exception if a member cannot hold the declared type of its property, or if
+     *         query execution fails
+     */
+    template <typename T>
+    [[nodiscard]] std::vector<T> Query(const QueryOptions& options = {}) const;
+
+    /**
+     * backend answering this interface's queries
+     */
+    [[nodiscard]] const std::shared_ptr<Backend>& GetBackend() const noexcept { return backend_; }
+
+   private:
+    friend class AsyncDispatcher;
+
+    [[nodiscard]] std::shared_ptr<AsyncQuery> StartAsync(
+        const std::wstring_view query, const std::size_t queue_capacity,
+        std::shared_ptr<detail::Signal> signal) const {
+        auto async_query = std::make_shared<AsyncQuery>(AsyncQuery::PassKey{}, shared_from_this(),
+                                                        queue_capacity, std::move(signal));
+        async_query->call_ = backend_->ExecQueryAsync(query, async_query->sink_);
+        return async_query;
+    }
+
+    std::shared_ptr<Backend> backend_;
+    std::unique_ptr<detail::SchemaCache> schemas_ = std::make_unique<detail::SchemaCache>();
+};
+
+/**
+ * drives many asynchronous queries from a single thread
+ * objects and completions are delivered to callbacks on the thread calling Poll or Run
+ */
+class AsyncDispatcher {
+   public:
+    using ObjectCallback = std::function<void(const Object&)>;
+    using DoneCallback = std::function<void(HResult, std::exception_ptr)>;
+
+    explicit AsyncDispatcher(std::shared_ptr<const Interface> iface) : iface_(std::move(iface)) {}
+
+    /**
+     * starts a query and registers its callbacks
+     * \param query - wql query string as wide character view
+     * \param on_object - invoked for every object
+     * \param on_done - invoked once with the final status and the backend's exception, if any
+     * \param queue_capacity - objects buffered before the provider is held back
+     * \throws Exception if the query cannot be started
+     */
+    void Submit(const std::wstring_view query, ObjectCallback on_object,
+                DoneCallback on_done = nullptr,
+                const std::size_t queue_capacity = AsyncQuery::DEFAULT_QUEUE_CAPACITY) {
+        pending_.push_back(Entry{iface_->StartAsync(query, queue_capacity, signal_),
+                                   std::move(on_object), std::move(on_done)});
+    }
+
+    /**
+     * number of queries that have not completed yet
+     */
+    [[nodiscard]] std::size_t Pending() const noexcept { return pending_.size(); }
+
+    /**
+     * delivers everything that arrived so far without waiting
+     * \returns number of objects and completions delivered
+     */
+    std::size_t Poll() {
+        std::size_t delivered = 0;
+        for (auto it = pending_.begin(); it != pending_.end();) {
+            const bool done = it->query->GetStatus().has_value();
+            delivered += it->query->Drain([&it](const Object& object) {
+                if (it->on_object) {
+                    it->on_object(object);
+                }
+            });
+            if (done && it->query->IsDone()) {
+                if (it->on_done) {
+                    it->on_done(*it->query->GetStatus(), it->query->GetError());
+                }
+                ++delivered;
+                it = pending_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        return delivered;
+    }
+
+    /**
+     * delivers objects and completions until every submitted query ended
+     */
+    void Run() {
+        while (!pending_.empty()) {
+            const auto seen = signal_->Epoch();
+            if (Poll() == 0) {
+                signal_->Wait(seen);
+            }
+        }
+    }
+
+    /**
+     * cancels every query still running, their completions are not delivered
+     */
+    void CancelAll() noexcept { pending_.clear(); }
+
+   private:
+    struct Entry {
+        std::shared_ptr<AsyncQuery> query;
+        ObjectCallback on_object;
+        DoneCallback on_done;
+    };
+
+    std::shared_ptr<const Interface> iface_;
+    std::shared_ptr<detail::Signal> signal_ = std::make_shared<detail::Signal>();
+    std::vector<Entry> pending_;
+};
+
+/**
+ * one object of a prepared query with its selected properties already read into columns
+ */
+class PreparedRow {
+    friend class PreparedResult;
+
+   public:
+    /**
+     * reads a column by position
+     * \tparam T - target type for the value (defaults to Variant)
+     * \param column - position of the property in the select list, see PreparedQuery::Column
+     * \returns optional containing the value if available and convertible
+     */
+    template <typename T = Variant>
+    [[nodiscard]] std::optional<T> Get(const std::size_t column) const {
+        if (column >= values_.size() || !values_[column]) {
+            return std::nullopt;
+        }
+
+        if constexpr (std::is_same_v<T, Variant>) {
+            return *values_[column];
+        } else {
+            return ConvertVariant<T>(*values_[column]);
+        }
+    }
+
+    /**
+     * raw value of a column, valid as long as the row
+     * \param column - position of the property in the select list
+     * \returns pointer to the value, nullptr if the object lacks the property
+     */
+    [[nodiscard]] const Variant* Find(const std::size_t column) const noexcept {
+        return column < values_.size() ? values_[column] : nullptr;
+    }
+
+    /**
+     * borrows the text of a string column without copying or transcoding it
+     * \param column - position of the property in the select list
+     * \returns view valid as long as the object of this row, see GetObject; nullopt if the
+     *          column is missing, null or not a string
+     */
+    [[nodiscard]] std::optional<std::wstring_view> GetStringView(
+        const std::size_t column) const noexcept {
+        return detail::ViewString(Find(column));
+    }
+
+    [[nodiscard]] std::size_t Size() const noexcept { return values_.size(); }
+
+    /**
+     * the object the columns were read from, for properties outside the select list
+     */
+    [[nodiscard]] const Object& GetObject() const noexcept { return object_; }
+
+   private:
+    PreparedRow(Object object, std::vector<const Variant*> values)
+        : object_(std::move(object)), values_(std::move(values)) {}
+
+    Object object_;
+    // owned by the row of object_, nullptr for missing properties
+    std::vector<const Variant*> values_;
+};
+
+namespace detail {
+
+/**
+ * property handles of the columns of a prepared query
+ * shared by every execution; resolved again whenever an object of another column layout
+ * arrives, e.g. from the next execution against an in-memory backend, and kept for the latest
+ * layout only
+ */
+class ColumnBinding {
+   public:
+    using Handles = std::vector<PropertyHandle>;
+
+    explicit ColumnBinding(std::vector<std::wstring> columns) : columns_(std::move(columns)) {}
+
+    /**
+     * handles of the columns for the layout of an object
+     * \param object - object of the queried class
+     * \param layout - layout the row of object reports, see Row::Layout
+     * \returns handles in column order, never changed once handed out
+     */
+    [[nodiscard]] std::shared_ptr<const Handles> Resolve(const Object& object,
+                                                         const void* layout) {
+        const std::lock_guard lock(mutex_);
+        if (!handles_ || layout_ != layout) {
+            auto handles = std::make_shared<Handles>();
+            handles->reserve(columns_.size());
+            for (const auto& column : columns_) {
+                handles->push_back(object.GetPropertyHandle(column));
+            }
+            handles_ = std::move(handles);
+            layout_ = layout;
+        }
+        return handles_;
+    }
+
+    [[nodiscard]] const std::vector<std::wstring>& Columns() const noexcept { return columns_; }
+
+   private:
+    const std::vector<std::wstring> columns_;
+    std::mutex mutex_;
+    // compared only, a reused address at worst makes the row fall back to lookups by name
+    const void* layout_ = nullptr;
+    std::shared_ptr<const Handles> handles_;
+};
+
+[[nodiscard]] constexpr bool IsNumeric(const CimType type) noexcept {
+    switch (type) {
+        case CimType::SInt8:
+        case CimType::UInt8:
+        case CimType::SInt16:
+        case CimType::UInt16:
+        case CimType::SInt32:
+        case CimType::UInt32:
+        case CimType::SInt64:
+        case CimType::UInt64:
+        case CimType::Real32:
+        case CimType::Real64:
+        case CimType::Boolean:
+        case CimType::Char16:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * whether ConvertVariant<T> can succeed for values of a property of the declared type
+ * decided from the schema alone, so a mismatch is found before any object is read
+ */
+template <typename T>
+[[nodiscard]] constexpr bool Accepts(const PropertySchema& property) noexcept {
+    if constexpr (IsOptional<T>::value) {
+        return Accepts<typename T::value_type>(property);
+    } else if constexpr (std::is_same_v<T, Variant>) {
+        return true;
+    } else if constexpr (std::is_arithmetic_v<T>) {
+        // 64-bit integers are declared numeric but travel as text, ConvertVariant parses it
+        return !property.is_array && IsNumeric(property.type);
+    } else if constexpr (std::is_same_v<T, std::chrono::system_clock::time_point> ||
+                         std::is_same_v<T, Interval>) {
+        return !property.is_array && property.type == CimType::DateTime;
+    } else if constexpr (std::is_same_v<T, std::wstring> || std::is_same_v<T, std::string>) {
+        return !property.is_array && property.type != CimType::Object;
+    } else if constexpr (IsVector<T>::value) {
+        return property.is_array &&
+               (property.type == CimType::String || property.type == CimType::DateTime ||
+                property.type == CimType::Reference);
+    } else {
+        return true;
+    }
+}
+
+/**
+ * fails when a property cannot be read as T
+ * \throws Exception naming the property and its declared type
+ */
+template <typename T>
+void CheckAccepts(const ClassSchema& schema, const PropertySchema& property) {
+    if (!Accepts<T>(property)) {
+        throw Exception("Property '" + NarrowString(property.name) + "' of class '" +
+                        NarrowString(schema.class_name) + "' is declared as " +
+                        ToString(property.type) + (property.is_array ? "[]" : "") +
+                        " and cannot be converted to the requested type");
+    }
+}
+
+}  // namespace detail
+
+/**
+ * result of executing a prepared query
+ * iterating reads every column of an object in one pass as the object is reached
+ */
+class PreparedResult {
+    friend class PreparedQuery;
+
+   public:
+    class Iterator {
+       public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = PreparedRow;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const PreparedRow*;
+        using reference = const PreparedRow&;
+
+        Iterator(QueryResult::Iterator current, std::shared_ptr<detail::ColumnBinding> binding)
+            : current_(std::move(current)), binding_(std::move(binding)) {
+            Load();
+        }
+
+        reference operator*() const { return *row_; }
+
+        pointer operator->() const { return &*row_; }
+
+        Iterator& operator++() {
+            ++current_;
+            Load();
+            return *this;
+        }
+
+        bool operator==(const Iterator& other) const { return current_ == other.current_; }
+
+        bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+       private:
+        void Load() {
+            if (!binding_ || current_ == end_) {
+                row_.reset();
+                return;
+            }
+
+            const auto& object = *current_;
+            // the lock is taken once per layout, normally once per pass
+            const auto* layout = object.row_->Layout();
+            if (!handles_ || layout != layout_) {
+                handles_ = binding_->Resolve(object, layout);
+                layout_ = layout;
+            }
+
+            // the row is refilled in place so its column buffer is allocated once per pass
+            if (!row_) {
+                row_ = PreparedRow(object, std::vector<const Variant*>(handles_->size()));
+            } else {
+                row_->object_ = object;
+            }
+            object.row_->ReadAll(handles_->data(), handles_->size(), row_->values_.data());
+        }
+
+        QueryResult::Iterator current_;
+        QueryResult::Iterator end_{nullptr, nullptr, true};
+        std::shared_ptr<detail::ColumnBinding> binding_;
+        std::shared_ptr<const detail::ColumnBinding::Handles> handles_;
+        const void* layout_ = nullptr;
+        std::optional<PreparedRow> row_;
+    };
+
+    /**
+     * restarts the query like QueryResult::begin
+     * \returns iterator pointing to the first row
+     */
+    [[nodiscard]] Iterator begin() const { return Iterator(result_.begin(), binding_); }
+
+    [[nodiscard]] Iterator end() const { return Iterator(result_.end(), nullptr); }
+
+    [[nodiscard]] std::size_t Count() const { return result_.Count(); }
+
+    [[nodiscard]] QueryStats GetStats() const { return result_.GetStats(); }
+
+    [[nodiscard]] QueryStatus GetStatus() const { return result_.GetStatus(); }
+
+   private:
+    PreparedResult(QueryResult result, std::shared_ptr<detail::ColumnBinding> binding)
+        : result_(std::move(result)), binding_(std::move(binding)) {}
+
+    QueryResult result_;
+    std::shared_ptr<detail::ColumnBinding> binding_;
+};
+
+/**
+ * query parsed once whose selected properties are bound to ordinal columns
+ * the columns are resolved on the first object of each column layout, once for com objects
+ * of the class and once per execution for in-memory rows; every object after that is read by
+ * position in one fetch instead of by name
+ */
+class PreparedQuery {
+    friend class Interface;
+
+   public:
+    /**
+     * position of a selected property
+     * \param name - property name, matched case-insensitively
+     * \returns column for PreparedRow::Get
+     * \throws Exception if the query does not select the property
+     */
+    [[nodiscard]] std::size_t Column(const std::wstring_view name) const {
+        const auto& columns = Columns();
+        for (std::size_t i = 0; i < columns.size(); ++i) {
+            if (EqualsIgnoreCase(columns[i], name)) {
+                return i;
+            }
+        }
+        throw Exception("Property '" + NarrowString(name) + "' is not selected by query '" +
+                        NarrowString(query_) + "'");
+    }
+
+    /**
+     * position of a selected property that will be read as T
+     * the conversion is checked once here against the class schema instead of on every row
+     * \tparam T - type later passed to PreparedRow::Get
+     * \param name - property name, matched case-insensitively
+     * \returns column for PreparedRow::Get<T>
+     * \throws Exception if the query does not select the property or its declared type
+     *         cannot be converted to T
+     */
+    template <typename T>
+    [[nodiscard]] std::size_t Column(const std::wstring_view name) const {
+        const auto column = Column(name);
+        if (const auto* property = GetColumnSchema(column)) {
+            detail::CheckAccepts<T>(*schema_, *property);
+        }
+        return column;
+    }
+
+    /**
+     * declared type of a column
+     * \param column - position of the property in the select list
+     * \returns property schema, nullptr if the backend provides no schema for the class
+     */
+    [[nodiscard]] const PropertySchema* GetColumnSchema(const std::size_t column) const noexcept {
+        return column < properties_.size() ? properties_[column] : nullptr;
+    }
+
+    /**
+     * schema of the queried class, nullptr if the backend cannot describe it
+     */
+    [[nodiscard]] const std::shared_ptr<const ClassSchema>& GetSchema() const noexcept {
+        return schema_;
+    }
+
+    [[nodiscard]] const std::vector<std::wstring>& Columns() const noexcept {
+        return binding_->Columns();
+    }
+
+    [[nodiscard]] const std::wstring& GetQuery() const noexcept { return query_; }
+
+    /**
+     * runs the query
+     * \param options - batching behaviour of the result
+     * \returns rows with every column read
+     * \throws Exception if query execution fails
+     */
+    [[nodiscard]] PreparedResult Execute(const QueryOptions& options = {}) const {
+        return {iface_->ExecuteQuery(query_, options), binding_};
+    }
+
+   private:
+    PreparedQuery(std::shared_ptr<const Interface> iface, const std::wstring_view query)
+        : iface_(std::move(iface)), query_(query) {
+        const auto parsed = ParseWql(query_);
+        if (!parsed) {
+            throw Exception("Cannot prepare malformed query '" + NarrowString(query_) + "'");
+        }
+        if (parsed->properties.empty()) {
+            throw Exception("Cannot prepare query '" + NarrowString(query_) +
+                            "', it needs an explicit property list");
+        }
+        binding_ = std::make_shared<detail::ColumnBinding>(parsed->properties);
+
+        schema_ = iface_->GetSchema(parsed->class_name);
+        if (!schema_) {
+            return;
+        }
+        properties_.reserve(Columns().size());
+        for (const auto& column : Columns()) {
+            const auto* property = schema_->Find(column);
+            if (!property) {
+                throw Exception("Cannot prepare query '" + NarrowString(query_) + "', class '" +
+                                NarrowString(schema_->class_name) + "' has no property '" +
+                                NarrowString(column) + "'");
+            }
+            properties_.push_back(property);
+        }
+    }
+
+    std::shared_ptr<const Interface> iface_;
+    std::wstring query_;
+    std::shared_ptr<detail::ColumnBinding> binding_;
+    std::shared_ptr<const ClassSchema> schema_;
+    // declared type of every column, owned by schema_, empty without a schema
+    std::vector<const PropertySchema*> properties_;
+};
+
+inline PreparedQuery Interface::Prepare(const std::wstring_view query) const {
+    return {shared_from_this(), query};
+}
+
+template <typename T>
+std::vector<T> Interface::Query(const QueryOptions& options) const {
+    constexpr auto binding = detail::BindingOf<T>();
+    const auto prepared = Prepare(detail::SelectText<T>::VALUE);
+    if (const auto& schema = prepared.GetSchema()) {
+        // every member is checked against its property before the first object is fetched
+        std::apply(
+            [&prepared, &schema](const auto&... fields) {
+                std::size_t column = 0;
+                (detail::CheckAccepts<typename std::decay_t<decltype(fields)>::MemberType>(
+                     *schema, *prepared.GetColumnSchema(column++)),
+                 ...);
+            },
+            binding.fields);
+    }
+    const auto result = prepared.Execute(options);
+
+    std::vector<T> objects;
+    for (const auto& row : result) {
+        auto& object = objects.emplace_back();
+        // columns follow the order of the bound members in the generated select list
+        std::apply(
+            [&object, &row](const auto&... fields) {
+                std::size_t column = 0;
+                (detail::AssignField(object.*(fields.member), row.Find(column++)), ...);
+            },
+            binding.fields);
+    }
+    return objects;
+}
+
+namespace detail {
+
+/**
+ * picks the backend used by Interface::Create(path)
+ * \returns native backend of the platform
+ * \throws Exception when the platform has no native backend
+ */
+[[nodiscard]] inline std::shared_ptr<Backend> CreateDefaultBackend() {
+#ifdef _WIN32
+    return std::make_shared<ComBackend>();
+#elif defined(__linux__)
+    auto backend = std::make_shared<CompositeBackend>();
+    backend->Register(L"Win32_OperatingSystem", std::make_shared<MeminfoBackend>());
+    backend->Register(L"Win32_LogicalDisk", std::make_shared<MountinfoBackend>());
+    backend->Register(L"Win32_DiskDrive", std::make_shared<SysBlockBackend>());
+    backend->Register(L"Win32_PhysicalMemory", std::make_shared<SmbiosBackend>());
+    return backend;
+#else
+    throw Exception("No native WMI backend on this platform, pass a backend to Interface::Create");
+#endif
+}
+
+}  // namespace detail
+
+/**
+ * factory implementation that creates interface instances through make_shared
+ * ensures proper memory management and exception safety during construction
+ * \param path - wmi namespace to connect to
+ * \returns shared_ptr to fully initialized interface instance
+ */
+inline std::shared_ptr<Interface> Interface::Create(const std::string_view path) {
+    return Create(detail::CreateDefaultBackend(), path);
+}
+
+inline std::shared_ptr<Interface> Interface::Create(std::shared_ptr<Backend> backend,
+                                                    const std::string_view path) {
+    return std::make_shared<Interface>(PassKey{}, std::move(backend), path);
 }
 
 }  // namespace wmi
\ No newline at end of file
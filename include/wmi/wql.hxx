@@ -0,0 +1,657 @@
+#pragma once
+
+#include <wmi/common.hxx>
+#include <wmi/variant.hxx>
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace wmi {
+
+/**
+ * parsed form of a "SELECT ... FROM ... [WHERE ...]" wql statement
+ * only the data query subset is understood, which is all the providers need
+ */
+struct WqlQuery {
+    std::wstring class_name;
+    std::vector<std::wstring> properties;  // empty for SELECT *
+    std::wstring where;                    // raw condition text, empty when absent
+};
+
+namespace detail {
+
+[[nodiscard]] constexpr bool IsWqlSpace(const wchar_t ch) noexcept {
+    return ch == L' ' || ch == L'\t' || ch == L'\r' || ch == L'\n';
+}
+
+[[nodiscard]] constexpr bool IsWqlIdentifier(const wchar_t ch) noexcept {
+    return (ch >= L'a' && ch <= L'z') || (ch >= L'A' && ch <= L'Z') || (ch >= L'0' && ch <= L'9') ||
+           ch == L'_';
+}
+
+/**
+ * minimal cursor over wql text used by the parser
+ */
+class WqlReader {
+   public:
+    explicit WqlReader(const std::wstring_view text) : text_(text) {}
+
+    void SkipSpace() noexcept {
+        while (position_ < text_.size() && IsWqlSpace(text_[position_])) {
+            ++position_;
+        }
+    }
+
+    [[nodiscard]] std::wstring_view Identifier() noexcept {
+        SkipSpace();
+        const auto start = position_;
+        while (position_ < text_.size() && IsWqlIdentifier(text_[position_])) {
+            ++position_;
+        }
+        return text_.substr(start, position_ - start);
+    }
+
+    [[nodiscard]] bool Keyword(const std::wstring_view keyword) noexcept {
+        const auto saved = position_;
+        if (EqualsIgnoreCase(Identifier(), keyword)) {
+            return true;
+        }
+        position_ = saved;
+        return false;
+    }
+
+    [[nodiscard]] bool Symbol(const wchar_t symbol) noexcept {
+        SkipSpace();
+        if (position_ < text_.size() && text_[position_] == symbol) {
+            ++position_;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * comparison operator at the cursor
+     * \returns operator text, empty if there is none
+     */
+    [[nodiscard]] std::wstring_view Operator() noexcept {
+        SkipSpace();
+        for (const std::wstring_view op : {L"<=", L">=", L"<>", L"!=", L"=", L"<", L">"}) {
+            if (text_.substr(position_, op.size()) == op) {
+                position_ += op.size();
+                return op;
+            }
+        }
+        return {};
+    }
+
+    /**
+     * quoted string literal at the cursor, a backslash escapes the next character
+     * \returns unescaped text, nullopt if there is no complete literal
+     */
+    [[nodiscard]] std::optional<std::wstring> Quoted() {
+        SkipSpace();
+        if (position_ >= text_.size() || (text_[position_] != L'\'' && text_[position_] != L'"')) {
+            return std::nullopt;
+        }
+        const auto saved = position_;
+        const auto quote = text_[position_++];
+        std::wstring value;
+        while (position_ < text_.size()) {
+            auto ch = text_[position_++];
+            if (ch == quote) {
+                return value;
+            }
+            if (ch == L'\\' && position_ < text_.size()) {
+                ch = text_[position_++];
+            }
+            value.push_back(ch);
+        }
+        position_ = saved;
+        return std::nullopt;
+    }
+
+    /**
+     * numeric literal at the cursor: optional sign, digits, fraction and exponent
+     * \returns text of the number, empty if there is none
+     */
+    [[nodiscard]] std::wstring_view Number() noexcept {
+        SkipSpace();
+        const auto start = position_;
+        const auto at = [this](const wchar_t first, const wchar_t second) {
+            return position_ < text_.size() &&
+                   (text_[position_] == first || text_[position_] == second);
+        };
+        const auto digits = [this] {
+            const auto first = position_;
+            while (position_ < text_.size() && text_[position_] >= L'0' &&
+                   text_[position_] <= L'9') {
+                ++position_;
+            }
+            return position_ - first;
+        };
+
+        if (at(L'-', L'+')) {
+            ++position_;
+        }
+        auto mantissa = digits();
+        if (at(L'.', L'.')) {
+            ++position_;
+            mantissa += digits();
+        }
+        if (mantissa == 0) {
+            position_ = start;
+            return {};
+        }
+        if (at(L'e', L'E')) {
+            const auto exponent = position_++;
+            if (at(L'-', L'+')) {
+                ++position_;
+            }
+            if (digits() == 0) {
+                position_ = exponent;
+            }
+        }
+        return text_.substr(start, position_ - start);
+    }
+
+    [[nodiscard]] bool AtEnd() noexcept {
+        SkipSpace();
+        return position_ == text_.size();
+    }
+
+    [[nodiscard]] std::wstring_view Rest() noexcept {
+        SkipSpace();
+        auto rest = text_.substr(position_);
+        while (!rest.empty() && IsWqlSpace(rest.back())) {
+            rest.remove_suffix(1);
+        }
+        position_ = text_.size();
+        return rest;
+    }
+
+   private:
+    std::wstring_view text_;
+    std::size_t position_ = 0;
+};
+
+/**
+ * number taken from a property or literal, kept exact for 64-bit integers
+ */
+struct WqlNumber {
+    enum class Kind { Signed, Unsigned, Real };
+
+    Kind kind = Kind::Signed;
+    std::int64_t signed_value = 0;
+    std::uint64_t unsigned_value = 0;
+    double real_value = 0.0;
+
+    [[nodiscard]] double AsReal() const noexcept {
+        switch (kind) {
+            case Kind::Signed:
+                return static_cast<double>(signed_value);
+            case Kind::Unsigned:
+                return static_cast<double>(unsigned_value);
+            default:
+                return real_value;
+        }
+    }
+};
+
+[[nodiscard]] inline std::optional<WqlNumber> ParseWqlNumber(const WideString& text) {
+    WqlNumber number;
+    if (const auto value = ParseNumber<std::int64_t>(text)) {
+        number.signed_value = *value;
+    } else if (const auto value = ParseNumber<std::uint64_t>(text)) {
+        number.kind = WqlNumber::Kind::Unsigned;
+        number.unsigned_value = *value;
+    } else if (const auto value = ParseNumber<double>(text)) {
+        number.kind = WqlNumber::Kind::Real;
+        number.real_value = *value;
+    } else {
+        return std::nullopt;
+    }
+    return number;
+}
+
+/**
+ * numeric view of a value; wmi hands 64-bit integers out as strings, so numeric text counts
+ */
+[[nodiscard]] inline std::optional<WqlNumber> ToWqlNumber(const Variant& value) {
+    WqlNumber number;
+    if (const auto* boolean = value.GetIf<bool>()) {
+        number.signed_value = *boolean ? 1 : 0;
+    } else if (const auto* integer = value.GetIf<std::int64_t>()) {
+        number.signed_value = *integer;
+    } else if (const auto* natural = value.GetIf<std::uint64_t>()) {
+        number.kind = WqlNumber::Kind::Unsigned;
+        number.unsigned_value = *natural;
+    } else if (const auto* real = value.GetIf<double>()) {
+        number.kind = WqlNumber::Kind::Real;
+        number.real_value = *real;
+    } else if (const auto* text = value.GetIf<WideString>()) {
+        if (EqualsIgnoreCase(text->View(), L"true") || EqualsIgnoreCase(text->View(), L"false")) {
+            number.signed_value = EqualsIgnoreCase(text->View(), L"true") ? 1 : 0;
+        } else {
+            return ParseWqlNumber(*text);
+        }
+    } else {
+        return std::nullopt;
+    }
+    return number;
+}
+
+template <typename T>
+[[nodiscard]] constexpr int ThreeWay(const T lhs, const T rhs) noexcept {
+    return lhs < rhs ? -1 : (rhs < lhs ? 1 : 0);
+}
+
+[[nodiscard]] inline int CompareWqlNumbers(const WqlNumber& lhs, const WqlNumber& rhs) noexcept {
+    using Kind = WqlNumber::Kind;
+    if (lhs.kind == Kind::Real || rhs.kind == Kind::Real) {
+        return ThreeWay(lhs.AsReal(), rhs.AsReal());
+    }
+    if (lhs.kind == Kind::Signed && rhs.kind == Kind::Signed) {
+        return ThreeWay(lhs.signed_value, rhs.signed_value);
+    }
+    // at least one side is unsigned, a negative value is smaller than any of them
+    if (lhs.kind == Kind::Signed && lhs.signed_value < 0) {
+        return -1;
+    }
+    if (rhs.kind == Kind::Signed && rhs.signed_value < 0) {
+        return 1;
+    }
+    const auto left = lhs.kind == Kind::Signed ? static_cast<std::uint64_t>(lhs.signed_value)
+                                               : lhs.unsigned_value;
+    const auto right = rhs.kind == Kind::Signed ? static_cast<std::uint64_t>(rhs.signed_value)
+                                                : rhs.unsigned_value;
+    return ThreeWay(left, right);
+}
+
+[[nodiscard]] constexpr wchar_t FoldWqlCase(const wchar_t ch) noexcept {
+    return ch >= L'A' && ch <= L'Z' ? static_cast<wchar_t>(ch - L'A' + L'a') : ch;
+}
+
+[[nodiscard]] inline int CompareWqlText(const std::wstring_view lhs,
+                                        const std::wstring_view rhs) noexcept {
+    const auto common = lhs.size() < rhs.size() ? lhs.size() : rhs.size();
+    for (std::size_t i = 0; i < common; ++i) {
+        const auto a = FoldWqlCase(lhs[i]);
+        const auto b = FoldWqlCase(rhs[i]);
+        if (a != b) {
+            return a < b ? -1 : 1;
+        }
+    }
+    return ThreeWay(lhs.size(), rhs.size());
+}
+
+/**
+ * orders a property value against a literal the way wmi coerces them
+ * \returns negative, zero or positive, nullopt when the two cannot be compared
+ */
+[[nodiscard]] inline std::optional<int> CompareWql(const Variant& value, const Variant& literal) {
+    const auto* value_text = value.GetIf<WideString>();
+    const auto* literal_text = literal.GetIf<WideString>();
+    if (value_text && literal_text) {
+        return CompareWqlText(value_text->View(), literal_text->View());
+    }
+
+    const auto lhs = ToWqlNumber(value);
+    const auto rhs = ToWqlNumber(literal);
+    if (!lhs || !rhs) {
+        return std::nullopt;
+    }
+    return CompareWqlNumbers(*lhs, *rhs);
+}
+
+}  // namespace detail
+
+/**
+ * WHERE condition of a wql query, evaluated on the client by providers without a query engine
+ * understands comparisons between a property and a literal, IS [NOT] NULL, AND, OR, NOT and
+ * parentheses; string comparisons ignore case and numeric text compares as a number, like wmi
+ */
+class WqlCondition {
+   public:
+    enum class Operator { Equal, NotEqual, Less, LessEqual, Greater, GreaterEqual };
+
+    /**
+     * \param text - condition text, the part after WHERE
+     * \returns condition, nullopt if the text uses anything beyond the supported subset
+     */
+    [[nodiscard]] static std::optional<WqlCondition> Parse(const std::wstring_view text) {
+        WqlCondition condition;
+        detail::WqlReader reader(text);
+        const auto root = condition.ParseOr(reader);
+        if (!root || !reader.AtEnd()) {
+            return std::nullopt;
+        }
+        condition.root_ = *root;
+        return condition;
+    }
+
+    /**
+     * evaluates the condition for one object
+     * \param find - callable mapping a property name to a const Variant*, nullptr when absent
+     * \returns true if the object satisfies the condition
+     */
+    template <typename Find>
+    [[nodiscard]] bool Matches(const Find& find) const {
+        return Evaluate(root_, find);
+    }
+
+    /**
+     * names of the properties the condition refers to, each listed once
+     */
+    [[nodiscard]] const std::vector<std::wstring>& Properties() const noexcept {
+        return properties_;
+    }
+
+   private:
+    struct Node {
+        enum class Kind { And, Or, Not, Compare, IsNull };
+
+        Kind kind = Kind::Compare;
+        Operator op = Operator::Equal;
+        std::size_t left = 0;
+        std::size_t right = 0;
+        std::wstring property;
+        Variant literal;
+    };
+
+    WqlCondition() = default;
+
+    std::size_t Add(Node node) {
+        nodes_.push_back(std::move(node));
+        return nodes_.size() - 1;
+    }
+
+    std::optional<std::size_t> ParseOr(detail::WqlReader& reader) {
+        auto left = ParseAnd(reader);
+        while (left && reader.Keyword(L"OR")) {
+            const auto right = ParseAnd(reader);
+            if (!right) {
+                return std::nullopt;
+            }
+            Node node;
+            node.kind = Node::Kind::Or;
+            node.left = *left;
+            node.right = *right;
+            left = Add(std::move(node));
+        }
+        return left;
+    }
+
+    std::optional<std::size_t> ParseAnd(detail::WqlReader& reader) {
+        auto left = ParseNot(reader);
+        while (left && reader.Keyword(L"AND")) {
+            const auto right = ParseNot(reader);
+            if (!right) {
+                return std::nullopt;
+            }
+            Node node;
+            node.kind = Node::Kind::And;
+            node.left = *left;
+            node.right = *right;
+            left = Add(std::move(node));
+        }
+        return left;
+    }
+
+    std::optional<std::size_t> ParseNot(detail::WqlReader& reader) {
+        if (reader.Keyword(L"NOT")) {
+            const auto operand = ParseNot(reader);
+            if (!operand) {
+                return std::nullopt;
+            }
+            Node node;
+            node.kind = Node::Kind::Not;
+            node.left = *operand;
+            return Add(std::move(node));
+        }
+        if (reader.Symbol(L'(')) {
+            const auto inner = ParseOr(reader);
+            if (!inner || !reader.Symbol(L')')) {
+                return std::nullopt;
+            }
+            return inner;
+        }
+        return ParseComparison(reader);
+    }
+
+    std::optional<std::size_t> ParseComparison(detail::WqlReader& reader) {
+        Node node;
+        node.property = reader.Identifier();
+        if (node.property.empty()) {
+            return std::nullopt;
+        }
+        Reference(node.property);
+
+        if (reader.Keyword(L"IS")) {
+            const bool negated = reader.Keyword(L"NOT");
+            if (!reader.Keyword(L"NULL")) {
+                return std::nullopt;
+            }
+            node.kind = Node::Kind::IsNull;
+            return negated ? Negate(Add(std::move(node))) : Add(std::move(node));
+        }
+
+        const auto op = reader.Operator();
+        if (op.empty()) {
+            return std::nullopt;
+        }
+        node.op = op == L"=" ? Operator::Equal
+                  : op == L"<" ? Operator::Less
+                  : op == L"<=" ? Operator::LessEqual
+                  : op == L">" ? Operator::Greater
+                  : op == L">=" ? Operator::GreaterEqual
+                                : Operator::NotEqual;
+
+        if (auto text = reader.Quoted()) {
+            node.literal = Variant(std::wstring_view(*text));
+        } else if (const auto number = reader.Number(); !number.empty()) {
+            const auto parsed = detail::ParseWqlNumber(WideString(number));
+            if (!parsed) {
+                return std::nullopt;
+            }
+            switch (parsed->kind) {
+                case detail::WqlNumber::Kind::Signed:
+                    node.literal = Variant(parsed->signed_value);
+                    break;
+                case detail::WqlNumber::Kind::Unsigned:
+                    node.literal = Variant(parsed->unsigned_value);
+                    break;
+                default:
+                    node.literal = Variant(parsed->real_value);
+                    break;
+            }
+        } else if (reader.Keyword(L"TRUE")) {
+            node.literal = Variant(true);
+        } else if (reader.Keyword(L"FALSE")) {
+            node.literal = Variant(false);
+        } else if (reader.Keyword(L"NULL")) {
+            // "= NULL" tests for a missing value like IS NULL does
+            if (node.op != Operator::Equal && node.op != Operator::NotEqual) {
+                return std::nullopt;
+            }
+            const bool negated = node.op == Operator::NotEqual;
+            node.kind = Node::Kind::IsNull;
+            return negated ? Negate(Add(std::move(node))) : Add(std::move(node));
+        } else {
+            return std::nullopt;
+        }
+
+        node.kind = Node::Kind::Compare;
+        return Add(std::move(node));
+    }
+
+    std::size_t Negate(const std::size_t operand) {
+        Node node;
+        node.kind = Node::Kind::Not;
+        node.left = operand;
+        return Add(std::move(node));
+    }
+
+    void Reference(const std::wstring_view property) {
+        for (const auto& existing : properties_) {
+            if (EqualsIgnoreCase(existing, property)) {
+                return;
+            }
+        }
+        properties_.emplace_back(property);
+    }
+
+    template <typename Find>
+    [[nodiscard]] bool Evaluate(const std::size_t index, const Find& find) const {
+        const auto& node = nodes_[index];
+        switch (node.kind) {
+            case Node::Kind::And:
+                return Evaluate(node.left, find) && Evaluate(node.right, find);
+            case Node::Kind::Or:
+                return Evaluate(node.left, find) || Evaluate(node.right, find);
+            case Node::Kind::Not:
+                return !Evaluate(node.left, find);
+            case Node::Kind::IsNull: {
+                const Variant* value = find(std::wstring_view(node.property));
+                return !value || value->IsEmpty();
+            }
+            default:
+                break;
+        }
+
+        const Variant* value = find(std::wstring_view(node.property));
+        if (!value || value->IsEmpty()) {
+            // null compares false with everything
+            return false;
+        }
+        const auto order = detail::CompareWql(*value, node.literal);
+        if (!order) {
+            return false;
+        }
+        switch (node.op) {
+            case Operator::Equal:
+                return *order == 0;
+            case Operator::NotEqual:
+                return *order != 0;
+            case Operator::Less:
+                return *order < 0;
+            case Operator::LessEqual:
+                return *order <= 0;
+            case Operator::Greater:
+                return *order > 0;
+            default:
+                return *order >= 0;
+        }
+    }
+
+    std::vector<Node> nodes_;
+    std::size_t root_ = 0;
+    std::vector<std::wstring> properties_;
+};
+
+/**
+ * parses a wql data query
+ * \param text - query text
+ * \returns parsed query, nullopt if the text is not a supported select statement
+ */
+[[nodiscard]] inline std::optional<WqlQuery> ParseWql(const std::wstring_view text) {
+    detail::WqlReader reader(text);
+    if (!reader.Keyword(L"SELECT")) {
+        return std::nullopt;
+    }
+
+    WqlQuery query;
+    if (!reader.Symbol(L'*')) {
+        do {
+            const auto property = reader.Identifier();
+            if (property.empty()) {
+                return std::nullopt;
+            }
+            query.properties.emplace_back(property);
+        } while (reader.Symbol(L','));
+    }
+
+    if (!reader.Keyword(L"FROM")) {
+        return std::nullopt;
+    }
+
+    query.class_name = reader.Identifier();
+    if (query.class_name.empty()) {
+        return std::nullopt;
+    }
+
+    if (reader.Keyword(L"WHERE")) {
+        query.where = reader.Rest();
+        if (query.where.empty()) {
+            return std::nullopt;
+        }
+    }
+
+    if (!reader.AtEnd()) {
+        return std::nullopt;
+    }
+    return query;
+}
+
+/**
+ * writes a parsed data query back as wql text
+ * \param query - class, selected properties and condition
+ * \returns "SELECT ... FROM ... [WHERE ...]"
+ */
+[[nodiscard]] inline std::wstring FormatWql(const WqlQuery& query) {
+    std::wstring text = L"SELECT ";
+    if (query.properties.empty()) {
+        text += L'*';
+    }
+    for (std::size_t i = 0; i < query.properties.size(); ++i) {
+        if (i != 0) {
+            text += L", ";
+        }
+        text += query.properties[i];
+    }
+    text += L" FROM ";
+    text += query.class_name;
+    if (!query.where.empty()) {
+        text += L" WHERE ";
+        text += query.where;
+    }
+    return text;
+}
+
+/**
+ * WHERE condition of a query answered by a provider that filters its rows itself
+ * \param query - full query text, quoted in errors
+ * \param parsed - the parsed query
+ * \param serves - callable telling whether the provider has a property of the given name
+ * \returns condition, nullopt if the query has no WHERE clause
+ * \throws Exception if the condition is beyond the supported subset or names a property
+ *         the provider does not serve
+ */
+template <typename Serves>
+[[nodiscard]] std::optional<WqlCondition> ParseWqlWhere(const std::wstring_view query,
+                                                        const WqlQuery& parsed,
+                                                        const Serves& serves) {
+    if (parsed.where.empty()) {
+        return std::nullopt;
+    }
+
+    auto condition = WqlCondition::Parse(parsed.where);
+    if (!condition) {
+        throw Exception("WQL query execution failed for query: '" + NarrowString(query) + "'. " +
+                        FormatHResultError("Unsupported condition", status::InvalidQuery));
+    }
+    for (const auto& property : condition->Properties()) {
+        if (!serves(property)) {
+            throw Exception("WQL query execution failed for query: '" + NarrowString(query) +
+                            "'. " + FormatHResultError("Unknown property", status::InvalidQuery));
+        }
+    }
+    return condition;
+}
+
+}  // namespace wmi
@@ -1,13 +1,16 @@
-#include <comdef.h>
-
 #include <chrono>
+#include <future>
 #include <iostream>
 #include <memory>
 #include <stdexcept>
+#include <utility>
+#include <wmi/batch.hxx>
 #include <wmi/wmi.hxx>
 
-void QueryMemoryInfo(std::shared_ptr<const wmi::Interface> wmi_interface);
-void QueryStorageInfo(std::shared_ptr<const wmi::Interface> wmi_interface);
+void QueryMemoryInfo(std::future<wmi::BatchResult> os_query,
+                     std::future<wmi::BatchResult> memory_query);
+void QueryStorageInfo(std::future<wmi::BatchResult> disk_query,
+                      std::future<wmi::BatchResult> physical_disk_query);
 
 int main() {
     try {
@@ -15,6 +18,7 @@ int main() {
 
         const auto start_time = std::chrono::high_resolution_clock::now();
 
+#ifdef _WIN32
         wmi::COMInitializer com_init(COINIT_MULTITHREADED);
 
         if (com_init.IsInitialized()) {
@@ -24,6 +28,7 @@ int main() {
                       << std::endl;
         }
         std::cout << std::endl;
+#endif
 
         auto wmi_interface = wmi::Interface::Create("cimv2");
         if (!wmi_interface) {
@@ -33,12 +38,24 @@ int main() {
 
         std::cout << "WMI interface created successfully!\n" << std::endl;
 
+        // the four queries are independent, run them side by side so the total time
+        // is close to the slowest query instead of the sum of all of them
+        wmi::Batch batch(wmi_interface);
+        auto os_query = batch.Add(
+            L"SELECT TotalVisibleMemorySize, FreePhysicalMemory FROM Win32_OperatingSystem");
+        auto memory_query = batch.Add(
+            L"SELECT Capacity, Speed, Manufacturer, PartNumber FROM Win32_PhysicalMemory");
+        auto disk_query = batch.Add(
+            L"SELECT DeviceID, Size, FreeSpace, FileSystem, DriveType FROM Win32_LogicalDisk");
+        auto physical_disk_query =
+            batch.Add(L"SELECT Model, Size, MediaType, InterfaceType FROM Win32_DiskDrive");
+
         std::cout << "Memory Information" << std::endl;
-        QueryMemoryInfo(wmi_interface);
+        QueryMemoryInfo(std::move(os_query), std::move(memory_query));
         std::cout << std::endl;
 
         std::cout << "Storage Information" << std::endl;
-        QueryStorageInfo(wmi_interface);
+        QueryStorageInfo(std::move(disk_query), std::move(physical_disk_query));
         std::cout << std::endl;
 
         const auto end_time = std::chrono::high_resolution_clock::now();
@@ -1,21 +1,27 @@
+#include <chrono>
+#include <cstdint>
+#include <future>
 #include <iomanip>
 #include <iostream>
 #include <memory>
+#include <wmi/batch.hxx>
 #include <wmi/wmi.hxx>
 
-void QueryMemoryInfo(std::shared_ptr<const wmi::Interface> wmi_interface) {
+void QueryMemoryInfo(std::future<wmi::BatchResult> os_query,
+                     std::future<wmi::BatchResult> memory_query) {
     try {
-        std::cout << "Querying operating system memory information..." << std::endl;
-        auto os_result = wmi_interface->ExecuteQuery(
-            L"SELECT TotalVisibleMemorySize, FreePhysicalMemory FROM Win32_OperatingSystem");
+        const auto os_result = os_query.get();
+        const auto os_ms =
+            std::chrono::duration_cast<std::chrono::milliseconds>(os_result.elapsed).count();
+        std::cout << "Operating system memory information (" << os_ms << " ms):" << std::endl;
 
-        for (const auto& os_obj : os_result) {
-            auto total_memory = os_obj.GetProperty<std::string>(L"TotalVisibleMemorySize");
-            auto free_memory = os_obj.GetProperty<std::string>(L"FreePhysicalMemory");
+        for (const auto& os_obj : os_result.objects) {
+            auto total_memory = os_obj.GetProperty<std::uint64_t>(L"TotalVisibleMemorySize");
+            auto free_memory = os_obj.GetProperty<std::uint64_t>(L"FreePhysicalMemory");
 
             if (total_memory && free_memory) {
-                double total_mb = std::stod(*total_memory) / 1024.0;
-                double free_mb = std::stod(*free_memory) / 1024.0;
+                double total_mb = static_cast<double>(*total_memory) / 1024.0;
+                double free_mb = static_cast<double>(*free_memory) / 1024.0;
                 double used_mb = total_mb - free_mb;
                 double usage_percent = (used_mb / total_mb) * 100.0;
 
@@ -29,15 +35,16 @@ void QueryMemoryInfo(std::shared_ptr<const wmi::Interface> wmi_interface) {
 
         std::cout << std::endl;
 
-        std::cout << "Querying physical memory modules..." << std::endl;
-        auto memory_result = wmi_interface->ExecuteQuery(
-            L"SELECT Capacity, Speed, Manufacturer, PartNumber FROM Win32_PhysicalMemory");
+        const auto memory_result = memory_query.get();
+        const auto memory_ms =
+            std::chrono::duration_cast<std::chrono::milliseconds>(memory_result.elapsed).count();
+        std::cout << "Physical memory modules (" << memory_ms << " ms):" << std::endl;
 
         int module_count = 0;
-        for (const auto& memory_obj : memory_result) {
+        for (const auto& memory_obj : memory_result.objects) {
             module_count++;
 
-            auto capacity = memory_obj.GetProperty<std::string>(L"Capacity");
+            auto capacity = memory_obj.GetProperty<std::uint64_t>(L"Capacity");
             auto speed = memory_obj.GetProperty<std::string>(L"Speed");
             auto manufacturer = memory_obj.GetProperty<std::string>(L"Manufacturer");
             auto part_number = memory_obj.GetProperty<std::string>(L"PartNumber");
@@ -45,7 +52,8 @@ void QueryMemoryInfo(std::shared_ptr<const wmi::Interface> wmi_interface) {
             std::cout << "  Module " << module_count << ":" << std::endl;
 
             if (capacity) {
-                double capacity_gb = std::stod(*capacity) / (1024.0 * 1024.0 * 1024.0);
+                double capacity_gb =
+                    static_cast<double>(*capacity) / (1024.0 * 1024.0 * 1024.0);
                 std::cout << "    Capacity: " << std::fixed << std::setprecision(1) << capacity_gb
                           << " GB" << std::endl;
             }
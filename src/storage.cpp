@@ -1,27 +1,34 @@
+#include <chrono>
+#include <cstdint>
+#include <future>
 #include <iomanip>
 #include <iostream>
 #include <memory>
+#include <wmi/batch.hxx>
 #include <wmi/wmi.hxx>
 
-void QueryStorageInfo(std::shared_ptr<const wmi::Interface> wmi_interface) {
+void QueryStorageInfo(std::future<wmi::BatchResult> disk_query,
+                      std::future<wmi::BatchResult> physical_disk_query) {
     try {
-        std::cout << "Querying logical disk information..." << std::endl;
-        auto disk_result = wmi_interface->ExecuteQuery(
-            L"SELECT DeviceID, Size, FreeSpace, FileSystem, DriveType FROM Win32_LogicalDisk");
+        const auto disk_result = disk_query.get();
+        const auto disk_ms =
+            std::chrono::duration_cast<std::chrono::milliseconds>(disk_result.elapsed).count();
+        std::cout << "Logical disk information (" << disk_ms << " ms):" << std::endl;
 
-        for (const auto& disk_obj : disk_result) {
+        for (const auto& disk_obj : disk_result.objects) {
             auto device_id = disk_obj.GetProperty<std::string>(L"DeviceID");
-            auto size = disk_obj.GetProperty<std::string>(L"Size");
-            auto free_space = disk_obj.GetProperty<std::string>(L"FreeSpace");
+            auto size = disk_obj.GetProperty<std::uint64_t>(L"Size");
+            auto free_space = disk_obj.GetProperty<std::uint64_t>(L"FreeSpace");
             auto file_system = disk_obj.GetProperty<std::string>(L"FileSystem");
-            auto drive_type = disk_obj.GetProperty<std::string>(L"DriveType");
+            auto drive_type = disk_obj.GetProperty<std::uint32_t>(L"DriveType");
 
             if (device_id) {
                 std::cout << "  Drive " << *device_id << ":" << std::endl;
 
                 if (size && free_space) {
-                    double size_gb = std::stod(*size) / (1024.0 * 1024.0 * 1024.0);
-                    double free_gb = std::stod(*free_space) / (1024.0 * 1024.0 * 1024.0);
+                    double size_gb = static_cast<double>(*size) / (1024.0 * 1024.0 * 1024.0);
+                    double free_gb =
+                        static_cast<double>(*free_space) / (1024.0 * 1024.0 * 1024.0);
                     double used_gb = size_gb - free_gb;
                     double usage_percent = (used_gb / size_gb) * 100.0;
 
@@ -38,8 +45,7 @@ void QueryStorageInfo(std::shared_ptr<const wmi::Interface> wmi_interface) {
 
                 if (drive_type) {
                     std::string type_name;
-                    int type_code = std::stoi(*drive_type);
-                    switch (type_code) {
+                    switch (*drive_type) {
                         case 0:
                             type_name = "Unknown";
                             break;
@@ -74,16 +80,18 @@ void QueryStorageInfo(std::shared_ptr<const wmi::Interface> wmi_interface) {
 
         std::cout << std::endl;
 
-        std::cout << "Querying physical disk information..." << std::endl;
-        auto physical_disk_result = wmi_interface->ExecuteQuery(
-            L"SELECT Model, Size, MediaType, InterfaceType FROM Win32_DiskDrive");
+        const auto physical_disk_result = physical_disk_query.get();
+        const auto physical_disk_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                          physical_disk_result.elapsed)
+                                          .count();
+        std::cout << "Physical disk information (" << physical_disk_ms << " ms):" << std::endl;
 
         int disk_count = 0;
-        for (const auto& physical_disk_obj : physical_disk_result) {
+        for (const auto& physical_disk_obj : physical_disk_result.objects) {
             disk_count++;
 
             auto model = physical_disk_obj.GetProperty<std::string>(L"Model");
-            auto size = physical_disk_obj.GetProperty<std::string>(L"Size");
+            auto size = physical_disk_obj.GetProperty<std::uint64_t>(L"Size");
             auto media_type = physical_disk_obj.GetProperty<std::string>(L"MediaType");
             auto interface_type = physical_disk_obj.GetProperty<std::string>(L"InterfaceType");
 
@@ -94,7 +102,7 @@ void QueryStorageInfo(std::shared_ptr<const wmi::Interface> wmi_interface) {
             }
 
             if (size) {
-                double size_gb = std::stod(*size) / (1024.0 * 1024.0 * 1024.0);
+                double size_gb = static_cast<double>(*size) / (1024.0 * 1024.0 * 1024.0);
                 std::cout << "    Size: " << std::fixed << std::setprecision(2) << size_gb << " GB"
                           << std::endl;
             }
@@ -0,0 +1,268 @@
+#include "check.hxx"
+
+#include <wmi/backend/fake.hxx>
+#include <wmi/backend/synthetic.hxx>
+#include <wmi/queue.hxx>
+#include <wmi/wmi.hxx>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::vector<wmi::RowPtr> MakeRows(const std::size_t count) {
+    const auto columns = std::make_shared<const wmi::MemoryRow::Columns>(
+        wmi::MemoryRow::Columns{L"Index"});
+    std::vector<wmi::RowPtr> rows;
+    for (std::size_t i = 0; i < count; ++i) {
+        rows.push_back(std::make_shared<wmi::MemoryRow>(
+            columns, std::vector<wmi::Variant>{wmi::Variant(static_cast<std::uint64_t>(i))}));
+    }
+    return rows;
+}
+
+std::uint64_t IndexOf(const wmi::RowPtr& row) {
+    return wmi::ConvertVariant<std::uint64_t>(*row->Find(L"Index")).value_or(UINT64_MAX);
+}
+
+std::shared_ptr<wmi::Interface> MakeFake(const int count) {
+    auto fake = std::make_shared<wmi::FakeBackend>();
+    for (int i = 0; i < count; ++i) {
+        fake->AddObject(L"Win32_Fake", {{L"Index", wmi::Variant(i)}});
+    }
+    return wmi::Interface::Create(fake);
+}
+
+void TestBoundedQueue() {
+    wmi::BoundedQueue<int> queue(3);
+    CHECK(queue.Capacity() == 4);
+    CHECK(!queue.TryPop());
+
+    for (int i = 0; i < 4; ++i) {
+        CHECK(queue.TryPush(i));
+    }
+    int extra = 4;
+    CHECK(!queue.TryPush(extra));
+    CHECK(extra == 4);
+    CHECK(queue.SizeApprox() == 4);
+
+    for (int i = 0; i < 4; ++i) {
+        const auto value = queue.TryPop();
+        CHECK(value && *value == i);
+    }
+    CHECK(!queue.TryPop());
+}
+
+void TestBoundedQueueConcurrent() {
+    constexpr int THREADS = 4;
+    constexpr int PER_THREAD = 20000;
+
+    wmi::BoundedQueue<int> queue(64);
+    std::atomic<long long> sum{0};
+    std::atomic<int> popped{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&queue, t] {
+            for (int i = 1; i <= PER_THREAD; ++i) {
+                int value = t * PER_THREAD + i;
+                while (!queue.TryPush(value)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        threads.emplace_back([&queue, &sum, &popped] {
+            while (popped.load() < THREADS * PER_THREAD) {
+                if (const auto value = queue.TryPop()) {
+                    sum += *value;
+                    ++popped;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const long long total = static_cast<long long>(THREADS) * PER_THREAD;
+    CHECK(popped.load() == total);
+    CHECK(sum.load() == total * (total + 1) / 2);
+}
+
+void TestQueueSinkBackpressure() {
+    auto signal = std::make_shared<wmi::detail::Signal>();
+    wmi::detail::QueueSink sink(2, signal);
+    auto rows = MakeRows(16);
+
+    std::atomic<bool> returned{false};
+    std::thread producer([&] {
+        sink.Indicate(rows);
+        returned = true;
+    });
+
+    // the queue holds two rows, the producer waits for the consumer
+    CHECK(test::Eventually([&sink] { return !sink.IsEmpty(); }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK(!returned.load());
+
+    std::uint64_t expected = 0;
+    while (expected < 16) {
+        if (const auto row = sink.TryPop()) {
+            CHECK(IndexOf(*row) == expected);
+            ++expected;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    CHECK(returned.load());
+    CHECK(sink.IsEmpty());
+}
+
+void TestQueueSinkAbandon() {
+    auto signal = std::make_shared<wmi::detail::Signal>();
+    wmi::detail::QueueSink sink(2, signal);
+    auto rows = MakeRows(16);
+
+    std::thread producer([&] { sink.Indicate(rows); });
+    CHECK(test::Eventually([&sink] { return !sink.IsEmpty(); }));
+
+    // without the wakeup the join below never returns
+    sink.Abandon();
+    producer.join();
+
+    std::size_t left = 0;
+    while (sink.TryPop()) {
+        ++left;
+    }
+    CHECK(left <= 2);
+}
+
+void TestAsyncQueryDelivers() {
+    const auto iface = MakeFake(100);
+    const auto query = iface->ExecuteQueryAsync(L"SELECT Index FROM Win32_Fake", 4);
+
+    int expected = 0;
+    while (const auto object = query->Next()) {
+        CHECK(object->GetProperty<int>(L"Index") == expected);
+        ++expected;
+    }
+    CHECK(expected == 100);
+    CHECK(query->IsDone());
+    CHECK(query->GetStatus() == wmi::status::Ok);
+    CHECK(!query->GetError());
+}
+
+void TestAsyncQueryCancelWithFullQueue() {
+    wmi::SyntheticOptions options;
+    options.row_count = 100000;
+    const auto iface = wmi::Interface::Create(std::make_shared<wmi::SyntheticBackend>(options));
+
+    const auto query = iface->ExecuteQueryAsync(L"SELECT Index FROM Win32_Synthetic", 2);
+    CHECK(query->Next().has_value());
+    // the provider is blocked on the full queue, cancelling has to release it
+    query->Cancel();
+    CHECK(query->GetStatus() == wmi::status::Cancelled);
+}
+
+void TestAsyncQueryCancellationToken() {
+    const auto iface = MakeFake(1000);
+    wmi::CancellationSource source;
+    const auto query =
+        iface->ExecuteQueryAsync(L"SELECT Index FROM Win32_Fake", source.GetToken(), 2);
+    CHECK(query->Next().has_value());
+    source.Cancel();
+    CHECK(query->GetStatus() == wmi::status::Cancelled);
+}
+
+void TestAsyncQueryFailure() {
+    wmi::SyntheticOptions options;
+    options.row_count = 100;
+    options.failure_after_rows = 30;
+    options.failure_code = wmi::status::AccessDenied;
+    const auto iface = wmi::Interface::Create(std::make_shared<wmi::SyntheticBackend>(options));
+
+    const auto query = iface->ExecuteQueryAsync(L"SELECT Index FROM Win32_Synthetic", 8);
+    std::size_t count = 0;
+    while (query->Next()) {
+        ++count;
+    }
+    CHECK(count <= 30);
+    CHECK(query->GetStatus() == wmi::status::AccessDenied);
+}
+
+void TestAsyncQueryInvalidQuery() {
+    const auto iface = MakeFake(1);
+    const auto query = iface->ExecuteQueryAsync(L"SELECT Missing FROM Win32_Fake");
+    CHECK(!query->Next());
+    CHECK(query->GetStatus() == wmi::status::Failed);
+    CHECK(query->GetError() != nullptr);
+}
+
+void TestDispatcher() {
+    const auto iface = MakeFake(50);
+    wmi::AsyncDispatcher dispatcher(iface);
+
+    constexpr int QUERIES = 8;
+    std::vector<int> counts(QUERIES, 0);
+    std::vector<wmi::HResult> results(QUERIES, wmi::status::False);
+    for (int i = 0; i < QUERIES; ++i) {
+        dispatcher.Submit(
+            L"SELECT Index FROM Win32_Fake", [&counts, i](const wmi::Object&) { ++counts[i]; },
+            [&results, i](const wmi::HResult result, std::exception_ptr) { results[i] = result; },
+            4);
+    }
+    bool failed = false;
+    dispatcher.Submit(L"SELECT Index FROM Win32_Missing", nullptr,
+                      [&failed](const wmi::HResult result, const std::exception_ptr& error) {
+                          failed = wmi::Failed(result) && error != nullptr;
+                      });
+    CHECK(dispatcher.Pending() == QUERIES + 1);
+
+    dispatcher.Run();
+    CHECK(dispatcher.Pending() == 0);
+    for (int i = 0; i < QUERIES; ++i) {
+        CHECK(counts[i] == 50);
+        CHECK(results[i] == wmi::status::Ok);
+    }
+    CHECK(failed);
+}
+
+void TestDispatcherCancelAll() {
+    wmi::SyntheticOptions options;
+    options.row_count = 100000;
+    const auto iface = wmi::Interface::Create(std::make_shared<wmi::SyntheticBackend>(options));
+    wmi::AsyncDispatcher dispatcher(iface);
+
+    bool done = false;
+    for (int i = 0; i < 4; ++i) {
+        dispatcher.Submit(
+            L"SELECT Index FROM Win32_Synthetic", nullptr,
+            [&done](wmi::HResult, std::exception_ptr) { done = true; }, 2);
+    }
+    dispatcher.Poll();
+    dispatcher.CancelAll();
+    CHECK(dispatcher.Pending() == 0);
+    CHECK(!done);
+}
+
+}  // namespace
+
+int main() {
+    TestBoundedQueue();
+    TestBoundedQueueConcurrent();
+    TestQueueSinkBackpressure();
+    TestQueueSinkAbandon();
+    TestAsyncQueryDelivers();
+    TestAsyncQueryCancelWithFullQueue();
+    TestAsyncQueryCancellationToken();
+    TestAsyncQueryFailure();
+    TestAsyncQueryInvalidQuery();
+    TestDispatcher();
+    TestDispatcherCancelAll();
+    return test::Result();
+}
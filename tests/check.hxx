@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+namespace test {
+
+inline int failures = 0;
+
+inline void Fail(const char* expression, const char* file, const int line) {
+    ++failures;
+    std::cerr << file << ":" << line << ": check failed: " << expression << std::endl;
+}
+
+/**
+ * polls a condition, for state another thread reaches at some point
+ * \param condition - callable returning bool
+ * \param timeout - longest wait before giving up
+ * \returns true once the condition held, false on timeout
+ */
+inline bool Eventually(const std::function<bool()>& condition,
+                       const std::chrono::milliseconds timeout = std::chrono::seconds(10)) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+/**
+ * exit code of the test program, non-zero once any check failed
+ */
+inline int Result() {
+    if (failures != 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+}  // namespace test
+
+#define CHECK(expression)                                  \
+    do {                                                   \
+        if (!(expression)) {                               \
+            test::Fail(#expression, __FILE__, __LINE__);   \
+        }                                                  \
+    } while (false)
+
+#define CHECK_THROWS(expression)                           \
+    do {                                                   \
+        bool thrown = false;                               \
+        try {                                              \
+            (void)(expression);                            \
+        } catch (...) {                                    \
+            thrown = true;                                 \
+        }                                                  \
+        if (!thrown) {                                     \
+            test::Fail(#expression, __FILE__, __LINE__);   \
+        }                                                  \
+    } while (false)
@@ -0,0 +1,172 @@
+#include "check.hxx"
+
+#include <wmi/backend/coalescing.hxx>
+#include <wmi/backend/fake.hxx>
+#include <wmi/backend/synthetic.hxx>
+#include <wmi/batch.hxx>
+#include <wmi/wmi.hxx>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::shared_ptr<wmi::FakeBackend> MakeDisks() {
+    auto fake = std::make_shared<wmi::FakeBackend>();
+    for (int i = 0; i < 3; ++i) {
+        fake->AddObject(L"Win32_Disk", {{L"Name", wmi::Variant(L"d" + std::to_wstring(i))},
+                                        {L"Size", wmi::Variant(std::uint64_t(100) * i)},
+                                        {L"Model", wmi::Variant(L"m")}});
+    }
+    return fake;
+}
+
+wmi::CoalescingOptions Window(const std::chrono::milliseconds window) {
+    wmi::CoalescingOptions options;
+    options.window = window;
+    return options;
+}
+
+std::size_t Drain(const wmi::QueryResult& result) {
+    std::size_t count = 0;
+    for (const auto& object : result) {
+        (void)object;
+        ++count;
+    }
+    return count;
+}
+
+void TestSequentialPassThrough() {
+    const auto fake = MakeDisks();
+    const auto coalescing =
+        std::make_shared<wmi::CoalescingBackend>(fake, Window(std::chrono::milliseconds(500)));
+    const auto iface = wmi::Interface::Create(coalescing);
+
+    // a query alone does not wait for the window
+    const auto start = Clock::now();
+    for (int i = 0; i < 5; ++i) {
+        CHECK(Drain(iface->ExecuteQuery(L"SELECT Name FROM Win32_Disk")) == 3);
+    }
+    CHECK(Clock::now() - start < std::chrono::milliseconds(500));
+
+    const auto stats = coalescing->GetStats();
+    CHECK(stats.requests == 5);
+    CHECK(stats.round_trips == 5);
+    CHECK(stats.coalesced == 0);
+    CHECK(fake->QueryCount() == 5);
+}
+
+void TestConcurrentQueriesMerge() {
+    const auto fake = MakeDisks();
+    const auto coalescing =
+        std::make_shared<wmi::CoalescingBackend>(fake, Window(std::chrono::milliseconds(200)));
+    const auto iface = wmi::Interface::Create(coalescing);
+
+    // a query of the class still running makes the following ones wait for each other
+    auto running = coalescing->ExecQuery(L"SELECT Name FROM Win32_Disk");
+
+    wmi::Batch batch(iface);
+    auto names = batch.Add(L"SELECT Name FROM Win32_Disk");
+    auto sizes = batch.Add(L"SELECT Size, Name FROM win32_disk");
+    auto everything = batch.Add(L"SELECT * FROM WIN32_DISK");
+    auto bogus = batch.Add(L"SELECT Bogus FROM Win32_Disk");
+
+    const auto sized = sizes.get();
+    CHECK(sized.objects.size() == 3);
+    for (const auto& object : sized.objects) {
+        CHECK(object.GetProperty<std::wstring>(L"Name").has_value());
+        CHECK(object.GetProperty<std::uint64_t>(L"Size").has_value());
+        // projected back to what the requester selected
+        CHECK(!object.GetProperty(L"Model"));
+    }
+    CHECK(names.get().objects.size() == 3);
+    const auto all = everything.get();
+    CHECK(all.objects.size() == 3 && all.objects[0].GetProperty<std::wstring>(L"Model") == L"m");
+    // the unknown property fails on the requester's own query only
+    CHECK_THROWS(bogus.get());
+
+    const auto stats = coalescing->GetStats();
+    CHECK(stats.requests == 5);
+    // the running query, the merged one selecting everything, then Bogus on its own
+    CHECK(stats.coalesced == 3);
+    CHECK(stats.round_trips == 3);
+    CHECK(fake->QueryCount() == 3);
+    running.reset();
+}
+
+void TestMergedRoundTrip() {
+    const auto fake = MakeDisks();
+    const auto coalescing =
+        std::make_shared<wmi::CoalescingBackend>(fake, Window(std::chrono::milliseconds(200)));
+    const auto iface = wmi::Interface::Create(coalescing);
+    auto running = coalescing->ExecQuery(L"SELECT Name FROM Win32_Disk");
+
+    wmi::Batch batch(iface);
+    std::vector<std::future<wmi::BatchResult>> results;
+    for (const auto* query : {L"SELECT Name FROM Win32_Disk", L"SELECT Size FROM win32_disk",
+                              L"SELECT Model, Name FROM WIN32_DISK"}) {
+        results.push_back(batch.Add(query));
+    }
+    for (auto& result : results) {
+        CHECK(result.get().objects.size() == 3);
+    }
+
+    const auto stats = coalescing->GetStats();
+    CHECK(stats.coalesced == 3);
+    // one for the running query, one for the three merged ones
+    CHECK(fake->QueryCount() == 2);
+    CHECK(stats.round_trips == 2);
+}
+
+void TestWaitersHonourDeadlineAndCancellation() {
+    wmi::SyntheticOptions slow;
+    slow.row_count = 10;
+    // every call of the merged query takes far longer than the requesters wait
+    slow.call_latency = wmi::LatencyModel::Constant(std::chrono::seconds(5));
+    const auto coalescing = std::make_shared<wmi::CoalescingBackend>(
+        std::make_shared<wmi::SyntheticBackend>(slow), Window(std::chrono::milliseconds(10)));
+    const auto iface = wmi::Interface::Create(coalescing);
+    auto running = coalescing->ExecQuery(L"SELECT Index FROM Win32_Synthetic");
+
+    const auto start = Clock::now();
+    wmi::QueryStatus timed_out;
+    std::thread deadline([&iface, &timed_out] {
+        const auto result = iface->ExecuteQuery(L"SELECT Index FROM Win32_Synthetic",
+                                                Clock::now() + std::chrono::milliseconds(150));
+        Drain(result);
+        timed_out = result.GetStatus();
+    });
+
+    wmi::CancellationSource source;
+    wmi::QueryStatus cancelled;
+    std::thread cancellation([&iface, &source, &cancelled] {
+        const auto result =
+            iface->ExecuteQuery(L"SELECT Name FROM Win32_Synthetic", source.GetToken());
+        Drain(result);
+        cancelled = result.GetStatus();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    source.Cancel();
+
+    deadline.join();
+    cancellation.join();
+    CHECK(Clock::now() - start < std::chrono::seconds(2));
+    CHECK(timed_out.state == wmi::QueryStatus::State::DeadlineExceeded);
+    CHECK(cancelled.state == wmi::QueryStatus::State::Cancelled);
+}
+
+}  // namespace
+
+int main() {
+    TestSequentialPassThrough();
+    TestConcurrentQueriesMerge();
+    TestMergedRoundTrip();
+    TestWaitersHonourDeadlineAndCancellation();
+    return test::Result();
+}
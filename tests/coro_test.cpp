@@ -0,0 +1,225 @@
+#include "check.hxx"
+
+#include <wmi/backend/fake.hxx>
+#include <wmi/backend/synthetic.hxx>
+#include <wmi/coro.hxx>
+
+// built as c++20 where the compiler supports it, reported as skipped otherwise
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::shared_ptr<wmi::Interface> MakeFake(const int count) {
+    auto fake = std::make_shared<wmi::FakeBackend>();
+    for (int i = 0; i < count; ++i) {
+        fake->AddObject(L"Win32_Fake", {{L"Index", wmi::Variant(i)}});
+    }
+    return wmi::Interface::Create(fake);
+}
+
+std::shared_ptr<wmi::Interface> MakeSynthetic(const std::size_t rows,
+                                              const std::size_t failure_after = SIZE_MAX) {
+    wmi::SyntheticOptions options;
+    options.row_count = rows;
+    options.failure_after_rows = failure_after;
+    return wmi::Interface::Create(std::make_shared<wmi::SyntheticBackend>(options));
+}
+
+bool InOrder(const std::vector<wmi::Object>& objects) {
+    for (std::size_t i = 0; i < objects.size(); ++i) {
+        if (objects[i].GetProperty<std::size_t>(L"Index") != i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+wmi::Task<int> Answer() { co_return 42; }
+
+wmi::Task<int> Fails() {
+    throw std::runtime_error("task failed");
+    co_return 0;
+}
+
+void TestTask() {
+    wmi::EventLoop loop;
+    int value = 0;
+    bool caught = false;
+    loop.Spawn([](int& value, bool& caught) -> wmi::Task<void> {
+        value = co_await Answer();
+        try {
+            (void)co_await Fails();
+        } catch (const std::runtime_error&) {
+            caught = true;
+        }
+    }(value, caught));
+    loop.Run();
+    CHECK(value == 42);
+    CHECK(caught);
+    CHECK(loop.Outstanding() == 0);
+}
+
+void TestCollect() {
+    const auto iface = MakeFake(50);
+    wmi::EventLoop loop;
+    std::vector<wmi::Object> collected;
+    std::vector<wmi::Object> awaited;
+    loop.Spawn([](std::shared_ptr<wmi::Interface> iface,
+                  std::vector<wmi::Object>& out) -> wmi::Task<void> {
+        out = co_await wmi::Collect(iface->ExecuteQueryAsync(L"SELECT Index FROM Win32_Fake", 4));
+    }(iface, collected));
+    loop.Spawn([](std::shared_ptr<wmi::Interface> iface,
+                  std::vector<wmi::Object>& out) -> wmi::Task<void> {
+        out = co_await iface->ExecuteQueryAsync(L"SELECT Index FROM Win32_Fake", 4);
+    }(iface, awaited));
+    loop.Run();
+    CHECK(collected.size() == 50);
+    CHECK(awaited.size() == 50);
+    CHECK(InOrder(collected));
+    CHECK(InOrder(awaited));
+}
+
+void TestRows() {
+    const auto iface = MakeFake(30);
+    wmi::EventLoop loop;
+    std::size_t count = 0;
+    bool ordered = true;
+    loop.Spawn([](std::shared_ptr<wmi::Interface> iface, std::size_t& count,
+                  bool& ordered) -> wmi::Task<void> {
+        auto rows = wmi::Rows(iface->ExecuteQueryAsync(L"SELECT Index FROM Win32_Fake", 2));
+        while (const auto object = co_await rows.Next()) {
+            ordered = ordered && object->GetProperty<std::size_t>(L"Index") == count;
+            ++count;
+        }
+        // a finished generator keeps reporting its end
+        CHECK(!(co_await rows.Next()));
+    }(iface, count, ordered));
+    loop.Run();
+    CHECK(count == 30);
+    CHECK(ordered);
+}
+
+void TestSeveralRunThreads() {
+    constexpr int TASKS = 64;
+    constexpr int THREADS = 4;
+    const auto iface = MakeSynthetic(200);
+
+    wmi::EventLoop loop;
+    std::atomic<std::size_t> total{0};
+    for (int i = 0; i < TASKS; ++i) {
+        loop.Spawn([](std::shared_ptr<wmi::Interface> iface,
+                      std::atomic<std::size_t>& total) -> wmi::Task<void> {
+            const auto objects =
+                co_await iface->ExecuteQueryAsync(L"SELECT Index FROM Win32_Synthetic", 16);
+            total += objects.size();
+        }(iface, total));
+    }
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < THREADS; ++i) {
+        threads.emplace_back([&loop] { loop.Run(); });
+    }
+    loop.Run();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    CHECK(total.load() == static_cast<std::size_t>(TASKS) * 200);
+    CHECK(loop.Outstanding() == 0);
+}
+
+void TestCollectFailure() {
+    const auto iface = MakeSynthetic(100, 30);
+    wmi::EventLoop loop;
+    loop.Spawn([](std::shared_ptr<wmi::Interface> iface) -> wmi::Task<void> {
+        (void)co_await iface->ExecuteQueryAsync(L"SELECT Index FROM Win32_Synthetic", 8);
+    }(iface));
+    // an exception escaping a spawned task comes out of Run
+    CHECK_THROWS(loop.Run());
+    CHECK(loop.Outstanding() == 0);
+}
+
+void TestRowsFailure() {
+    const auto iface = MakeSynthetic(100, 30);
+    wmi::EventLoop loop;
+    std::size_t count = 0;
+    bool caught = false;
+    loop.Spawn([](std::shared_ptr<wmi::Interface> iface, std::size_t& count,
+                  bool& caught) -> wmi::Task<void> {
+        auto rows = wmi::Rows(iface->ExecuteQueryAsync(L"SELECT Index FROM Win32_Synthetic", 8));
+        try {
+            while (co_await rows.Next()) {
+                ++count;
+            }
+        } catch (const wmi::Exception&) {
+            caught = true;
+        }
+    }(iface, count, caught));
+    loop.Run();
+    CHECK(caught);
+    CHECK(count <= 30);
+}
+
+void TestInvalidQuery() {
+    const auto iface = MakeFake(1);
+    wmi::EventLoop loop;
+    bool caught = false;
+    loop.Spawn([](std::shared_ptr<wmi::Interface> iface, bool& caught) -> wmi::Task<void> {
+        try {
+            (void)co_await iface->ExecuteQueryAsync(L"SELECT Missing FROM Win32_Fake");
+        } catch (const wmi::Exception&) {
+            caught = true;
+        }
+    }(iface, caught));
+    loop.Run();
+    CHECK(caught);
+}
+
+void TestCancellation() {
+    const auto iface = MakeSynthetic(100000);
+    wmi::EventLoop loop;
+    wmi::CancellationSource source;
+    std::size_t count = 0;
+    loop.Spawn([](std::shared_ptr<wmi::Interface> iface, wmi::CancellationSource& source,
+                  std::size_t& count) -> wmi::Task<void> {
+        auto rows = wmi::Rows(iface->ExecuteQueryAsync(L"SELECT Index FROM Win32_Synthetic",
+                                                       source.GetToken(), 2));
+        // cancellation ends the rows without an exception
+        while (co_await rows.Next()) {
+            if (++count == 5) {
+                source.Cancel();
+            }
+        }
+    }(iface, source, count));
+    loop.Run();
+    CHECK(count >= 5);
+    CHECK(count < 100000);
+}
+
+}  // namespace
+
+int main() {
+    TestTask();
+    TestCollect();
+    TestRows();
+    TestSeveralRunThreads();
+    TestCollectFailure();
+    TestRowsFailure();
+    TestInvalidQuery();
+    TestCancellation();
+    return test::Result();
+}
+
+#else
+
+int main() {
+    constexpr int SKIP = 77;
+    return SKIP;
+}
+
+#endif
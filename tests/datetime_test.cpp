@@ -0,0 +1,130 @@
+#include "check.hxx"
+
+#include <wmi/datetime.hxx>
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <ratio>
+#include <string_view>
+
+namespace {
+
+std::optional<std::int64_t> DateTime(const std::wstring_view text) {
+    std::int64_t microseconds = 0;
+    if (!wmi::detail::ParseDateTime(text, microseconds)) {
+        return std::nullopt;
+    }
+    return microseconds;
+}
+
+std::optional<std::int64_t> Interval(const std::wstring_view text) {
+    std::int64_t microseconds = 0;
+    if (!wmi::detail::ParseInterval(text, microseconds)) {
+        return std::nullopt;
+    }
+    return microseconds;
+}
+
+std::int64_t Since1970(const std::chrono::system_clock::time_point point) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(point.time_since_epoch())
+        .count();
+}
+
+void TestDateTime() {
+    CHECK(DateTime(L"19700101000000.000000+000") == 0);
+    // the offset is the local time ahead of utc, the result is utc
+    CHECK(DateTime(L"20240229123456.123456+060") == 1709206496123456);
+    CHECK(DateTime(L"20240229123456.000000-300") == 1709228096000000);
+    // the fraction counts forward from the second before the epoch
+    CHECK(DateTime(L"19691231235959.500000+000") == -500000);
+    CHECK(DateTime(L"20000229000000.000000+000") == 951782400000000);
+    CHECK(DateTime(L"16000301000000.000000+000") == -11670912000000000);
+}
+
+void TestDateTimeInvalid() {
+    // month and day out of range, february of common and century years
+    CHECK(!DateTime(L"20241301000000.000000+000"));
+    CHECK(!DateTime(L"20240001000000.000000+000"));
+    CHECK(!DateTime(L"20240100000000.000000+000"));
+    CHECK(!DateTime(L"20240431000000.000000+000"));
+    CHECK(!DateTime(L"20230229000000.000000+000"));
+    CHECK(!DateTime(L"19000229000000.000000+000"));
+    CHECK(DateTime(L"20240731000000.000000+000"));
+    CHECK(DateTime(L"20240831000000.000000+000"));
+    // time of day out of range
+    CHECK(!DateTime(L"20240101240000.000000+000"));
+    CHECK(!DateTime(L"20240101236000.000000+000"));
+    CHECK(!DateTime(L"20240101235960.000000+000"));
+    // separators, sign, digits and length
+    CHECK(!DateTime(L"20240101000000,000000+000"));
+    CHECK(!DateTime(L"20240101000000.000000*000"));
+    CHECK(!DateTime(L"20240101000000.000000:000"));
+    CHECK(!DateTime(L"2024010100000a.000000+000"));
+    CHECK(!DateTime(L"20240101000000.******+000"));
+    CHECK(!DateTime(L"20240101000000.000000+00"));
+    CHECK(!DateTime(L"20240101000000.000000+0000"));
+    CHECK(!DateTime(L""));
+}
+
+void TestInterval() {
+    CHECK(Interval(L"00000000000000.000000:000") == 0);
+    CHECK(Interval(L"00000001020304.000005:000") == 93784000005);
+    // the largest interval still fits the count of microseconds
+    CHECK(Interval(L"99999999235959.999999:000") == 8639999999999999999);
+
+    CHECK(!Interval(L"00000001240000.000000:000"));
+    CHECK(!Interval(L"00000001006000.000000:000"));
+    CHECK(!Interval(L"00000001000060.000000:000"));
+    CHECK(!Interval(L"00000001000000.000000:001"));
+    CHECK(!Interval(L"00000001000000.000000+000"));
+    CHECK(!Interval(L"00000001000000-000000:000"));
+    CHECK(!Interval(L"0000000100000.000000:000"));
+    // a datetime is no interval
+    CHECK(!Interval(L"20240229123456.123456+060"));
+}
+
+void TestToTimePoint() {
+    const auto point = wmi::detail::ToTimePoint(L"20240229123456.123456+060");
+    CHECK(point && Since1970(*point) == 1709206496123456);
+    CHECK(!wmi::detail::ToTimePoint(L"20240230000000.000000+000"));
+
+    using Period = std::chrono::system_clock::period;
+    if (std::ratio_equal_v<Period, std::nano>) {
+        // a nanosecond clock ends at 2262-04-11 23:47:16.854775807
+        const auto last = wmi::detail::ToTimePoint(L"22620411234716.854775+000");
+        CHECK(last && Since1970(*last) == 9223372036854775);
+        CHECK(!wmi::detail::ToTimePoint(L"22620411234716.854776+000"));
+        CHECK(!wmi::detail::ToTimePoint(L"99991231235959.999999+000"));
+        CHECK(!wmi::detail::ToTimePoint(L"16770921000000.000000+000"));
+    }
+}
+
+void TestParseDateTimes() {
+    const std::wstring_view texts[] = {L"19700101000000.000000+000", L"20241301000000.000000+000",
+                                       L"19691231235959.500000+000"};
+    std::optional<std::chrono::system_clock::time_point> values[3];
+    CHECK(wmi::ParseDateTimes(texts, 3, values) == 2);
+    CHECK(values[0] && Since1970(*values[0]) == 0);
+    CHECK(!values[1]);
+    CHECK(values[2] && Since1970(*values[2]) == -500000);
+    CHECK(wmi::ParseDateTimes(texts, 0, values) == 0);
+}
+
+// decoding is constexpr, a fixed text folds at compile time
+static_assert([] {
+    std::int64_t microseconds = 0;
+    return wmi::detail::ParseDateTime(L"19700102000000.000000+000", microseconds) &&
+           microseconds == 86400000000;
+}());
+
+}  // namespace
+
+int main() {
+    TestDateTime();
+    TestDateTimeInvalid();
+    TestInterval();
+    TestToTimePoint();
+    TestParseDateTimes();
+    return test::Result();
+}
@@ -0,0 +1,53 @@
+# writes smbios_type17.bin, the raw smbios table read by smbios_test
+# usage: python3 smbios_type17.py > smbios_type17.bin
+import struct, sys
+
+def type17(handle, size, speed, strings, locator, bank, manufacturer, serial, part,
+           ext_size=0, configured=0, ext_speed=0, ext_configured=0, length=0x5C):
+    body = bytearray(length)
+    body[0] = 17
+    body[1] = length
+    struct.pack_into('<H', body, 0x02, handle)
+    struct.pack_into('<H', body, 0x0C, size)
+    body[0x10] = locator
+    body[0x11] = bank
+    # fields past the length of older layouts are left out
+    if length >= 0x17:
+        struct.pack_into('<H', body, 0x15, speed)
+    if length >= 0x1B:
+        body[0x17] = manufacturer
+        body[0x18] = serial
+        body[0x1A] = part
+    if length >= 0x20:
+        struct.pack_into('<I', body, 0x1C, ext_size)
+    if length >= 0x22:
+        struct.pack_into('<H', body, 0x20, configured)
+    if length >= 0x58:
+        struct.pack_into('<I', body, 0x54, ext_speed)
+    if length >= 0x5C:
+        struct.pack_into('<I', body, 0x58, ext_configured)
+    tail = b''.join(s.encode('ascii') + b'\0' for s in strings) + b'\0'
+    if not strings:
+        tail = b'\0\0'
+    return bytes(body) + tail
+
+table = b''
+# type 0 bios structure, skipped by the decoder
+table += bytes([0, 0x12]) + bytes(0x10) + b'Vendor\0\0'
+# 8 GB DIMM, plain fields, padded part number
+table += type17(0x1100, 8192, 3200, ['DIMM 0', 'BANK 0', 'Samsung', 'S0001', 'M471A1K43DB1-CWE   '],
+                1, 2, 3, 4, 5, configured=2933)
+# empty slot
+table += type17(0x1101, 0, 0, ['DIMM 1', 'BANK 1'], 1, 2, 0, 0, 0)
+# 64 GB through the extended size field, speeds through the extended fields, no manufacturer
+table += type17(0x1102, 0x7FFF, 0xFFFF, ['DIMM 2', 'BANK 2', 'S0003', 'PN3'],
+                1, 2, 0, 3, 4, ext_size=65536, configured=0xFFFF, ext_speed=8400,
+                ext_configured=7200)
+# 512 KB module sized in kilobytes, smbios 2.3 length without the later fields, speed unknown
+table += type17(0x1103, 0x8000 | 512, 0, ['DIMM 3'], 1, 0, 0, 0, 0, length=0x1B)
+# 1 GB module of the smbios 2.1 length, too short to hold a speed
+table += type17(0x1105, 1024, 0, ['DIMM 4', 'BANK 4'], 1, 2, 0, 0, 0, length=0x15)
+# unknown size
+table += type17(0x1104, 0xFFFF, 0, [], 0, 0, 0, 0, 0)
+table += bytes([127, 4, 0xFF, 0xFE]) + b'\0\0'
+sys.stdout.buffer.write(table)
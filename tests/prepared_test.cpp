@@ -0,0 +1,147 @@
+#include "check.hxx"
+
+#include <wmi/backend/fake.hxx>
+#include <wmi/wmi.hxx>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+/**
+ * row counting the reads through a handle resolved against another layout, the ones that fall
+ * back to a lookup by name
+ */
+class CheckedRow final : public wmi::Row {
+   public:
+    CheckedRow(wmi::RowPtr row, std::shared_ptr<std::atomic<std::size_t>> stale)
+        : row_(std::move(row)), stale_(std::move(stale)) {}
+
+    [[nodiscard]] const wmi::Variant* Find(const std::wstring_view name) const override {
+        return row_->Find(name);
+    }
+
+    void Enumerate(const std::function<void(std::wstring_view, const wmi::Variant&)>& visitor)
+        const override {
+        row_->Enumerate(visitor);
+    }
+
+    [[nodiscard]] wmi::PropertyHandle Resolve(const std::wstring_view name) const override {
+        return row_->Resolve(name);
+    }
+
+    [[nodiscard]] const void* Layout() const noexcept override { return row_->Layout(); }
+
+    [[nodiscard]] const wmi::Variant* Read(const wmi::PropertyHandle& handle) const override {
+        if (handle.layout.get() != row_->Layout()) {
+            ++*stale_;
+        }
+        return row_->Read(handle);
+    }
+
+   private:
+    wmi::RowPtr row_;
+    std::shared_ptr<std::atomic<std::size_t>> stale_;
+};
+
+class CheckedEnumerator final : public wmi::Enumerator {
+   public:
+    CheckedEnumerator(std::shared_ptr<wmi::Enumerator> inner,
+                      std::shared_ptr<std::atomic<std::size_t>> stale)
+        : inner_(std::move(inner)), stale_(std::move(stale)) {}
+
+    wmi::HResult Next(const long timeout_ms, const std::size_t count,
+                      std::vector<wmi::RowPtr>& rows) override {
+        const auto first = rows.size();
+        const auto result = inner_->Next(timeout_ms, count, rows);
+        for (auto i = first; i < rows.size(); ++i) {
+            rows[i] = std::make_shared<CheckedRow>(std::move(rows[i]), stale_);
+        }
+        return result;
+    }
+
+    wmi::HResult Reset() override { return inner_->Reset(); }
+
+   private:
+    std::shared_ptr<wmi::Enumerator> inner_;
+    std::shared_ptr<std::atomic<std::size_t>> stale_;
+};
+
+class CheckedBackend final : public wmi::Backend {
+   public:
+    explicit CheckedBackend(std::shared_ptr<wmi::Backend> inner) : inner_(std::move(inner)) {}
+
+    void Connect(const std::string_view path) override { inner_->Connect(path); }
+
+    [[nodiscard]] std::shared_ptr<wmi::Enumerator> ExecQuery(
+        const std::wstring_view query) override {
+        return std::make_shared<CheckedEnumerator>(inner_->ExecQuery(query), stale_);
+    }
+
+    [[nodiscard]] std::size_t Stale() const noexcept { return stale_->load(); }
+
+   private:
+    std::shared_ptr<wmi::Backend> inner_;
+    std::shared_ptr<std::atomic<std::size_t>> stale_ =
+        std::make_shared<std::atomic<std::size_t>>(0);
+};
+
+std::shared_ptr<wmi::FakeBackend> MakeServices(const int count) {
+    auto fake = std::make_shared<wmi::FakeBackend>();
+    for (int i = 0; i < count; ++i) {
+        fake->AddObject(L"Win32_Service", {{L"Name", wmi::Variant(L"s" + std::to_wstring(i))},
+                                           {L"ProcessId", wmi::Variant(i)},
+                                           {L"State", wmi::Variant(L"Running")}});
+    }
+    return fake;
+}
+
+void TestExecuteTwice() {
+    const auto backend = std::make_shared<CheckedBackend>(MakeServices(20));
+    const auto iface = wmi::Interface::Create(backend);
+    const auto prepared = iface->Prepare(L"SELECT ProcessId, Name FROM Win32_Service");
+    const auto name = prepared.Column(L"Name");
+    const auto pid = prepared.Column(L"ProcessId");
+
+    // every execution of the fake backend hands out rows of a new layout
+    for (int run = 0; run < 3; ++run) {
+        int expected = 0;
+        for (const auto& row : prepared.Execute()) {
+            CHECK(row.Get<int>(pid) == expected);
+            CHECK(row.Get<std::wstring>(name) == L"s" + std::to_wstring(expected));
+            ++expected;
+        }
+        CHECK(expected == 20);
+    }
+    // each run read by position against its own layout
+    CHECK(backend->Stale() == 0);
+}
+
+void TestResultsInterleaved() {
+    const auto backend = std::make_shared<CheckedBackend>(MakeServices(10));
+    const auto iface = wmi::Interface::Create(backend);
+    const auto prepared = iface->Prepare(L"SELECT Name FROM Win32_Service");
+
+    const auto first = prepared.Execute();
+    const auto second = prepared.Execute();
+    auto a = first.begin();
+    auto b = second.begin();
+    std::size_t count = 0;
+    for (; a != first.end() && b != second.end(); ++a, ++b) {
+        CHECK(a->Get<std::wstring>(0) == b->Get<std::wstring>(0));
+        ++count;
+    }
+    CHECK(count == 10);
+    CHECK(backend->Stale() == 0);
+}
+
+}  // namespace
+
+int main() {
+    TestExecuteTwice();
+    TestResultsInterleaved();
+    return test::Result();
+}
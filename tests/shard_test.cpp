@@ -0,0 +1,138 @@
+#include "check.hxx"
+
+#include <wmi/backend/fake.hxx>
+#include <wmi/shard.hxx>
+#include <wmi/wmi.hxx>
+#include <wmi/wql.hxx>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+/**
+ * provider dropping the WHERE clause, every range sub-query then returns every object
+ */
+class WhereIgnoringBackend final : public wmi::Backend {
+   public:
+    explicit WhereIgnoringBackend(std::shared_ptr<wmi::Backend> inner) : inner_(std::move(inner)) {}
+
+    void Connect(const std::string_view path) override { inner_->Connect(path); }
+
+    [[nodiscard]] std::shared_ptr<wmi::Enumerator> ExecQuery(
+        const std::wstring_view query) override {
+        auto parsed = wmi::ParseWql(query);
+        if (!parsed) {
+            return inner_->ExecQuery(query);
+        }
+        parsed->where.clear();
+        return inner_->ExecQuery(wmi::FormatWql(*parsed));
+    }
+
+   private:
+    std::shared_ptr<wmi::Backend> inner_;
+};
+
+std::shared_ptr<wmi::FakeBackend> MakeProcesses(const int count, const int keys) {
+    auto fake = std::make_shared<wmi::FakeBackend>();
+    for (int i = 0; i < count; ++i) {
+        fake->AddObject(L"Win32_Process", {{L"ProcessId", wmi::Variant(i % keys)},
+                                           {L"Name", wmi::Variant(L"p" + std::to_wstring(i))}});
+    }
+    return fake;
+}
+
+wmi::ShardOptions Options() {
+    wmi::ShardOptions options;
+    options.key = L"ProcessId";
+    return options;
+}
+
+std::vector<std::wstring> Names(const std::vector<wmi::Object>& objects) {
+    std::vector<std::wstring> names;
+    for (const auto& object : objects) {
+        names.push_back(object.GetProperty<std::wstring>(L"Name").value_or(L""));
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+void TestShardedMatchesWhole() {
+    const auto iface = wmi::Interface::Create(MakeProcesses(100, 100));
+    wmi::ShardedExecutor executor(iface);
+
+    auto options = Options();
+    const auto sharded = executor.Execute(L"SELECT Name, ProcessId FROM Win32_Process", options);
+    options.enabled = false;
+    const auto whole = executor.Execute(L"SELECT Name, ProcessId FROM Win32_Process", options);
+
+    CHECK(sharded.stats.sharded);
+    CHECK(sharded.stats.shard_rows.size() == options.shards);
+    CHECK(!whole.stats.sharded);
+    CHECK(sharded.objects.size() == 100);
+    CHECK(Names(sharded.objects) == Names(whole.objects));
+}
+
+void TestKeyNotSelected() {
+    const auto iface = wmi::Interface::Create(MakeProcesses(100, 100));
+    wmi::ShardedExecutor executor(iface);
+
+    const auto result = executor.Execute(L"SELECT Name FROM Win32_Process", Options());
+    CHECK(result.stats.sharded);
+    CHECK(result.objects.size() == 100);
+    // the key was only added for the range check, the caller does not see it
+    const auto missing = std::all_of(
+        result.objects.begin(), result.objects.end(), [](const wmi::Object& object) {
+            bool enumerated = false;
+            object.ForEachProperty([&enumerated](const std::wstring_view name, const auto&) {
+                enumerated = enumerated || wmi::EqualsIgnoreCase(name, L"ProcessId");
+            });
+            return !object.GetProperty(L"ProcessId") && !enumerated;
+        });
+    CHECK(missing);
+}
+
+void TestDuplicateKeys() {
+    // ten objects per key, the bounds must not split or repeat a key
+    const auto iface = wmi::Interface::Create(MakeProcesses(100, 10));
+    wmi::ShardedExecutor executor(iface);
+
+    auto options = Options();
+    options.shards = 8;
+    const auto result = executor.Execute(L"SELECT Name FROM Win32_Process", options);
+    CHECK(result.objects.size() == 100);
+    CHECK(Names(result.objects).size() == 100);
+
+    // a single key value cannot be split at all
+    const auto same = wmi::Interface::Create(MakeProcesses(50, 1));
+    wmi::ShardedExecutor single(same);
+    const auto whole = single.Execute(L"SELECT Name FROM Win32_Process", Options());
+    CHECK(!whole.stats.sharded);
+    CHECK(whole.objects.size() == 50);
+}
+
+void TestWhereIgnoringProvider() {
+    const auto iface = wmi::Interface::Create(
+        std::make_shared<WhereIgnoringBackend>(MakeProcesses(100, 100)));
+    wmi::ShardedExecutor executor(iface);
+
+    for (const auto* query :
+         {L"SELECT Name FROM Win32_Process", L"SELECT Name, ProcessId FROM Win32_Process"}) {
+        const auto result = executor.Execute(query, Options());
+        CHECK(!result.stats.sharded);
+        CHECK(result.objects.size() == 100);
+    }
+}
+
+}  // namespace
+
+int main() {
+    TestShardedMatchesWhole();
+    TestKeyNotSelected();
+    TestDuplicateKeys();
+    TestWhereIgnoringProvider();
+    return test::Result();
+}
@@ -0,0 +1,155 @@
+#include "check.hxx"
+
+#include <wmi/backend/smbios.hxx>
+#include <wmi/wmi.hxx>
+
+// the provider reads linux sysfs tables, elsewhere the test reports itself skipped
+#ifdef __linux__
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+/**
+ * tests/fixtures/smbios_type17.bin, a raw table holding in order:
+ * a type 0 structure, an 8 GB dimm with a padded part number, an empty slot,
+ * a 64 GB module sized through the extended size field with 0xFFFF speeds taken from the
+ * extended speed fields and string index 0 for the manufacturer, a 512 KB module of the
+ * short smbios 2.3 layout with a speed of 0, a 1 GB module of the smbios 2.1 layout ending
+ * before the speed field, a module of unknown size and the type 127 end marker
+ */
+std::shared_ptr<wmi::Interface> MakeFixture() {
+    return wmi::Interface::Create(std::make_shared<wmi::SmbiosBackend>(
+        std::string(WMI_TEST_FIXTURES) + "/smbios_type17.bin"));
+}
+
+std::vector<wmi::Object> Run(const std::wstring_view query) {
+    std::vector<wmi::Object> objects;
+    for (const auto& object : MakeFixture()->ExecuteQuery(query)) {
+        objects.push_back(object);
+    }
+    return objects;
+}
+
+void TestPopulatedSlots() {
+    const auto objects = Run(L"SELECT * FROM Win32_PhysicalMemory");
+    // the empty slot and the module of unknown size are not reported
+    CHECK(objects.size() == 4);
+    if (objects.size() != 4) {
+        return;
+    }
+
+    const auto& dimm = objects[0];
+    CHECK(dimm.GetProperty<std::uint64_t>(L"Capacity") == 8ull << 30);
+    CHECK(dimm.GetProperty<std::uint32_t>(L"Speed") == 3200u);
+    CHECK(dimm.GetProperty<std::uint32_t>(L"ConfiguredClockSpeed") == 2933u);
+    CHECK(dimm.GetProperty<std::wstring>(L"Manufacturer") == L"Samsung");
+    CHECK(dimm.GetProperty<std::wstring>(L"SerialNumber") == L"S0001");
+    CHECK(dimm.GetProperty<std::wstring>(L"PartNumber") == L"M471A1K43DB1-CWE");
+    CHECK(dimm.GetProperty<std::wstring>(L"DeviceLocator") == L"DIMM 0");
+    CHECK(dimm.GetProperty<std::wstring>(L"BankLabel") == L"BANK 0");
+}
+
+void TestExtendedFields() {
+    const auto objects = Run(L"SELECT * FROM Win32_PhysicalMemory WHERE DeviceLocator = 'DIMM 2'");
+    CHECK(objects.size() == 1);
+    if (objects.empty()) {
+        return;
+    }
+
+    const auto& module = objects[0];
+    CHECK(module.GetProperty<std::uint64_t>(L"Capacity") == 64ull << 30);
+    CHECK(module.GetProperty<std::uint32_t>(L"Speed") == 8400u);
+    CHECK(module.GetProperty<std::uint32_t>(L"ConfiguredClockSpeed") == 7200u);
+    // string index 0 means no string, the property is null rather than empty
+    const auto manufacturer = module.GetProperty(L"Manufacturer");
+    CHECK(manufacturer && manufacturer->IsEmpty());
+    CHECK(module.GetProperty<std::wstring>(L"PartNumber") == L"PN3");
+}
+
+void TestShortLayout() {
+    const auto objects = Run(L"SELECT Capacity, Speed, DeviceLocator FROM Win32_PhysicalMemory "
+                             L"WHERE DeviceLocator = 'DIMM 3'");
+    CHECK(objects.size() == 1);
+    if (objects.empty()) {
+        return;
+    }
+
+    // sized in kilobytes, the speed field is there but 0 means unknown
+    CHECK(objects[0].GetProperty<std::uint64_t>(L"Capacity") == 512ull << 10);
+    CHECK(!objects[0].GetProperty<std::uint32_t>(L"Speed"));
+}
+
+void TestMinimalLayout() {
+    const auto objects = Run(L"SELECT * FROM Win32_PhysicalMemory WHERE DeviceLocator = 'DIMM 4'");
+    CHECK(objects.size() == 1);
+    if (objects.empty()) {
+        return;
+    }
+
+    // the record ends before the speed and the manufacturer, serial and part strings
+    const auto& module = objects[0];
+    CHECK(module.GetProperty<std::uint64_t>(L"Capacity") == 1ull << 30);
+    CHECK(!module.GetProperty<std::uint32_t>(L"Speed"));
+    CHECK(!module.GetProperty<std::uint32_t>(L"ConfiguredClockSpeed"));
+    CHECK(module.GetProperty<std::wstring>(L"BankLabel") == L"BANK 4");
+    const auto part = module.GetProperty(L"PartNumber");
+    CHECK(part && part->IsEmpty());
+}
+
+void TestProjectionAndCondition() {
+    const auto objects =
+        Run(L"SELECT Capacity, PartNumber FROM Win32_PhysicalMemory WHERE Speed = 8400");
+    CHECK(objects.size() == 1);
+    if (objects.empty()) {
+        return;
+    }
+    CHECK(objects[0].GetProperty<std::wstring>(L"PartNumber") == L"PN3");
+    CHECK(!objects[0].GetProperty<std::wstring>(L"DeviceLocator"));
+}
+
+void TestMissingTable() {
+    const auto iface = wmi::Interface::Create(
+        std::make_shared<wmi::SmbiosBackend>(std::string(WMI_TEST_FIXTURES) + "/missing.bin"));
+    CHECK_THROWS(iface->ExecuteQuery(L"SELECT Capacity FROM Win32_PhysicalMemory").Count());
+}
+
+void TestSystemTable() {
+    // root only and absent in containers, an unreadable system table yields no rows
+    const auto iface = wmi::Interface::Create(std::make_shared<wmi::SmbiosBackend>());
+    std::size_t count = 0;
+    for (const auto& object : iface->ExecuteQuery(L"SELECT Capacity FROM Win32_PhysicalMemory")) {
+        CHECK(object.GetProperty<std::uint64_t>(L"Capacity").value_or(0) > 0);
+        ++count;
+    }
+    if (access("/sys/firmware/dmi/tables/DMI", R_OK) != 0) {
+        CHECK(count == 0);
+    }
+}
+
+}  // namespace
+
+int main() {
+    TestPopulatedSlots();
+    TestExtendedFields();
+    TestShortLayout();
+    TestMinimalLayout();
+    TestProjectionAndCondition();
+    TestMissingTable();
+    TestSystemTable();
+    return test::Result();
+}
+
+#else
+
+int main() {
+    constexpr int SKIP = 77;
+    return SKIP;
+}
+
+#endif
@@ -0,0 +1,171 @@
+#include "check.hxx"
+
+#include <wmi/backend/fake.hxx>
+#include <wmi/backend/trace.hxx>
+#include <wmi/wmi.hxx>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr const char* TRACE_PATH = "trace_test.wmitrace";
+constexpr const char* DAMAGED_PATH = "trace_test_damaged.wmitrace";
+
+const std::vector<std::wstring> QUERIES = {
+    L"SELECT * FROM Win32_Volume",
+    L"SELECT Label, Size FROM Win32_Volume",
+    L"SELECT Label FROM Win32_Volume WHERE Size > 100",
+};
+
+std::shared_ptr<wmi::FakeBackend> MakeVolumes() {
+    auto fake = std::make_shared<wmi::FakeBackend>();
+    // characters outside the basic multilingual plane travel as surrogate pairs
+    fake->AddObject(L"Win32_Volume",
+                    {{L"Label", wmi::Variant(L"\U0001F600 data \U0001D11E")},
+                     {L"Size", wmi::Variant(std::uint64_t(1) << 40)},
+                     {L"Offset", wmi::Variant(std::int64_t(-42))},
+                     {L"Ratio", wmi::Variant(0.25)},
+                     {L"Dirty", wmi::Variant(true)},
+                     {L"Paths", wmi::Variant(std::vector<wmi::WideString>{
+                                    wmi::WideString(L"C:\\"), wmi::WideString(L"\U00010348")})},
+                     {L"Serial", wmi::Variant()}});
+    fake->AddObject(L"Win32_Volume", {{L"Label", wmi::Variant(L"plain \u00E9")},
+                                      {L"Size", wmi::Variant(std::uint64_t(50))},
+                                      {L"Offset", wmi::Variant(std::int64_t(0))},
+                                      {L"Ratio", wmi::Variant(-1.5)},
+                                      {L"Dirty", wmi::Variant(false)},
+                                      {L"Paths", wmi::Variant(std::vector<wmi::WideString>{})},
+                                      {L"Serial", wmi::Variant(L"")}});
+    return fake;
+}
+
+/**
+ * every property of every object with the alternative it holds, in enumeration order
+ */
+std::wstring Describe(const wmi::QueryResult& result) {
+    std::wstring text;
+    for (const auto& object : result) {
+        object.ForEachProperty([&text](const std::wstring_view name, const wmi::Variant& value) {
+            text.append(name);
+            if (const auto* boolean = value.GetIf<bool>()) {
+                text += *boolean ? L"=bool:1" : L"=bool:0";
+            } else if (const auto* number = value.GetIf<std::int64_t>()) {
+                text += L"=int:" + std::to_wstring(*number);
+            } else if (const auto* number = value.GetIf<std::uint64_t>()) {
+                text += L"=uint:" + std::to_wstring(*number);
+            } else if (const auto* real = value.GetIf<double>()) {
+                text += L"=real:" + std::to_wstring(*real);
+            } else if (const auto* string = value.GetIf<wmi::WideString>()) {
+                text += L"=string:";
+                text.append(string->View());
+            } else if (const auto* strings = value.GetIf<std::vector<wmi::WideString>>()) {
+                text += L"=strings:";
+                for (const auto& item : *strings) {
+                    text.append(item.View());
+                    text += L'|';
+                }
+            } else {
+                text += L"=empty";
+            }
+            text += L';';
+        });
+        text += L'\n';
+    }
+    return text;
+}
+
+std::string ReadFile(const char* path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+void WriteFile(const char* path, const std::string& data) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+void TestRoundTrip() {
+    const auto fake = MakeVolumes();
+    const auto recorder = std::make_shared<wmi::RecordingBackend>(fake);
+    const auto recording = wmi::Interface::Create(recorder);
+    std::vector<std::wstring> expected;
+    for (const auto& query : QUERIES) {
+        expected.push_back(Describe(recording->ExecuteQuery(query)));
+    }
+    recorder->Save(TRACE_PATH);
+
+    const auto replay =
+        wmi::Interface::Create(std::make_shared<wmi::ReplayBackend>(std::string(TRACE_PATH)));
+    for (std::size_t i = 0; i < QUERIES.size(); ++i) {
+        CHECK(Describe(replay->ExecuteQuery(QUERIES[i])) == expected[i]);
+    }
+    CHECK(expected[0].find(L"\U0001F600 data \U0001D11E") != std::wstring::npos);
+    CHECK(expected[0].find(L"\U00010348|") != std::wstring::npos);
+    // nothing was served by the original provider while replaying
+    CHECK(fake->QueryCount() == QUERIES.size());
+    CHECK_THROWS(replay->ExecuteQuery(L"SELECT Label FROM Win32_Missing"));
+}
+
+void TestTruncated() {
+    const auto data = ReadFile(TRACE_PATH);
+    CHECK(data.size() > 16);
+
+    // the format counts everything it holds, so any cut is detected wherever it falls
+    std::size_t rejected = 0;
+    for (std::size_t length = 0; length < data.size(); ++length) {
+        WriteFile(DAMAGED_PATH, data.substr(0, length));
+        try {
+            (void)wmi::ReadTrace(DAMAGED_PATH);
+        } catch (const wmi::Exception&) {
+            ++rejected;
+        }
+    }
+    CHECK(rejected == data.size());
+}
+
+void TestCorrupt() {
+    const auto data = ReadFile(TRACE_PATH);
+
+    // a record count far beyond the bytes left
+    auto damaged = data.substr(0, 9) + std::string("\xFF\xFF\xFF\xFF\x0F", 5) + data.substr(10);
+    WriteFile(DAMAGED_PATH, damaged);
+    CHECK_THROWS(wmi::ReadTrace(DAMAGED_PATH));
+
+    // a varint that never ends
+    WriteFile(DAMAGED_PATH, data.substr(0, 8) + std::string(16, '\xFF'));
+    CHECK_THROWS(wmi::ReadTrace(DAMAGED_PATH));
+
+    // an unknown version, and a file that is no trace at all
+    WriteFile(DAMAGED_PATH, data.substr(0, 8) + '\x02' + data.substr(9));
+    CHECK_THROWS(wmi::ReadTrace(DAMAGED_PATH));
+    WriteFile(DAMAGED_PATH, "WMITRACX" + data.substr(8));
+    CHECK_THROWS(wmi::ReadTrace(DAMAGED_PATH));
+
+    // every single flipped byte either still reads or is rejected, never crashes
+    for (std::size_t i = 8; i < data.size(); ++i) {
+        damaged = data;
+        damaged[i] = static_cast<char>(~damaged[i]);
+        WriteFile(DAMAGED_PATH, damaged);
+        try {
+            (void)wmi::ReadTrace(DAMAGED_PATH);
+        } catch (const wmi::Exception&) {
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    TestRoundTrip();
+    TestTruncated();
+    TestCorrupt();
+    std::remove(TRACE_PATH);
+    std::remove(DAMAGED_PATH);
+    return test::Result();
+}
@@ -0,0 +1,121 @@
+#include "check.hxx"
+
+#include <wmi/variant.hxx>
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string_view>
+
+namespace {
+
+using wmi::detail::ParseStatus;
+
+template <typename T>
+ParseStatus Parse(const std::wstring_view text, T& value) {
+    return wmi::detail::ParseInteger(text, value);
+}
+
+template <typename T>
+std::optional<T> Parsed(const std::wstring_view text) {
+    T value{};
+    if (wmi::detail::ParseInteger(text, value) != ParseStatus::Ok) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+void TestUnsignedLimits() {
+    CHECK(Parsed<std::uint64_t>(L"18446744073709551615") ==
+          std::numeric_limits<std::uint64_t>::max());
+    CHECK(Parsed<std::uint64_t>(L"+18446744073709551615") ==
+          std::numeric_limits<std::uint64_t>::max());
+
+    std::uint64_t value = 7;
+    CHECK(Parse(L"18446744073709551616", value) == ParseStatus::Overflow);
+    CHECK(Parse(L"18446744073709551620", value) == ParseStatus::Overflow);
+    CHECK(Parse(L"99999999999999999999999", value) == ParseStatus::Overflow);
+    // a failed parse leaves the value untouched
+    CHECK(value == 7);
+
+    CHECK(Parsed<std::uint32_t>(L"4294967295") == 4294967295u);
+    std::uint32_t narrow = 0;
+    CHECK(Parse(L"4294967296", narrow) == ParseStatus::Overflow);
+    CHECK(Parse(L"-1", narrow) == ParseStatus::Overflow);
+}
+
+void TestSignedLimits() {
+    CHECK(Parsed<std::int64_t>(L"9223372036854775807") ==
+          std::numeric_limits<std::int64_t>::max());
+    CHECK(Parsed<std::int64_t>(L"-9223372036854775808") ==
+          std::numeric_limits<std::int64_t>::min());
+
+    std::int64_t value = 0;
+    CHECK(Parse(L"9223372036854775808", value) == ParseStatus::Overflow);
+    CHECK(Parse(L"-9223372036854775809", value) == ParseStatus::Overflow);
+    CHECK(Parse(L"-18446744073709551616", value) == ParseStatus::Overflow);
+
+    CHECK(Parsed<std::int8_t>(L"-128") == std::int8_t{-128});
+    CHECK(Parsed<std::int8_t>(L"127") == std::int8_t{127});
+    std::int8_t tiny = 0;
+    CHECK(Parse(L"-129", tiny) == ParseStatus::Overflow);
+    CHECK(Parse(L"128", tiny) == ParseStatus::Overflow);
+}
+
+void TestSignsAndZeros() {
+    CHECK(Parsed<std::int64_t>(L"-0") == 0);
+    CHECK(Parsed<std::uint64_t>(L"-0") == 0u);
+    CHECK(Parsed<std::int64_t>(L"+0") == 0);
+    CHECK(Parsed<std::uint64_t>(L"0") == 0u);
+
+    std::int64_t value = 0;
+    CHECK(Parse(L"-", value) == ParseStatus::Invalid);
+    CHECK(Parse(L"+", value) == ParseStatus::Invalid);
+    CHECK(Parse(L"", value) == ParseStatus::Invalid);
+    CHECK(Parse(L"--1", value) == ParseStatus::Invalid);
+    CHECK(Parse(L"+-1", value) == ParseStatus::Invalid);
+
+    // leading zeros do not count towards the 19 unchecked digits
+    CHECK(Parsed<std::uint64_t>(L"000000000000000000000000000042") == 42u);
+    CHECK(Parsed<std::uint64_t>(L"0000000000018446744073709551615") ==
+          std::numeric_limits<std::uint64_t>::max());
+    CHECK(Parsed<std::int64_t>(L"-0000000000000000000009223372036854775808") ==
+          std::numeric_limits<std::int64_t>::min());
+    CHECK(Parsed<std::int64_t>(L"-00000000000000000000000") == 0);
+}
+
+void TestInvalidCharacters() {
+    std::uint64_t value = 0;
+    CHECK(Parse(L" 1", value) == ParseStatus::Invalid);
+    CHECK(Parse(L"1 ", value) == ParseStatus::Invalid);
+    CHECK(Parse(L"12a4", value) == ParseStatus::Invalid);
+    CHECK(Parse(L"0x10", value) == ParseStatus::Invalid);
+    CHECK(Parse(L"1.0", value) == ParseStatus::Invalid);
+    // as the last unchecked character, then right after and further along the checked path
+    CHECK(Parse(L"123456789012345678x", value) == ParseStatus::Invalid);
+    CHECK(Parse(L"1234567890123456789x", value) == ParseStatus::Invalid);
+    CHECK(Parse(L"12345678901234567890x", value) == ParseStatus::Invalid);
+    // garbage after an overflow is still reported as invalid
+    CHECK(Parse(L"99999999999999999999999x", value) == ParseStatus::Invalid);
+    // characters just outside the digit range
+    CHECK(Parse(L"/", value) == ParseStatus::Invalid);
+    CHECK(Parse(L":", value) == ParseStatus::Invalid);
+    // a fullwidth digit is not a decimal digit here
+    CHECK(Parse(L"\xFF11", value) == ParseStatus::Invalid);
+}
+
+// usable in constant expressions
+static_assert([] {
+    std::int64_t value = 0;
+    return wmi::detail::ParseInteger(L"-42", value) == ParseStatus::Ok && value == -42;
+}());
+
+}  // namespace
+
+int main() {
+    TestUnsignedLimits();
+    TestSignedLimits();
+    TestSignsAndZeros();
+    TestInvalidCharacters();
+    return test::Result();
+}